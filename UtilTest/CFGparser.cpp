@@ -1,5 +1,6 @@
 ﻿#include "pch.h"
 #include "../UtilityLib/CFGparser.h"
+#include "../UtilityLib/Lexer.h"
 #include <vector>
 #include <map>
 #include <functional>
@@ -905,3 +906,473 @@ TEST( CFGparser, bug_multi_startsymbol )
 	EXPECT_TRUE( cfg.Parse( { 'x' } ) );
 	EXPECT_TRUE( cfg.Parse( { 'y' } ) );
 }
+
+TEST( CFGparser_operator_priority, long_sum )
+{
+	std::string s = "0", expect = "0,";
+	for( int i = 1; i < 300; i++ )
+	{
+		s += '+' + std::to_string( i );
+		expect += std::to_string( i ) + ",+,";
+	}
+	EXPECT_EQ( ParseAndPrintPostorderExpr( s ).second, expect );
+}
+TEST( Grammar, nullable )
+{
+	using namespace CFG;
+	Grammar g;
+	g.AddASCIIAsTerminal();
+	const int a = 1, b = 2, ab = 3;
+	g.AddNonTerminal( a, {} );
+	g.AddNonTerminal( a, { g.toTerminal( 'a' ),a } );
+	g.AddNonTerminal( b, { g.toTerminal( 'b' ) } );
+	g.AddNonTerminal( ab, { a,a } );
+	g.AddNonTerminal( StartNonTerminal, { ab,b } );
+	ASSERT_EQ( g.Initialize(), Grammar<>::tError::kSuc );
+	EXPECT_TRUE( g.isNullable( a ) );
+	EXPECT_FALSE( g.isNullable( b ) );
+	EXPECT_TRUE( g.isNullable( ab ) );
+	EXPECT_FALSE( g.isNullable( StartNonTerminal ) );
+	EXPECT_FALSE( g.isNullable( g.toTerminal( 'a' ) ) );
+	//unknown nonterminal
+	EXPECT_FALSE( g.isNullable( g.GetNonTerminalCount() ) );
+	EXPECT_FALSE( g.isNullable( -1 ) );
+}
+TEST( CFGparser, nullable )
+{
+	using namespace CFG;
+	Grammar g;
+	g.AddASCIIAsTerminal();
+	const int a = 1, b = 2, opt = 3;
+	g.SetNonTerminalString( a, "A" );
+	g.SetNonTerminalString( b, "B" );
+	g.SetNonTerminalString( opt, "Opt" );
+	g.AddNonTerminal( a, {} );
+	g.AddNonTerminal( a, { g.toTerminal( 'a' ),a } );
+	g.AddNonTerminal( b, {} );
+	g.AddNonTerminal( b, { g.toTerminal( 'b' ) } );
+	g.AddNonTerminal( opt, { a,b } );
+	g.AddNonTerminal( StartNonTerminal, { opt,g.toTerminal( 'x' ),opt } );
+	ASSERT_EQ( g.Initialize(), Grammar<>::tError::kSuc );
+
+	CFGparser<> cfg;
+	cfg.SetGrammar( g );
+	//terminal is not a child node
+	auto text_of_child = [&cfg] ()
+	{
+		std::vector<std::string> ret;
+		for( int idx : cfg.GetChildList( cfg.GetRoot() ) )
+			ret.emplace_back( cfg.GetGrammar().toString( cfg.GetText( cfg.GetNode( idx ) ) ) );
+		return ret;
+	};
+	ASSERT_TRUE( cfg.Parse( string2vector( "x" ) ) );
+	EXPECT_EQ( text_of_child(), std::vector<std::string>( { "","" } ) );
+	ASSERT_TRUE( cfg.Parse( string2vector( "aabxa" ) ) );
+	EXPECT_EQ( text_of_child(), std::vector<std::string>( { "aab","a" } ) );
+	ASSERT_TRUE( cfg.Parse( string2vector( "xb" ) ) );
+	EXPECT_EQ( text_of_child(), std::vector<std::string>( { "","b" } ) );
+	const int opt_node = cfg.GetChildList( cfg.GetRoot() ).back();
+	EXPECT_EQ( cfg.GetChildList( opt_node ).size(), 2 );
+	EXPECT_FALSE( cfg.Parse( string2vector( "bax" ) ) );
+	EXPECT_FALSE( cfg.Parse( string2vector( "" ) ) );
+}
+TEST( CFGgrammarTemplate, parse_long_string )
+{
+	using namespace CFG;
+	Grammar g;
+	g.AddASCIIAsTerminal();
+	const int ch = 1;
+	const int str = 2;
+	const int rawstr = 3;
+	const int quote = g.toTerminal( '"' );
+	GrammarTemplate::AddStringDef( g, rawstr, str, quote, quote, ch );
+	g.AddNonTerminal( StartNonTerminal, { rawstr } );
+	ASSERT_EQ( g.Initialize(), Grammar<>::tError::kSuc );
+
+	CFGparser<> cfg;
+	cfg.SetGrammar( g );
+	//right recursion str->char str, linear with leo items
+	const int n = 20000;
+	std::string s( n, 'a' );
+	for( int i = 0; i < n; i++ )
+		s[i] = 'a' + i % 26;
+	ASSERT_TRUE( cfg.Parse( string2vector( '"' + s + '"' ) ) );
+	auto q = cfg.GetChildList( cfg.GetChildList( cfg.GetRoot() ).front() );
+	ASSERT_EQ( q.size(), 1 );
+	int cnt = 0;
+	for( int x = q.front(); x != -1; ++cnt )
+	{
+		auto child = cfg.GetChildList( x );
+		ASSERT_EQ( cfg.GetGrammar().toString( cfg.GetText( cfg.GetNode( child.front() ) ) ), std::string( 1, s[cnt] ) );
+		EXPECT_EQ( cfg.GetParent( child.front() ), x );
+		EXPECT_EQ( cfg.GetNode( x ).pos, cnt + 1 );
+		x = child.size() == 2 ? child.back() : -1;
+	}
+	EXPECT_EQ( cnt, n );
+}
+TEST( CFGparser, leo_chain_keeps_root )
+{
+	using namespace CFG;
+	Grammar g;
+	g.AddASCIIAsTerminal();
+	const int A = 1, B = 2;
+	g.AddNonTerminal( StartNonTerminal, { g.toTerminal( 'a' ) } );
+	g.AddNonTerminal( StartNonTerminal, { A,B } );
+	g.AddNonTerminal( A, { g.toTerminal( 'b' ) } );
+	g.AddNonTerminal( A, { StartNonTerminal } );
+	g.AddNonTerminal( B, { g.toTerminal( 'b' ) } );
+	ASSERT_EQ( g.Initialize(), Grammar<>::tError::kSuc );
+
+	//S->AB. at 0 is the done item of a leo chain which could continue through A->.S
+	for( bool lalr : { true,false } )
+	{
+		CFGparser<> cfg;
+		cfg.SetGrammar( g );
+		cfg.ConfigLALR( lalr );
+		for( std::string s : { "a", "ab", "bb", "abb", "bbbb" } )
+		{
+			ASSERT_TRUE( cfg.Parse( string2vector( s ) ) ) << s;
+			EXPECT_EQ( cfg.GetGrammar().toString( cfg.GetText( cfg.GetNode( cfg.GetRoot() ) ) ), s );
+		}
+		EXPECT_FALSE( cfg.Parse( string2vector( "b" ) ) );
+		EXPECT_FALSE( cfg.Parse( string2vector( "ba" ) ) );
+		cfg.StartStream();
+		EXPECT_EQ( cfg.Feed( string2vector( "a" ) ), CFGparser<>::tStreamState::kMatch );
+		EXPECT_EQ( cfg.Feed( string2vector( "b" ) ), CFGparser<>::tStreamState::kMatch );
+		ASSERT_TRUE( cfg.Finish() );
+	}
+}
+TEST( CFGparser, stream_state )
+{
+	using namespace CFG;
+	Grammar g;
+	g.AddASCIIAsTerminal();
+	const int digit = 1, num = 2, real = 3;
+	GrammarTemplate::AddIntegerDef( g, num, digit );
+	GrammarTemplate::AddRealNumberDef( g, real, num, g.toTerminal( '.' ) );
+	g.AddNonTerminal( StartNonTerminal, { real } );
+	ASSERT_EQ( g.Initialize(), Grammar<>::tError::kSuc );
+
+	using tStreamState = CFGparser<>::tStreamState;
+	CFGparser<> cfg;
+	cfg.SetGrammar( g );
+	cfg.StartStream();
+	EXPECT_EQ( cfg.GetStreamState(), tStreamState::kPrefix );
+	EXPECT_EQ( cfg.Feed( string2vector( "12" ) ), tStreamState::kMatch );
+	EXPECT_EQ( cfg.Feed( string2vector( "." ) ), tStreamState::kPrefix );
+	EXPECT_EQ( cfg.Feed( string2vector( "5" ) ), tStreamState::kMatch );
+	EXPECT_EQ( cfg.Feed( string2vector( "" ) ), tStreamState::kMatch );
+	ASSERT_TRUE( cfg.Finish() );
+	EXPECT_EQ( cfg.GetGrammar().toString( cfg.GetText( cfg.GetNode( cfg.GetRoot() ) ) ), "12.5" );
+
+	cfg.StartStream();
+	EXPECT_EQ( cfg.Feed( string2vector( "1." ) ), tStreamState::kPrefix );
+	EXPECT_EQ( cfg.Feed( string2vector( ".2" ) ), tStreamState::kReject );
+	EXPECT_EQ( cfg.Feed( string2vector( "3" ) ), tStreamState::kReject );
+	EXPECT_FALSE( cfg.Finish() );
+	auto err = cfg.ParseErrorReport();
+	EXPECT_EQ( err.pos, 3 );
+	EXPECT_EQ( err.text, "1..23" );
+	EXPECT_EQ( err.expect_rawstr, "0123456789" );
+}
+TEST( CFGparser, stream_discard_phase )
+{
+	using namespace CFG;
+	Grammar g;
+	g.AddASCIIAsTerminal();
+	const int ch = 1, word = 2, line = 3, lines = 4;
+	for( char c = 'a'; c <= 'z'; ++c )
+		g.AddTerminalList( ch, { c } );
+	g.AddNonTerminal( word, { ch } );
+	g.AddNonTerminal( word, { ch,word } );
+	g.AddNonTerminal( line, { word,g.toTerminal( '\n' ) } );
+	g.AddNonTerminal( line, { word,g.toTerminal( ' ' ),line } );
+	g.AddNonTerminal( lines, { line } );
+	g.AddNonTerminal( lines, { lines,line } );
+	g.AddNonTerminal( StartNonTerminal, { lines } );
+	ASSERT_EQ( g.Initialize(), Grammar<>::tError::kSuc );
+
+	std::string s;
+	for( int i = 0; i < 300; i++ )
+		s += std::string( 1 + i % 7, 'a' + i % 26 ) + ( i % 5 == 4 ? "\n" : " " );
+	s += "end\n";
+
+	CFGparser<> whole, stream;
+	whole.ConfigLALR( false );//same node order as stream
+	whole.SetGrammar( g );
+	stream.SetGrammar( g );
+	ASSERT_TRUE( whole.Parse( string2vector( s ) ) );
+
+	using tStreamState = CFGparser<>::tStreamState;
+	stream.ConfigDiscardPhase( true );
+	stream.StartStream();
+	for( size_t i = 0; i < s.size(); i += 13 )
+	{
+		auto chunk = string2vector( s.substr( i, 13 ) );
+		auto r = stream.Feed( chunk );
+		EXPECT_NE( r, tStreamState::kReject );
+		EXPECT_EQ( r == tStreamState::kMatch, s[std::min( i + 13, s.size() ) - 1] == '\n' );
+	}
+	ASSERT_TRUE( stream.Finish() );
+	EXPECT_EQ( stream.toExprTreeString( stream.GetRoot() ), whole.toExprTreeString( whole.GetRoot() ) );
+
+	stream.StartStream();
+	EXPECT_EQ( stream.Feed( string2vector( "ab cd\nx" ) ), tStreamState::kPrefix );
+	EXPECT_EQ( stream.Feed( string2vector( "\n\n" ) ), tStreamState::kReject );
+}
+TEST( LALRtable, detect )
+{
+	using namespace CFG;
+	Grammar prio;
+	prio.AddASCIIAsTerminal();
+	const int digit = 1, num = 2, expr = 3, add = 4, mul = 5, expr_add = 6, expr_mul = 7;
+	prio.AddTerminalList( add, { '+','-' } );
+	prio.AddTerminalList( mul, { '*','/' } );
+	GrammarTemplate::AddIntegerDef( prio, num, digit );
+	const int main_expr = GrammarTemplate::AddExprWithPriority( prio, { { expr_add,add },{ expr_mul,mul } }, expr, num );
+	prio.AddNonTerminal( StartNonTerminal, { main_expr } );
+	ASSERT_EQ( prio.Initialize(), Grammar<>::tError::kSuc );
+	LALRtable<Grammar<>> table;
+	EXPECT_EQ( table.Build( prio ), LALRtable<Grammar<>>::tError::kSuc );
+	EXPECT_GT( table.GetStateCount(), 0 );
+	EXPECT_LE( table.GetClassCount(), 10 + 4 + 2 + 1 );//digit,operator,parentheses,end
+	EXPECT_NE( table.GetClass( '+' ), table.GetClass( '*' ) );
+	EXPECT_EQ( table.GetClass( 'x' ), -1 );
+
+	Grammar amb;
+	amb.AddASCIIAsTerminal();
+	amb.AddTerminalList( digit, { '0','1' } );
+	amb.AddNonTerminal( expr, { digit } );
+	amb.AddNonTerminal( expr, { expr,amb.toTerminal( '+' ),expr } );
+	amb.AddNonTerminal( StartNonTerminal, { expr } );
+	ASSERT_EQ( amb.Initialize(), Grammar<>::tError::kSuc );
+	EXPECT_EQ( table.Build( amb ), LALRtable<Grammar<>>::tError::kConflict );
+	EXPECT_FALSE( table.isValid() );
+}
+TEST( CFGparser, lalr_same_as_earley )
+{
+	using namespace CFG;
+	Grammar g;
+	g.AddASCIIAsTerminal();
+	const int digit = 1, num = 2, expr = 3, add = 4, mul = 5, neg = 6, expr_add = 7, expr_mul = 8, expr_neg = 9, a = 10, opt = 11;
+	g.AddTerminalList( add, { '+','-' } );
+	g.AddTerminalList( mul, { '*','/' } );
+	g.AddTerminalList( neg, { '-' } );
+	GrammarTemplate::AddIntegerDef( g, num, digit );
+	std::vector<GrammarTemplate::ExprPriorityConfig> prio_def = { { expr_add,add },{ expr_mul,mul },{ .expr_id = expr_neg,.operator_id = neg,.unary = true } };
+	const int main_expr = GrammarTemplate::AddExprWithPriority( g, prio_def, expr, num );
+	//nullable suffix
+	g.AddNonTerminal( a, {} );
+	g.AddNonTerminal( a, { g.toTerminal( '!' ),a } );
+	g.AddNonTerminal( opt, { a } );
+	g.AddNonTerminal( StartNonTerminal, { main_expr,opt } );
+	ASSERT_EQ( g.Initialize(), Grammar<>::tError::kSuc );
+
+	CFGparser<> lalr, earley;
+	lalr.SetGrammar( g );
+	earley.SetGrammar( g );
+	earley.ConfigLALR( false );
+	ASSERT_TRUE( lalr.GetLALRtable().isValid() );
+
+	std::function<std::string( const CFGparser<>&, int )> canon = [&canon] ( const CFGparser<>& cfg, int idx )
+	{
+		const auto& me = cfg.GetNode( idx );
+		std::string s = std::to_string( me.rule_idx ) + ':' + cfg.GetGrammar().toString( cfg.GetText( me ) ) + '(';
+		for( int child : cfg.GetChildList( idx ) )
+		{
+			EXPECT_EQ( cfg.GetParent( child ), idx );
+			s += canon( cfg, child );
+		}
+		return s + ')';
+	};
+	for( std::string s : { "1", "1+2*3", "-(1-2)/-3!!", "((12))*-4-5!", "7!!!" } )
+	{
+		ASSERT_TRUE( lalr.Parse( string2vector( s ) ) ) << s;
+		ASSERT_TRUE( earley.Parse( string2vector( s ) ) ) << s;
+		EXPECT_EQ( canon( lalr, lalr.GetRoot() ), canon( earley, earley.GetRoot() ) ) << s;
+		EXPECT_EQ( lalr.GetNode( lalr.GetRoot() ).pos_end, (int)s.size() );
+	}
+	//syntax error is reported by Earley
+	for( std::string s : { "1+", "1+*2", "(1", "1!2", "" } )
+	{
+		EXPECT_FALSE( lalr.Parse( string2vector( s ) ) ) << s;
+		EXPECT_FALSE( earley.Parse( string2vector( s ) ) ) << s;
+		auto x = lalr.ParseErrorReport(), y = earley.ParseErrorReport();
+		EXPECT_EQ( x.type, y.type ) << s;
+		EXPECT_EQ( x.pos, y.pos ) << s;
+		EXPECT_EQ( x.usr_msg, y.usr_msg ) << s;
+	}
+}
+TEST( CFGparser, batch_shared_grammar )
+{
+	using namespace CFG;
+	Grammar g;
+	g.AddASCIIAsTerminal();
+	const int digit = 1, num = 2, expr = 3, add = 4, mul = 5, expr_add = 6, expr_mul = 7;
+	g.AddTerminalList( add, { '+','-' } );
+	g.AddTerminalList( mul, { '*','/' } );
+	GrammarTemplate::AddIntegerDef( g, num, digit );
+	std::vector<GrammarTemplate::ExprPriorityConfig> prio_def = { { expr_add,add,CFGtool::BinaryOperatorExpandMark },{ expr_mul,mul,CFGtool::BinaryOperatorExpandMark } };
+	const int main_expr = GrammarTemplate::AddExprWithPriority( g, prio_def, expr, num );
+	g.AddNonTerminal( StartNonTerminal, { main_expr } );
+	ASSERT_EQ( g.Initialize(), Grammar<>::tError::kSuc );
+
+	auto compiled = CompiledGrammar<Grammar<>>::Create( g );
+	CFGparser<> a( compiled ), b;
+	b.SetGrammar( compiled );
+	EXPECT_EQ( a.GetCompiledGrammar(), b.GetCompiledGrammar() );
+	EXPECT_TRUE( a.GetLALRtable().isValid() );
+
+	std::vector<std::vector<int>> inputs;
+	for( int i = 0; i < 1000; i++ )
+	{
+		std::string s = std::to_string( i );
+		for( int j = 0; j < i % 7; j++ )
+			s += "+*-/"[( i + j ) % 4] + std::to_string( i * j % 97 );
+		if( i % 50 == 49 )
+			s += '+';//syntax error
+		inputs.emplace_back( string2vector( s ) );
+	}
+	const std::set<int> print_target = { num,add,mul };
+	std::vector<std::string> result( inputs.size() );
+	auto ok = CFGtool::ParseBatch( compiled, inputs, [&] ( size_t idx, const CFGparser<>& cfg )
+	{
+		result[idx] = cfg.GetRoot() == -1 ? cfg.ParseErrorReport().usr_msg : CFGtool::toPostorderExprString( cfg, print_target );
+	}, 4 );
+	ASSERT_EQ( ok.size(), inputs.size() );
+	for( size_t i = 0; i < inputs.size(); i++ )
+	{
+		EXPECT_EQ( (bool)ok[i], a.Parse( inputs[i] ) );
+		EXPECT_EQ( result[i], a.GetRoot() == -1 ? a.ParseErrorReport().usr_msg : CFGtool::toPostorderExprString( a, print_target ) );
+	}
+	EXPECT_EQ( std::count( ok.begin(), ok.end(), 0 ), 20 );
+}
+TEST( CFGparser, child_span )
+{
+	using namespace CFG;
+	Grammar g;
+	g.AddASCIIAsTerminal();
+	const int digit = 1, num = 2, expr = 3, add = 4, mul = 5, expr_add = 6, expr_mul = 7;
+	g.AddTerminalList( add, { '+','-' } );
+	g.AddTerminalList( mul, { '*','/' } );
+	GrammarTemplate::AddIntegerDef( g, num, digit );
+	const int main_expr = GrammarTemplate::AddExprWithPriority( g, { { expr_add,add },{ expr_mul,mul } }, expr, num );
+	g.AddNonTerminal( StartNonTerminal, { main_expr } );
+	ASSERT_EQ( g.Initialize(), Grammar<>::tError::kSuc );
+
+	for( bool use_lalr : { true,false } )
+	{
+		CFGparser<> cfg;
+		cfg.SetGrammar( g );
+		cfg.ConfigLALR( use_lalr );
+		ASSERT_TRUE( cfg.Parse( string2vector( "(12+3)*45-6/(7-8)" ) ) );
+		const int n_node = cfg.GetNodeCount();
+		int n_tree = 0;
+		std::vector<int> stk = { cfg.GetRoot() };
+		while( !stk.empty() )
+		{
+			const int x = stk.back();
+			stk.pop_back();
+			++n_tree;
+			auto child = cfg.GetChildren( x );
+			auto expect = cfg.GetChildList( x );
+			ASSERT_TRUE( std::equal( child.begin(), child.end(), expect.begin(), expect.end() ) );
+			for( int y : child )
+			{
+				EXPECT_EQ( cfg.GetParent( y ), x );
+				stk.push_back( y );
+			}
+		}
+		EXPECT_LT( n_tree, n_node );
+		//nodes of previous parse are released
+		ASSERT_TRUE( cfg.Parse( string2vector( "1" ) ) );
+		EXPECT_LT( cfg.GetNodeCount(), n_node );
+		EXPECT_EQ( cfg.GetChildren( cfg.GetRoot() ).size(), 1 );
+		EXPECT_TRUE( cfg.GetChildren( -1 ).empty() );
+	}
+}
+
+TEST( Lexer, tokenize )
+{
+	using namespace CFG;
+	const int num = 256, id = 257, str = 258, kw_if = 259, le = 260;
+	Lexer lex;
+	lex.AddSkip( LexTemplate::Whitespace() );
+	lex.AddToken( kw_if, LexPattern::Literal( "if" ) );//before id
+	lex.AddToken( id, LexTemplate::Identifier() );
+	lex.AddToken( num, LexTemplate::RealNumber() );
+	lex.AddToken( str, LexTemplate::String() );
+	lex.AddLiteral( "<=", le );
+	for( auto s : { "<","+","(",")" } )
+		lex.AddLiteral( s );
+	ASSERT_EQ( lex.Compile(), Lexer::tError::kSuc );
+
+	std::vector<Lexer::Token> token;
+	ASSERT_TRUE( lex.Tokenize( "if ifx<=3.5+(\"a b\") <", token ) );
+	std::vector<int> expect_id = { kw_if,id,le,num,'+','(',str,')','<' };
+	EXPECT_EQ( Lexer::toText( token ), expect_id );
+	EXPECT_EQ( token[1].begin, 3 );
+	EXPECT_EQ( token[1].end, 6 );
+	EXPECT_EQ( token[3].begin, 8 );
+	EXPECT_EQ( token[3].end, 11 );
+	EXPECT_EQ( token[6].begin, 13 );
+	EXPECT_EQ( token[6].end, 18 );
+
+	int err = -1;
+	EXPECT_FALSE( lex.Tokenize( "x1 $", token, &err ) );
+	EXPECT_EQ( err, 3 );
+	EXPECT_FALSE( lex.Tokenize( "\"open", token, &err ) );
+	EXPECT_EQ( err, 0 );
+	EXPECT_FALSE( lex.Tokenize( L"x \u00e9", token, &err ) );
+	EXPECT_EQ( err, 2 );
+	EXPECT_TRUE( lex.Tokenize( "", token ) );
+	EXPECT_TRUE( token.empty() );
+}
+TEST( Lexer, parse_expr )
+{
+	using namespace CFG;
+	const int num = 256, id = 257;
+	Lexer lex;
+	lex.AddSkip( LexTemplate::Whitespace() );
+	lex.AddToken( num, LexTemplate::RealNumber() );
+	lex.AddToken( id, LexTemplate::Identifier() );
+	for( auto s : { "+","-","*","/","(",")" } )
+		lex.AddLiteral( s );
+	ASSERT_EQ( lex.Compile(), Lexer::tError::kSuc );
+
+	Grammar g;
+	g.AddASCIIAsTerminal();
+	g.SetTerminalString( num, "NUM" );
+	g.SetTerminalString( id, "ID" );
+	const int atom = 1, expr = 2, add = 3, mul = 4, expr_add = 5, expr_mul = 6;
+	g.AddTerminalList( atom, { num,id } );
+	g.AddTerminalList( add, { '+','-' } );
+	g.AddTerminalList( mul, { '*','/' } );
+	std::vector<GrammarTemplate::ExprPriorityConfig> prio_def = { { expr_add,add,CFGtool::BinaryOperatorExpandMark },{ expr_mul,mul,CFGtool::BinaryOperatorExpandMark } };
+	const int main_expr = GrammarTemplate::AddExprWithPriority( g, prio_def, expr, atom );
+	g.AddNonTerminal( StartNonTerminal, { main_expr } );
+	ASSERT_EQ( g.Initialize(), Grammar<>::tError::kSuc );
+
+	for( bool use_lalr : { true,false } )
+	{
+		CFGparser<> cfg;
+		cfg.SetGrammar( g );
+		cfg.ConfigLALR( use_lalr );
+		const std::string src = "foo + 12.5 * (bar_2 - 3)/x";
+		std::vector<Lexer::Token> token;
+		ASSERT_TRUE( lex.Parse( cfg, src, token ) );
+		EXPECT_EQ( cfg.GetText().size(), 11 );//one phase per token
+		std::string postorder;
+		for( int idx : CFGtool::toPostorderSequence( cfg, { atom,add,mul } ) )
+		{
+			auto& node = cfg.GetNode( idx );
+			auto [bg, ed] = Lexer::GetSourceRange( token, node.pos, node.pos_end );
+			postorder += src.substr( bg, ed - bg ) + ',';
+		}
+		EXPECT_EQ( postorder, "foo,12.5,bar_2,3,-,*,x,/,+," );
+
+		EXPECT_FALSE( lex.Parse( cfg, "foo + * 1", token ) );
+		EXPECT_EQ( cfg.ParseErrorReport().pos, 3 );//token idx, start from 1
+		EXPECT_EQ( cfg.ParseErrorReport().expect_rawstr, "(IDNUM" );
+	}
+}
\ No newline at end of file
@@ -1,8 +1,12 @@
 #include "pch.h"
 #include "SparseGraph.h"
 #include "DenseGraph.h"
+#include "CSRGraph.h"
+#include "BitsetDenseGraph.h"
 #include "Dijkstra.h"
 #include "GraphTool.h"
+#include "FloydWarshall.h"
+#include "Timer.h"
 
 using namespace Util::GraphTheory;
 
@@ -40,6 +44,15 @@ TEST( GraphConcept, CompileSparseGraph )
 	graph_type auto gt3 = SparseGraph<BasicNode, WeightedEdge<int>>();
 	graph_type auto gt4 = SparseGraph<WeightedNode<int>, BasicEdge>();
 }
+TEST( GraphConcept, CompileCSRGraph )
+{
+	EXPECT_TRUE( ( graph_type<CSRGraph<>> ) );
+	EXPECT_TRUE( ( graph_type<CSRGraph<BasicNode, WeightedEdge<int>, false>> ) );
+}
+TEST( GraphConcept, CompileBitsetDenseGraph )
+{
+	EXPECT_TRUE( ( graph_type<BitsetDenseGraph<>> ) );
+}
 TEST( GraphConcept, CompileDenseGraph )
 {
 	graph_type auto gt1 = DenseGraph<BasicNode, BasicEdge>();
@@ -382,4 +395,603 @@ TEST( topological_sort, normal )
 		EXPECT_TRUE( pos2 != -1 );
 		EXPECT_TRUE( pos1 < pos2 );
 	}
+}
+TEST( CSRGraph, basic )
+{
+	CSRGraph<BasicNode, WeightedEdge<int>> g;
+	const std::vector<std::pair<int, int>> edge = { { 2,0 },{ 0,1 },{ 2,1 },{ 0,2 } };
+	const std::vector<int> w = { 4,1,3,2 };
+	g.Build( 3, std::span( edge ), std::span( w ) );
+	ASSERT_EQ( g.size_node(), 3 );
+	ASSERT_EQ( g.size_edge(), 4 );
+	EXPECT_EQ( g.CountOutDegree( *g.GetNode( 0 ) ), 2 );
+	EXPECT_EQ( g.CountOutDegree( *g.GetNode( 1 ) ), 0 );
+	EXPECT_EQ( g.CountInDegree( *g.GetNode( 1 ) ), 2 );
+	EXPECT_EQ( g.GetNextEdge( *g.GetNode( 1 ) ), nullptr );
+	auto e = g.GetNextEdge( *g.GetNode( 0 ) );
+	ASSERT_NE( e, nullptr );
+	EXPECT_EQ( e->GetIdx(), 1 );
+	EXPECT_EQ( e->GetDestination(), 1 );
+	EXPECT_EQ( e->GetWeight(), 1 );
+	e = g.GetNextEdge( *e );
+	ASSERT_NE( e, nullptr );
+	EXPECT_EQ( e->GetDestination(), 2 );
+	EXPECT_EQ( e->GetWeight(), 2 );
+	EXPECT_EQ( g.GetNextEdge( *e ), nullptr );
+	auto nb = g.GetOutNeighbor( 2 );
+	ASSERT_EQ( nb.size(), 2 );
+	EXPECT_EQ( nb[0], 0 );
+	EXPECT_EQ( nb[1], 1 );
+	std::vector<int> src;
+	for( auto ie = g.GetNextInverseEdge( *g.GetNode( 1 ) ); ie; ie = g.GetNextInverseEdge( *ie ) )
+	{
+		EXPECT_EQ( ie->GetDestination(), 1 );
+		src.push_back( ie->GetSource() );
+	}
+	std::ranges::sort( src );
+	EXPECT_EQ( src, std::vector<int>( { 0,2 } ) );
+
+	g.AddEdge( 1, 2 ).GetWeight() = 5;
+	g.resize( 4 );
+	g.AddEdge( 3, 0 );
+	EXPECT_EQ( g.size_node(), 4 );
+	EXPECT_EQ( g.size_edge(), 6 );
+	EXPECT_EQ( g.CountOutDegree( *g.GetNode( 1 ) ), 1 );
+	EXPECT_EQ( g.GetNextEdge( *g.GetNode( 1 ) )->GetWeight(), 5 );
+	EXPECT_EQ( g.CountInDegree( *g.GetNode( 2 ) ), 2 );
+	EXPECT_EQ( g.CountInDegree( *g.GetNode( 0 ) ), 2 );
+	EXPECT_EQ( g.GetNextEdge( *g.GetNode( 0 ) )->GetDestination(), 1 );
+}
+TEST( CSRGraph, Dijkstra_same_as_SparseGraph )
+{
+	SparseGraph<BasicNode, WeightedEdge<int>> g;
+	std::uniform_int_distribution<int> randw( 1, 100 );
+	Util::RNG rng( 0 );
+	const int n = 100;
+	g.resize( n );
+	FOR( i, 0, n * 5 )
+	{
+		const int s = rng() % n;
+		const int t = rng() % n;
+		g.AddEdge( s, t ).GetWeight() = randw( rng );
+	}
+	CSRGraph<BasicNode, WeightedEdge<int>> csr( g );
+	ASSERT_EQ( csr.size_node(), g.size_node() );
+	ASSERT_EQ( csr.size_edge(), g.size_edge() );
+	auto r = Dijkstra( g, 0 );
+	auto r2 = Dijkstra( csr, 0 );
+	FOR( i, 0, n )
+	{
+		EXPECT_EQ( r[i].isReachable(), r2[i].isReachable() );
+		if( r[i].isReachable() )
+		{
+			EXPECT_EQ( r[i].GetDistance(), r2[i].GetDistance() );
+		}
+	}
+}
+TEST( CSRGraph, tool )
+{
+	CSRGraph<> g;
+	const std::vector<std::pair<int, int>> edge = { { 0,1 },{ 2,3 },{ 1,4 },{ 3,4 },{ 5,4 } };
+	g.Build( 6, std::span( edge ) );
+	auto c = find_connected_component( g, 0 );
+	std::ranges::sort( c );
+	EXPECT_EQ( c, std::vector<int>( { 0,1,4 } ) );
+	auto r = topological_sort( g );
+	ASSERT_EQ( r.size(), g.size_node() );
+	std::vector<int> pos( r.size() );
+	FOR( i, 0, (int)r.size() )
+		pos[r[i]] = i;
+	for( auto e = g.begin_edge(); e != g.end_edge(); ++e )
+		EXPECT_LT( pos[e->GetSource()], pos[e->GetDestination()] );
+	g.AddEdge( 4, 0 );
+	EXPECT_NE( topological_sort( g ).size(), g.size_node() );
+}
+TEST( Dijkstra, PointToPoint_same_as_full )
+{
+	SparseGraph<BasicNode, WeightedEdge<int>> g;
+	std::uniform_int_distribution<int> randw( 1, 100 );
+	Util::RNG rng( 0 );
+	const int n = 200;
+	g.resize( n );
+	FOR( i, 0, n * 3 )
+	{
+		const int s = rng() % n;
+		const int t = rng() % n;
+		g.AddEdge( s, t ).GetWeight() = randw( rng );
+	}
+	CSRGraph<BasicNode, WeightedEdge<int>> csr( g );
+	PointToPointDijkstra<decltype( g )> query( g );
+	PointToPointDijkstra<decltype( csr )> query_csr( csr );
+	FOR( s, 0, 10 )
+	{
+		auto full = Dijkstra( g, s );
+		FOR( t, 0, n )
+		{
+			auto r = query.Dijkstra( s, t );
+			auto r2 = query.Bidirectional( s, t );
+			auto r3 = query_csr.AStar( s, t, [] ( int ) { return 0; } );
+			auto r4 = query_csr.Bidirectional( s, t );
+			ASSERT_EQ( r.isReachable(), full[t].isReachable() );
+			ASSERT_EQ( r2.isReachable(), full[t].isReachable() );
+			ASSERT_EQ( r3.isReachable(), full[t].isReachable() );
+			ASSERT_EQ( r4.isReachable(), full[t].isReachable() );
+			if( full[t].isReachable() )
+			{
+				EXPECT_EQ( r.GetDistance(), full[t].GetDistance() );
+				EXPECT_EQ( r2.GetDistance(), full[t].GetDistance() );
+				EXPECT_EQ( r3.GetDistance(), full[t].GetDistance() );
+				EXPECT_EQ( r4.GetDistance(), full[t].GetDistance() );
+			}
+		}
+	}
+}
+TEST( Dijkstra, PointToPoint_early_exit )
+{
+	//grid graph, 4 neighbors
+	SparseGraph<BasicNode, WeightedEdge<int>> g;
+	const int n = 100;
+	auto id = [n] ( int x, int y ) { return x * n + y; };
+	g.resize( n * n );
+	FOR( x, 0, n )
+		FOR( y, 0, n )
+		{
+			if( x + 1 < n )
+			{
+				g.AddEdge( id( x, y ), id( x + 1, y ) ).GetWeight() = 1;
+				g.AddEdge( id( x + 1, y ), id( x, y ) ).GetWeight() = 1;
+			}
+			if( y + 1 < n )
+			{
+				g.AddEdge( id( x, y ), id( x, y + 1 ) ).GetWeight() = 1;
+				g.AddEdge( id( x, y + 1 ), id( x, y ) ).GetWeight() = 1;
+			}
+		}
+	const int st = id( 50, 50 );
+	const int ed = id( 53, 54 );
+	PointToPointDijkstra<decltype( g )> query( g );
+	auto r = query.Dijkstra( st, ed );
+	EXPECT_EQ( r.GetDistance(), 7 );
+	const int n_dijkstra = query.GetVisitedCount();
+	EXPECT_LT( n_dijkstra, n * n / 10 );
+	auto r2 = query.AStar( st, ed, [&] ( int idx ) { return std::abs( idx / n - 53 ) + std::abs( idx % n - 54 ); } );
+	EXPECT_EQ( r2.GetDistance(), 7 );
+	EXPECT_LT( query.GetVisitedCount(), n_dijkstra );
+	auto r3 = query.Bidirectional( st, ed );
+	EXPECT_EQ( r3.GetDistance(), 7 );
+	EXPECT_LT( query.GetVisitedCount(), n_dijkstra );
+	auto r4 = BidirectionalDijkstra( g, ed, ed );
+	EXPECT_TRUE( r4.isReachable() );
+	EXPECT_EQ( r4.GetDistance(), 0 );
+	auto r5 = AStar( g, ed, st, [] ( int ) { return 0; } );
+	EXPECT_EQ( r5.GetDistance(), 7 );
+}
+TEST( Dijkstra, queue_benchmark )
+{
+	//random graph with 4 edges per node, weight in [0,100]
+	const int max_w = 100;
+	for( int n : { 1000, 10000, 100000 } )
+	{
+		SparseGraph<BasicNode, WeightedEdge<int>> g;
+		SparseGraph<BasicNode, WeightedEdge<unsigned>> gu;
+		std::uniform_int_distribution<int> randw( 0, max_w );
+		Util::RNG rng( n );
+		g.resize( n );
+		gu.resize( n );
+		FOR( i, 0, n * 4 )
+		{
+			const int s = rng() % n;
+			const int t = rng() % n;
+			const int w = randw( rng );
+			g.AddEdge( s, t ).GetWeight() = w;
+			gu.AddEdge( s, t ).GetWeight() = w;
+		}
+		CSRGraph<BasicNode, WeightedEdge<int>> csr( g );
+		Util::Timer t;
+		t.SetTime();
+		auto r_heap = Dijkstra( g, 0 );
+		const double t_heap = t.GetTime();
+		t.SetTime();
+		auto r_radix = Dijkstra( gu, 0 );
+		const double t_radix = t.GetTime();
+		t.SetTime();
+		auto r_bucket = DijkstraWithMaxWeight( g, 0, max_w );
+		const double t_bucket = t.GetTime();
+		t.SetTime();
+		auto r_csr = DijkstraWithMaxWeight( csr, 0, max_w );
+		const double t_csr = t.GetTime();
+		std::cout << "n=" << n << " heap " << t_heap << "s radix " << t_radix << "s bucket " << t_bucket << "s bucket(CSR) " << t_csr << "s" << std::endl;
+		FOR( i, 0, n )
+		{
+			ASSERT_EQ( r_heap[i].isReachable(), r_radix[i].isReachable() );
+			ASSERT_EQ( r_heap[i].isReachable(), r_bucket[i].isReachable() );
+			ASSERT_EQ( r_heap[i].isReachable(), r_csr[i].isReachable() );
+			if( r_heap[i].isReachable() )
+			{
+				ASSERT_EQ( r_heap[i].GetDistance(), (int)r_radix[i].GetDistance() );
+				ASSERT_EQ( r_heap[i].GetDistance(), r_bucket[i].GetDistance() );
+				ASSERT_EQ( r_heap[i].GetDistance(), r_csr[i].GetDistance() );
+			}
+		}
+	}
+}
+TEST( Dijkstra, DeltaStepping )
+{
+	SparseGraph<BasicNode, WeightedEdge<int>> g;
+	SparseGraph<BasicNode, WeightedEdge<double>> gd;
+	std::uniform_int_distribution<int> randw( 0, 100 );
+	Util::RNG rng( 0 );
+	const int n = 2000;
+	g.resize( n );
+	gd.resize( n );
+	FOR( i, 0, n * 4 )
+	{
+		const int s = rng() % n;
+		const int t = rng() % n;
+		const int w = randw( rng );
+		g.AddEdge( s, t ).GetWeight() = w;
+		gd.AddEdge( s, t ).GetWeight() = w * 0.5;
+	}
+	CSRGraph<BasicNode, WeightedEdge<int>> csr( g );
+	auto ref = Dijkstra( g, 0 );
+	for( int n_thread : { 1, 4 } )
+		for( int delta : { 1, 25, 1000 } )
+		{
+			auto r = DeltaStepping( g, 0, delta, n_thread );
+			auto r2 = DeltaStepping( csr, 0, delta, n_thread );
+			auto r3 = DeltaStepping( gd, 0, delta * 0.5, n_thread );
+			FOR( i, 0, n )
+			{
+				ASSERT_EQ( ref[i].isReachable(), r[i].isReachable() );
+				ASSERT_EQ( ref[i].isReachable(), r2[i].isReachable() );
+				ASSERT_EQ( ref[i].isReachable(), r3[i].isReachable() );
+				if( ref[i].isReachable() )
+				{
+					ASSERT_EQ( ref[i].GetDistance(), r[i].GetDistance() );
+					ASSERT_EQ( ref[i].GetDistance(), r2[i].GetDistance() );
+					ASSERT_DOUBLE_EQ( ref[i].GetDistance() * 0.5, r3[i].GetDistance() );
+				}
+			}
+		}
+	auto r = DeltaStepping( g, n - 1, 10, 0 );
+	auto ref2 = Dijkstra( g, n - 1 );
+	FOR( i, 0, n )
+		ASSERT_EQ( ref2[i].isReachable() ? ref2[i].GetDistance() : -1, r[i].isReachable() ? r[i].GetDistance() : -1 );
+}
+TEST( Dijkstra, MultiSource )
+{
+	SparseGraph<BasicNode, WeightedEdge<unsigned>> g;
+	std::uniform_int_distribution<unsigned> randw( 0, 100 );
+	Util::RNG rng( 0 );
+	const int n = 300;
+	g.resize( n );
+	FOR( i, 0, n * 3 )
+	{
+		const int s = rng() % n;
+		const int t = rng() % n;
+		g.AddEdge( s, t ).GetWeight() = randw( rng );
+	}
+	CSRGraph<BasicNode, WeightedEdge<unsigned>> csr( g );
+	std::vector<int> sources;
+	FOR( i, 0, n )
+		if( i % 3 == 0 )
+			sources.emplace_back( i );
+	const unsigned inf = std::numeric_limits<unsigned>::max();
+	Util::Matrix<unsigned> dis;
+	Util::Matrix<unsigned> dis_csr( 1, 1 );
+	MultiSourceDijkstra( g, std::span<const int>( sources ), dis, inf, 4 );
+	MultiSourceDijkstra( csr, std::span<const int>( sources ), dis_csr );
+	ASSERT_EQ( dis.size(), std::make_pair( sources.size(), (size_t)n ) );
+	ASSERT_EQ( dis_csr.size(), dis.size() );
+	FOR( i, 0, (int)sources.size() )
+	{
+		auto ref = Dijkstra( g, sources[i] );
+		FOR( j, 0, n )
+		{
+			ASSERT_EQ( dis[i][j], ref[j].isReachable() ? ref[j].GetDistance() : inf );
+			ASSERT_EQ( dis_csr[i][j], dis[i][j] );
+		}
+	}
+}
+TEST( FloydWarshall, same_as_Dijkstra )
+{
+	DenseGraph<BasicNode, WeightedEdge<int>> g;
+	std::uniform_int_distribution<int> randw( 1, 100 );
+	Util::RNG rng( 0 );
+	const int n = 150;
+	g.resize( n );
+	FOR( i, 0, n * 10 )
+	{
+		const int s = rng() % n;
+		const int t = rng() % n;
+		if( s != t && !g.GetEdge( s, t ) )
+			g.AddEdge( s, t ).GetWeight() = randw( rng );
+	}
+	const int inf = std::numeric_limits<int>::max();
+	Util::Matrix<int> dis;
+	Util::Matrix<int> dis_small;
+	FloydWarshall( g, dis );
+	FloydWarshall<decltype( g ), 16>( g, dis_small, inf );
+	FOR( i, 0, n )
+	{
+		auto ref = Dijkstra( g, i );
+		FOR( j, 0, n )
+		{
+			ASSERT_EQ( dis[i][j], ref[j].isReachable() ? ref[j].GetDistance() : inf );
+			ASSERT_EQ( dis_small[i][j], dis[i][j] );
+		}
+	}
+}
+TEST( FloydWarshall, negative_weight )
+{
+	SparseGraph<BasicNode, WeightedEdge<int>> g;
+	g.resize( 4 );
+	g.AddEdge( 0, 1 ).GetWeight() = 4;
+	g.AddEdge( 0, 2 ).GetWeight() = 1;
+	g.AddEdge( 2, 1 ).GetWeight() = -2;
+	g.AddEdge( 1, 3 ).GetWeight() = 1;
+	Util::Matrix<int> dis;
+	FloydWarshall( g, dis, 1000 );
+	EXPECT_EQ( dis[0][1], -1 );
+	EXPECT_EQ( dis[0][3], 0 );
+	EXPECT_EQ( dis[2][3], -1 );
+	EXPECT_EQ( dis[3][0], 1000 );
+}
+TEST( BitsetDenseGraph, basic )
+{
+	BitsetDenseGraph<> g;
+	g.resize( 130 );
+	g.AddEdge( 0, 1 );
+	g.AddEdge( 0, 129 );
+	g.AddEdge( 64, 0 );
+	g.AddEdge( 129, 64 );
+	EXPECT_EQ( g.size_edge(), 4 );
+	EXPECT_EQ( g.CountOutDegree( *g.GetNode( 0 ) ), 2 );
+	EXPECT_EQ( g.CountInDegree( *g.GetNode( 0 ) ), 1 );
+	EXPECT_TRUE( g.GetEdge( 0, 129 ) );
+	EXPECT_FALSE( g.GetEdge( 129, 0 ) );
+	auto e = g.GetNextEdge( *g.GetNode( 0 ) );
+	ASSERT_NE( e, nullptr );
+	EXPECT_EQ( e->GetDestination(), 1 );
+	e = g.GetNextEdge( *e );
+	ASSERT_NE( e, nullptr );
+	EXPECT_EQ( e->GetDestination(), 129 );
+	EXPECT_EQ( g.GetNextEdge( *e ), nullptr );
+	auto ie = g.GetNextInverseEdge( *g.GetNode( 64 ) );
+	ASSERT_NE( ie, nullptr );
+	EXPECT_EQ( ie->GetSource(), 129 );
+	EXPECT_EQ( g.GetNextInverseEdge( *ie ), nullptr );
+	std::vector<std::pair<int, int>> edge;
+	for( auto it = g.begin_edge(); it != g.end_edge(); ++it )
+		edge.emplace_back( it->GetSource(), it->GetDestination() );
+	EXPECT_EQ( edge, ( std::vector<std::pair<int, int>>{ { 0,1 },{ 0,129 },{ 64,0 },{ 129,64 } } ) );
+	g.EraseEdge( *g.GetEdge( 0, 1 ) );
+	EXPECT_FALSE( g.GetEdge( 0, 1 ) );
+	g.resize( 100 );
+	EXPECT_EQ( g.size_edge(), 1 );
+	EXPECT_TRUE( g.GetEdge( 64, 0 ) );
+}
+TEST( BitsetDenseGraph, stable_edge_pointer )
+{
+	BitsetDenseGraph<> g;
+	Util::RNG rng( 0 );
+	const int n = 200;
+	g.resize( n );
+	std::vector<std::pair<int, int>> edge;
+	FOR( i, 0, n * 5 )
+	{
+		const int s = rng() % n;
+		const int t = rng() % n;
+		if( !g.GetEdge( s, t ) )
+		{
+			g.AddEdge( s, t );
+			edge.emplace_back( s, t );
+		}
+	}
+	std::vector<const BasicEdge*> ptr;
+	for( auto [s, t] : edge )
+		ptr.emplace_back( g.GetEdge( s, t ) );
+	//far more than 64 views are returned in between
+	FOR( u, 0, n )
+		for( auto e = g.GetNextEdge( *g.GetNode( u ) ); e; e = g.GetNextEdge( *e ) )
+			EXPECT_EQ( e->GetSource(), u );
+	FOR( i, 0, (int)edge.size() )
+	{
+		EXPECT_EQ( ptr[i]->GetSource(), edge[i].first );
+		EXPECT_EQ( ptr[i]->GetDestination(), edge[i].second );
+		EXPECT_EQ( ptr[i], g.GetEdge( edge[i].first, edge[i].second ) );
+	}
+	const BitsetDenseGraph<> copy = g;
+	EXPECT_EQ( copy.size_edge(), edge.size() );
+	EXPECT_NE( copy.GetEdge( edge[0].first, edge[0].second ), ptr[0] );
+}
+TEST( BitsetDenseGraph, build_without_view )
+{
+	BitsetDenseGraph<> g;
+	const int n = 4096;
+	g.resize( n );
+	FOR( s, 0, n )
+		FOR( t, 0, n )
+			if( s != t )
+			{
+				if( t & 1 )
+					g.SetEdge( s, t );
+				else
+					EXPECT_EQ( g.AddEdge( s, t ).GetDestination(), t );
+			}
+	EXPECT_EQ( g.size_edge(), (size_t)n * ( n - 1 ) );
+	EXPECT_EQ( g.GetViewBytes(), 0 );
+	EXPECT_EQ( g.BFS( 0 )[n - 1], 1 );
+	EXPECT_EQ( g.CountCommonNeighbor( 1, 2 ), n - 2 );
+	EXPECT_EQ( g.GetViewBytes(), 0 );
+	//traversal of one row creates views of its words only
+	int deg = 0;
+	for( auto e = g.GetNextEdge( *g.GetNode( 5 ) ); e; e = g.GetNextEdge( *e ) )
+		++deg;
+	EXPECT_EQ( deg, n - 1 );
+	EXPECT_EQ( g.GetViewBytes(), n / 64 * ( sizeof( std::atomic<BasicEdge*> ) + 64 * sizeof( BasicEdge ) ) );
+	//AddEdge returns the existing view
+	const BasicEdge* e = g.GetEdge( 5, 7 );
+	EXPECT_EQ( &g.AddEdge( 5, 7 ), e );
+	g.ReleaseView();
+	EXPECT_EQ( g.GetViewBytes(), 0 );
+	EXPECT_TRUE( g.HasEdge( 5, 7 ) );
+}
+TEST( BitsetDenseGraph, BFS_and_tool )
+{
+	BitsetDenseGraph<> g;
+	SparseGraph<> ref;
+	Util::RNG rng( 0 );
+	const int n = 300;
+	g.resize( n );
+	ref.resize( n );
+	FOR( i, 0, n * 2 )
+	{
+		const int s = rng() % n;
+		const int t = rng() % n;
+		if( !g.GetEdge( s, t ) )
+		{
+			g.AddEdge( s, t );
+			ref.AddEdge( s, t );
+		}
+	}
+	auto c = find_connected_component( g, 0 );
+	auto c_ref = find_connected_component( ref, 0 );
+	std::ranges::sort( c );
+	std::ranges::sort( c_ref );
+	EXPECT_EQ( c, c_ref );
+	auto dis = g.BFS( 0 );
+	std::vector<int> dis_ref( n, -1 );
+	std::vector<int> q = { 0 };
+	dis_ref[0] = 0;
+	for( int h = 0; h < (int)q.size(); h++ )
+		for( auto e = ref.GetNextEdge( *ref.GetNode( q[h] ) ); e; e = ref.GetNextEdge( *e ) )
+			if( dis_ref[e->GetDestination()] < 0 )
+			{
+				dis_ref[e->GetDestination()] = dis_ref[q[h]] + 1;
+				q.emplace_back( e->GetDestination() );
+			}
+	EXPECT_EQ( dis, dis_ref );
+	EXPECT_EQ( topological_sort( g ).size(), topological_sort( ref ).size() );
+}
+TEST( BitsetDenseGraph, triangle )
+{
+	BitsetDenseGraph<> g;
+	Util::RNG rng( 0 );
+	const int n = 100;
+	g.resize( n );
+	FOR( i, 0, n * 5 )
+	{
+		const int s = rng() % n;
+		const int t = rng() % n;
+		if( s != t )
+		{
+			g.AddEdge( s, t );
+			g.AddEdge( t, s );
+		}
+	}
+	std::uint64_t cnt = 0;
+	FOR( a, 0, n )
+		FOR( b, a + 1, n )
+			FOR( c, b + 1, n )
+				cnt += g.HasEdge( a, b ) && g.HasEdge( b, c ) && g.HasEdge( a, c );
+	EXPECT_EQ( g.CountTriangle(), cnt );
+	size_t common = 0;
+	FOR( i, 0, n )
+		common += g.HasEdge( 3, i ) && g.HasEdge( 7, i );
+	EXPECT_EQ( g.CountCommonNeighbor( 3, 7 ), common );
+}
+TEST( Tool, parallel_bfs )
+{
+	SparseGraph<> g;
+	Util::RNG rng( 0 );
+	const int n = 3000;
+	g.resize( n );
+	FOR( i, 0, n * 3 )
+		g.AddEdge( rng() % n, rng() % n );
+	CSRGraph<> csr( g );
+	CSRGraph<BasicNode, BasicEdge, false> csr_no_inverse( g );
+	std::vector<int> ref( n, -1 );
+	std::vector<int> q = { 0 };
+	ref[0] = 0;
+	for( int h = 0; h < (int)q.size(); h++ )
+		for( auto e = g.GetNextEdge( *g.GetNode( q[h] ) ); e; e = g.GetNextEdge( *e ) )
+			if( ref[e->GetDestination()] < 0 )
+			{
+				ref[e->GetDestination()] = ref[q[h]] + 1;
+				q.emplace_back( e->GetDestination() );
+			}
+	for( int n_thread : { 1, 4 } )
+	{
+		EXPECT_EQ( parallel_bfs( g, 0, n_thread ), ref );
+		EXPECT_EQ( parallel_bfs( csr, 0, n_thread ), ref );
+		EXPECT_EQ( parallel_bfs( csr_no_inverse, 0, n_thread ), ref );
+		EXPECT_EQ( parallel_bfs( csr, 0, n_thread, 1 << 30, 1 ), ref );//always bottom-up
+	}
+}
+TEST( Tool, connected_component_label )
+{
+	CSRGraph<> g;
+	Util::RNG rng( 0 );
+	const int n = 2000;
+	std::vector<std::pair<int, int>> edge;
+	FOR( i, 0, n / 2 )
+		edge.emplace_back( rng() % n, rng() % n );
+	g.Build( n, std::span( edge ) );
+	std::vector<std::vector<int>> adj( n );
+	for( auto [s, t] : edge )
+	{
+		adj[s].emplace_back( t );
+		adj[t].emplace_back( s );
+	}
+	std::vector<int> ref( n, -1 );
+	FOR( i, 0, n )
+		if( ref[i] < 0 )
+		{
+			std::vector<int> q = { i };
+			ref[i] = i;
+			for( int h = 0; h < (int)q.size(); h++ )
+				for( int v : adj[q[h]] )
+					if( ref[v] < 0 )
+					{
+						ref[v] = i;
+						q.emplace_back( v );
+					}
+		}
+	EXPECT_EQ( connected_component_label( g, 1 ), ref );
+	EXPECT_EQ( connected_component_label( g, 4 ), ref );
+}
+TEST( Tool, parallel_topological_sort )
+{
+	SparseGraph<> g;
+	Util::RNG rng( 0 );
+	const int n = 1000;
+	g.resize( n );
+	FOR( i, 0, n * 3 )
+	{
+		int s = rng() % n;
+		int t = rng() % n;
+		if( s != t )
+			g.AddEdge( std::min( s, t ), std::max( s, t ) );
+	}
+	auto level = parallel_topological_sort( g, 4 );
+	std::vector<int> pos( n, -1 );
+	int tot = 0;
+	FOR( k, 0, (int)level.size() )
+	{
+		EXPECT_TRUE( std::ranges::is_sorted( level[k] ) );
+		for( int idx : level[k] )
+			pos[idx] = k;
+		tot += (int)level[k].size();
+	}
+	ASSERT_EQ( tot, n );
+	for( auto e = g.begin_edge(); e != g.end_edge(); ++e )
+		EXPECT_LT( pos[e->GetSource()], pos[e->GetDestination()] );
+	EXPECT_EQ( parallel_topological_sort( g, 1 ), level );
+	g.AddEdge( n - 1, 0 );
+	level = parallel_topological_sort( g );
+	tot = 0;
+	for( auto& lv : level )
+		tot += (int)lv.size();
+	EXPECT_LT( tot, n );
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "Hungary.h"
+#include <random>
 
 
 TEST(HungarianAlgorithmTest, SimpleBipartiteGraph) {
@@ -68,4 +69,118 @@ TEST(HungarianAlgorithmTest, ComplexBipartiteGraph) {
     hungarian.AddAdjacency(10, 6);
     ASSERT_EQ(hungarian.Solve(), 6);
     hungarian.Clear();
+}
+
+// Kuhn's augmenting path as reference
+static int ReferenceMatching(int n, int m, const std::vector<std::pair<int, int>>& edges) {
+    std::vector<std::vector<int>> adj(n + 1);
+    for (auto [l, r] : edges)
+        adj[l].push_back(r);
+    std::vector<int> match(m + 1, 0);
+    std::vector<char> visited;
+    std::function<bool(int)> dfs = [&](int l) {
+        for (int r : adj[l])
+            if (!visited[r]) {
+                visited[r] = true;
+                if (match[r] == 0 || dfs(match[r])) {
+                    match[r] = l;
+                    return true;
+                }
+            }
+        return false;
+    };
+    int result = 0;
+    for (int l = 1; l <= n; ++l) {
+        visited.assign(m + 1, false);
+        result += dfs(l);
+    }
+    return result;
+}
+
+TEST(HungarianAlgorithmTest, HopcroftKarpRandom) {
+    std::mt19937 rng(0);
+    for (int test = 0; test < 100; ++test) {
+        const int n = std::uniform_int_distribution<int>(1, 40)(rng);
+        const int m = std::uniform_int_distribution<int>(1, 40)(rng);
+        const int e = std::uniform_int_distribution<int>(0, n * m / 2)(rng);
+        std::vector<std::pair<int, int>> edges;
+        HungarianAlgorithm hungarian;
+        hungarian.Initialize(n, m);
+        for (int i = 0; i < e; ++i) {
+            edges.emplace_back(std::uniform_int_distribution<int>(1, n)(rng), std::uniform_int_distribution<int>(1, m)(rng));
+            hungarian.AddAdjacency(edges.back().first, edges.back().second);
+        }
+        const int result = hungarian.Solve();
+        ASSERT_EQ(result, ReferenceMatching(n, m, edges));
+        int count = 0;
+        for (int l = 1; l <= n; ++l)
+            if (int r = hungarian.GetMatchedLeft()[l]; r != 0) {
+                ASSERT_EQ(hungarian.GetMatchedRight()[r], l);
+                ++count;
+            }
+        ASSERT_EQ(count, result);
+    }
+}
+
+TEST(HungarianAlgorithmTest, HopcroftKarpLongPath) {
+    // left i -> right i, i+1, augmenting paths are long if matched in bad order
+    const int n = 200000;
+    HungarianAlgorithm hungarian;
+    hungarian.Initialize(n, n);
+    for (int i = n; i >= 1; --i) {
+        if (i < n)
+            hungarian.AddAdjacency(i, i + 1);
+        hungarian.AddAdjacency(i, i);
+    }
+    ASSERT_EQ(hungarian.Solve(), n);
+}
+
+TEST(HungarianAlgorithmTest, AssignmentSmall) {
+    Util::Matrix<double> cost = { { 4, 1, 3 }, { 2, 0, 5 }, { 3, 2, 2 } };
+    std::vector<int> assignment;
+    ASSERT_DOUBLE_EQ(HungarianAlgorithm::SolveAssignment(cost, assignment), 5);
+    ASSERT_EQ(assignment, std::vector<int>({ 1, 0, 2 }));
+
+    Util::Matrix<double> empty;
+    ASSERT_DOUBLE_EQ(HungarianAlgorithm::SolveAssignment(empty, assignment), 0);
+    ASSERT_TRUE(assignment.empty());
+}
+
+TEST(HungarianAlgorithmTest, AssignmentByPermutation) {
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> randCost(-10, 10);
+    for (int test = 0; test < 100; ++test) {
+        const int n = std::uniform_int_distribution<int>(1, 6)(rng);
+        const int m = std::uniform_int_distribution<int>(1, 6)(rng);
+        Util::Matrix<double> cost(n, m);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < m; ++j)
+                cost[i][j] = randCost(rng);
+
+        // brute force over permutations of the larger side
+        const int k = std::max(n, m);
+        std::vector<int> perm(k);
+        std::iota(perm.begin(), perm.end(), 0);
+        double best = std::numeric_limits<double>::infinity();
+        do {
+            double total = 0;
+            for (int i = 0; i < std::min(n, m); ++i)
+                total += n <= m ? cost[i][perm[i]] : cost[perm[i]][i];
+            best = std::min(best, total);
+        } while (std::next_permutation(perm.begin(), perm.end()));
+
+        std::vector<int> assignment;
+        const double result = HungarianAlgorithm::SolveAssignment(cost, assignment);
+        ASSERT_NEAR(result, best, 1e-9);
+        ASSERT_EQ((int)assignment.size(), n);
+        double total = 0;
+        std::set<int> used;
+        for (int i = 0; i < n; ++i)
+            if (assignment[i] != -1) {
+                ASSERT_TRUE(used.insert(assignment[i]).second);
+                total += cost[i][assignment[i]];
+            }
+        ASSERT_EQ((int)used.size(), std::min(n, m));
+        ASSERT_NEAR(total, result, 1e-9);
+    }
 }
\ No newline at end of file
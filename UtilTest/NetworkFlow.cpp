@@ -0,0 +1,206 @@
+#include "pch.h"
+#include "NetworkFlow.h"
+#include "SparseGraph.h"
+#include "CSRGraph.h"
+#include "Hungary.h"
+
+using namespace Util::GraphTheory;
+
+namespace
+{
+//reference by Bellman-Ford successive shortest path with explicit reverse arcs, cost 0 gives Edmonds-Karp
+struct ReferenceFlow
+{
+	struct Arc
+	{
+		int to = -1;
+		int cap = 0;
+		int cost = 0;
+	};
+	int n = 0;
+	std::vector<Arc> arc;
+	std::vector<std::vector<int>> adj;
+	explicit ReferenceFlow( int n ) :n( n ), adj( n )
+	{}
+	void AddEdge( int s, int t, int cap, int cost )
+	{
+		adj[s].emplace_back( (int)arc.size() );
+		arc.emplace_back( t, cap, cost );
+		adj[t].emplace_back( (int)arc.size() );
+		arc.emplace_back( s, 0, -cost );
+	}
+	std::pair<int, int> Solve( int s, int t )
+	{
+		int flow = 0, cost = 0;
+		while( true )
+		{
+			std::vector<int> dis( n, INT_MAX ), prev( n, -1 );
+			dis[s] = 0;
+			for( bool updated = true; updated; )
+			{
+				updated = false;
+				FOR( u, 0, n )
+					if( dis[u] != INT_MAX )
+						for( int a : adj[u] )
+							if( arc[a].cap > 0 && dis[u] + arc[a].cost < dis[arc[a].to] )
+							{
+								dis[arc[a].to] = dis[u] + arc[a].cost;
+								prev[arc[a].to] = a;
+								updated = true;
+							}
+			}
+			if( dis[t] == INT_MAX )
+				return { flow, cost };
+			int delta = INT_MAX;
+			for( int v = t; v != s; v = arc[prev[v] ^ 1].to )
+				delta = std::min( delta, arc[prev[v]].cap );
+			for( int v = t; v != s; v = arc[prev[v] ^ 1].to )
+			{
+				arc[prev[v]].cap -= delta;
+				arc[prev[v] ^ 1].cap += delta;
+			}
+			flow += delta;
+			cost += delta * dis[t];
+		}
+	}
+};
+//capacity and conservation, return net flow into sink
+template <typename Graph>
+int CheckFlow( const Graph& g, const std::vector<int>& flow, int s, int t )
+{
+	std::vector<int> balance( g.size_node() );
+	for( auto e = g.begin_edge(); e != g.end_edge(); ++e )
+	{
+		EXPECT_GE( flow[e->GetIdx()], 0 );
+		EXPECT_LE( flow[e->GetIdx()], e->GetWeight() );
+		balance[e->GetSource()] -= flow[e->GetIdx()];
+		balance[e->GetDestination()] += flow[e->GetIdx()];
+	}
+	FOR( u, 0, (int)g.size_node() )
+		if( u != s && u != t )
+		{
+			EXPECT_EQ( balance[u], 0 );
+		}
+	return balance[t];
+}
+}
+
+TEST( NetworkFlow, MaxFlow_basic )
+{
+	SparseGraph<BasicNode, WeightedEdge<int>> g;
+	g.resize( 6 );
+	auto add = [&] ( int s, int t, int c )	{		g.AddEdge( s, t ).GetWeight() = c;	};
+	add( 0, 1, 16 );
+	add( 0, 2, 13 );
+	add( 1, 2, 10 );
+	add( 2, 1, 4 );
+	add( 1, 3, 12 );
+	add( 3, 2, 9 );
+	add( 2, 4, 14 );
+	add( 4, 3, 7 );
+	add( 3, 5, 20 );
+	add( 4, 5, 4 );
+	std::vector<int> flow;
+	EXPECT_EQ( MaxFlow( g, 0, 5, flow ), 23 );
+	EXPECT_EQ( CheckFlow( g, flow, 0, 5 ), 23 );
+	EXPECT_EQ( MaxFlow( g, 5, 0, flow ), 0 );
+	EXPECT_EQ( MaxFlow( g, 0, 0, flow ), 0 );
+}
+TEST( NetworkFlow, MaxFlow_random )
+{
+	Util::RNG rng( 0 );
+	FOR( test, 0, 100 )
+	{
+		const int n = rng() % 30 + 2;
+		const int m = rng() % ( n * 4 );
+		SparseGraph<BasicNode, WeightedEdge<int>> g;
+		g.resize( n );
+		ReferenceFlow ref( n );
+		std::vector<std::pair<int, int>> edge;
+		std::vector<int> cap;
+		FOR( i, 0, m )
+		{
+			const int s = rng() % n, t = rng() % n, c = rng() % 20;
+			g.AddEdge( s, t ).GetWeight() = c;
+			ref.AddEdge( s, t, c, 0 );
+			edge.emplace_back( s, t );
+			cap.emplace_back( c );
+		}
+		CSRGraph<BasicNode, WeightedEdge<int>> csr;
+		csr.Build( n, std::span<const std::pair<int, int>>( edge ), std::span<const int>( cap ) );
+		const int expect = ref.Solve( 0, n - 1 ).first;
+		std::vector<int> flow;
+		ASSERT_EQ( MaxFlow( g, 0, n - 1, flow ), expect );
+		ASSERT_EQ( CheckFlow( g, flow, 0, n - 1 ), expect );
+		ASSERT_EQ( MaxFlow( csr, 0, n - 1, flow ), expect );
+		ASSERT_EQ( CheckFlow( csr, flow, 0, n - 1 ), expect );
+	}
+}
+TEST( NetworkFlow, MinCostFlow_random )
+{
+	Util::RNG rng( 0 );
+	FOR( test, 0, 100 )
+	{
+		const int n = rng() % 30 + 2;
+		const int m = rng() % ( n * 4 );
+		SparseGraph<BasicNode, FlowEdge<int>> g;
+		g.resize( n );
+		ReferenceFlow ref( n );
+		//cost := non-negative + pot[t] - pot[s], may be negative but there is no negative cycle
+		std::vector<int> pot( n );
+		for( auto& e : pot )
+			e = rng() % 10;
+		FOR( i, 0, m )
+		{
+			const int s = rng() % n, t = rng() % n, c = rng() % 20;
+			const int cost = (int)( rng() % 16 ) + pot[t] - pot[s];
+			auto& e = g.AddEdge( s, t );
+			e.GetWeight() = c;
+			e.GetCost() = cost;
+			ref.AddEdge( s, t, c, cost );
+		}
+		const auto expect = ref.Solve( 0, n - 1 );
+		std::vector<int> flow;
+		const auto result = MinCostFlow( g, 0, n - 1, flow );
+		ASSERT_EQ( result, expect );
+		ASSERT_EQ( CheckFlow( g, flow, 0, n - 1 ), expect.first );
+		int cost = 0;
+		for( auto e = g.begin_edge(); e != g.end_edge(); ++e )
+			cost += flow[e->GetIdx()] * e->GetCost();
+		ASSERT_EQ( cost, expect.second );
+		ASSERT_EQ( MaxFlow( g, 0, n - 1, flow ), expect.first );
+
+		//limited flow
+		const auto half = MinCostFlow( g, 0, n - 1, flow, expect.first / 2 );
+		ASSERT_EQ( half.first, expect.first / 2 );
+		ASSERT_EQ( CheckFlow( g, flow, 0, n - 1 ), expect.first / 2 );
+	}
+}
+TEST( NetworkFlow, MinCostFlow_same_as_assignment )
+{
+	Util::RNG rng( 0 );
+	FOR( test, 0, 20 )
+	{
+		const int n = rng() % 10 + 1;
+		Util::Matrix<double> cost( n, n );
+		//source 0, row 1..n, column n+1..2n, sink 2n+1
+		SparseGraph<BasicNode, FlowEdge<int>> g;
+		g.resize( 2 * n + 2 );
+		FOR( i, 0, n )
+		{
+			g.AddEdge( 0, i + 1 ).GetWeight() = 1;
+			g.AddEdge( n + 1 + i, 2 * n + 1 ).GetWeight() = 1;
+			FOR( j, 0, n )
+			{
+				cost[i][j] = (int)( rng() % 100 );
+				auto& e = g.AddEdge( i + 1, n + 1 + j );
+				e.GetWeight() = 1;
+				e.GetCost() = (int)cost[i][j];
+			}
+		}
+		std::vector<int> flow, assignment;
+		const auto result = MinCostFlow( g, 0, 2 * n + 1, flow );
+		EXPECT_EQ( result.first, n );
+		EXPECT_EQ( result.second, (int)HungarianAlgorithm::SolveAssignment( cost, assignment ) );
+	}
+}
\ No newline at end of file
@@ -32,6 +32,7 @@ bool is_same_tree( const RBtree& tree, const std::set<typename RBtree::key_type>
 		return false;
 	return true;
 }
+using SlabTree = Util::RBtree<int, std::less<int>, std::allocator<int>, Util::RBtreeStorage::kSlab>;
 }
 
 TEST( RBtree, compile )
@@ -329,3 +330,100 @@ TEST( RBtree, erase_large )
 		}
 	}
 }
+
+TEST( RBtree, slab_compile )
+{
+	SlabTree tree;
+	tree.size();
+	tree.empty();
+	tree.check();
+	tree.clear();
+	tree.begin();
+	tree.end();
+	tree.find( 0 );
+	tree.erase( 0 );
+	tree.insert( 0 );
+	tree.find_rank( 0 );
+	tree.get_rank( tree.begin() );
+	tree.lower_bound( 0 );
+	tree.erase( tree.begin() );
+	const auto& const_tree = tree;
+	const_tree.begin();
+	const_tree.end();
+	const_tree.find( 0 );
+	const_tree.find_rank( 0 );
+	const_tree.lower_bound( 0 );
+	const_tree.print();
+	SlabTree::const_iterator it = tree.begin();
+	EXPECT_EQ( it, const_tree.end() );
+}
+TEST( RBtree, slab_iterator )
+{
+	SlabTree tree;
+	for( int i : { 5, 1, 4, 2, 3 } )
+		tree.insert( i );
+	EXPECT_EQ( toVector( tree ), std::vector<int>( { 1,2,3,4,5 } ) );
+	int k = 5;
+	for( auto i = tree.end(); i != tree.begin(); )
+		EXPECT_EQ( ( --i )->get(), k-- );
+	EXPECT_EQ( k, 0 );
+	auto it = tree.find( 3 );
+	tree.insert( 10 );//iterator is not invalidated by insert
+	EXPECT_EQ( it->get(), 3 );
+	EXPECT_EQ( ( it++ )->get(), 3 );
+	EXPECT_EQ( it->get(), 4 );
+}
+TEST( RBtree, slab_same_as_list )
+{
+	const int n = 3000;
+	Util::RBtree<int> list_tree;
+	SlabTree tree;
+	std::set<int> me;
+	std::mt19937 rng( 3 );
+	std::uniform_int_distribution<int> range( 0, 200 );
+
+	for( int i = 0; i < n; i++ )
+	{
+		const int val = range( rng );
+		if( rng() % 3 == 0 )
+		{
+			auto it = tree.find( val );
+			if( it != tree.end() )
+				tree.erase( it );
+			list_tree.erase( val );
+			me.erase( val );
+		}
+		else
+		{
+			ASSERT_EQ( tree.insert( val )->get(), val );
+			list_tree.insert( val );
+			me.insert( val );
+		}
+		ASSERT_TRUE( tree.check() );
+		ASSERT_TRUE( is_same_tree( tree, me ) );
+		ASSERT_EQ( tree.print(), list_tree.print() );
+		{
+			const int find_val = range( rng );
+			auto x = tree.lower_bound( find_val );
+			auto y = me.lower_bound( find_val );
+			ASSERT_EQ( y == me.end(), x == tree.end() );
+			if( x != tree.end() )
+			{
+				ASSERT_EQ( x->get(), *y );
+				ASSERT_EQ( tree.get_rank( x ), std::distance( me.begin(), y ) + 1 );
+				ASSERT_EQ( tree.find_rank( tree.get_rank( x ) ), x );
+			}
+		}
+	}
+	//erased node is reused
+	tree.clear();
+	for( int i = 0; i < 100; i++ )
+		tree.insert( i );
+	for( int i = 0; i < 100; i += 2 )
+		tree.erase( i );
+	for( int i = 100; i < 150; i++ )
+		tree.insert( i );
+	ASSERT_TRUE( tree.check() );
+	ASSERT_EQ( tree.size(), 100 );
+	ASSERT_EQ( tree.find_rank( 51 )->get(), 100 );
+}
@@ -0,0 +1,149 @@
+#include "pch.h"
+#include "CommonDef.h"
+#include "Random.h"
+#include "RawULongInt.h"
+#include "RSA.h"
+#include "SimulatedAnnealing.h"
+#include "HillClimb.h"
+
+using namespace Util;
+
+//Known answer test from Random123
+TEST( Philox4x32, kat_zero )
+{
+	auto r = Philox4x32::Block( { 0,0,0,0 }, { 0,0 } );
+	Philox4x32::counter_type target = { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 };
+	EXPECT_EQ( r, target );
+}
+TEST( Philox4x32, kat_max )
+{
+	auto r = Philox4x32::Block( { 0xffffffff,0xffffffff,0xffffffff,0xffffffff }, { 0xffffffff,0xffffffff } );
+	Philox4x32::counter_type target = { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd };
+	EXPECT_EQ( r, target );
+}
+TEST( Philox4x32, kat_pi )
+{
+	auto r = Philox4x32::Block( { 0x243f6a88,0x85a308d3,0x13198a2e,0x03707344 }, { 0xa4093822,0x299f31d0 } );
+	Philox4x32::counter_type target = { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 };
+	EXPECT_EQ( r, target );
+}
+TEST( Philox4x32, same_seed )
+{
+	CRNG a( 123 ), b( 123 ), c( 124 );
+	bool diff = false;
+	for( int i = 0; i < 100; i++ )
+	{
+		auto x = a();
+		EXPECT_EQ( x, b() );
+		diff |= x != c();
+	}
+	EXPECT_TRUE( diff );
+	EXPECT_TRUE( a == b );
+}
+TEST( Philox4x32, discard )
+{
+	for( int n : { 0, 1, 3, 4, 5, 7, 8, 100, 1001 } )
+		for( int pre : { 0, 1, 2, 3 } )
+		{
+			CRNG a( 7 ), b( 7 );
+			for( int i = 0; i < pre; i++ )
+				a(), b();
+			for( int i = 0; i < n; i++ )
+				a();
+			b.discard( n );
+			EXPECT_EQ( a(), b() );
+			EXPECT_EQ( a(), b() );
+		}
+}
+TEST( Philox4x32, split )
+{
+	CRNG root( 1 );
+	CRNG s0 = SplitRNG( root, 0 );
+	CRNG s1 = SplitRNG( root, 1 );
+	CRNG s0_again = SplitRNG( root, 0 );
+	CRNG s00 = SplitRNG( s0, 0 );
+	CRNG s10 = SplitRNG( s1, 0 );
+	std::set<std::uint32_t> all;
+	for( int i = 0; i < 1000; i++ )
+	{
+		auto x = s0();
+		EXPECT_EQ( x, s0_again() );
+		all.insert( x );
+		all.insert( s1() );
+		all.insert( s00() );
+		all.insert( s10() );
+		all.insert( root() );
+	}
+	EXPECT_GT( all.size(), 4990 );
+}
+TEST( Philox4x32, uniform )
+{
+	CRNG rng( 0 );
+	std::uniform_int_distribution<int> r( 0, 9 );
+	int cnt[10] = { 0 };
+	const int n = 100000;
+	for( int i = 0; i < n; i++ )
+		++cnt[r( rng )];
+	for( int e : cnt )
+		EXPECT_NEAR( e, n / 10, n / 100 );
+}
+TEST( Philox4x32, SplitRNG_mt19937 )
+{
+	RNG root( 0 ), copy( 0 );
+	RNG s = SplitRNG( root, 0 );
+	EXPECT_EQ( s, RNG( copy() ) );
+}
+TEST( Philox4x32, RawULongInt_Rand )
+{
+	CRNG rng( 0 );
+	auto p = RawULongInt<10>::Rand( 20, rng );
+	EXPECT_LE( p.GetBit(), 20 );
+}
+TEST( Philox4x32, RSA_Generate )
+{
+	RSA<> rsa;
+	rsa.Generate<CRNG, CRNG>( 64, CRNG( 0 ) );
+	auto key = rsa.GetPublicKey();
+	auto code = key.Encrypt( 12345 );
+	EXPECT_EQ( rsa.Decrypt( code ), 12345 );
+}
+
+namespace
+{
+class SA_CRNG_sample :public Util::ORtool::SimulatedAnnealing<int, CRNG>
+{
+	int prev = 0;
+
+public:
+	void InitializeSolution( int& sol ) override
+	{
+		sol = 0;
+	}
+	void Neighbor( int& sol ) override
+	{
+		std::uniform_int_distribution<int> r( -1, 1 );
+		prev = sol;
+		sol = std::clamp( sol + r( GetRNG() ), -10, 10 );
+	}
+	void Rollback( int& sol ) override
+	{
+		sol = prev;
+	}
+	double CalcScore( const int& sol ) const override
+	{
+		return -std::abs( sol - 5 );
+	}
+};
+}
+TEST( Philox4x32, SimulatedAnnealing_engine )
+{
+	SA_CRNG_sample sa;
+	sa.Config( 1, 1000 );
+	sa.SetTmaxTmin( 10, 0.01 );
+	ASSERT_TRUE( sa.Execute( 0 ) );
+	EXPECT_EQ( sa.GetSolution(), 5 );
+	auto hc = Util::ORtool::HillClimbFromSimulatedAnnealing<SA_CRNG_sample>( sa );
+	hc.Config( 1, 1000 );
+	ASSERT_TRUE( hc.Execute( 0 ) );
+	EXPECT_EQ( hc.GetSolution(), 5 );
+}
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "pch.h"
 #include "Tarjan.h"
+#include "SparseGraph.h"
+#include "DenseGraph.h"
+#include "BitsetDenseGraph.h"
 #include <random>
 
 TEST( Tarjan, linear )
@@ -254,3 +257,146 @@ TEST( Tarjan, NonDFS_check_by_DFS )
 		ASSERT_TRUE( suc );
 	}
 }
+
+//same partition as Tarjan class
+static bool SamePartition( const std::vector<int>& g1, const std::vector<int>& g2 )
+{
+	if( g1.size() != g2.size() )
+		return false;
+	std::map<int, int> m12, m21;
+	for( size_t i = 0; i < g1.size(); i++ )
+	{
+		if( m12.emplace( g1[i], g2[i] ).first->second != g2[i] )
+			return false;
+		if( m21.emplace( g2[i], g1[i] ).first->second != g1[i] )
+			return false;
+	}
+	return true;
+}
+TEST( Tarjan, graph_type_same_as_Tarjan )
+{
+	using namespace Util::GraphTheory;
+	std::mt19937 rng( 0 );
+	for( int test_n = 0; test_n < 50; test_n++ )
+	{
+		const int n = std::uniform_int_distribution<int>( 5, 300 )( rng );
+		const int m = std::uniform_int_distribution<int>( 0, n * 2 )( rng );
+		std::uniform_int_distribution<int> randpt( 0, n - 1 );
+		Util::Tarjan tj;
+		SparseGraph<> g;
+		std::vector<std::pair<int, int>> edge;
+		tj.reset( n );
+		g.resize( n );
+		for( int i = 0; i < m; i++ )
+		{
+			int p1 = randpt( rng );
+			int p2 = randpt( rng );
+			tj.add( p1, p2 );
+			g.AddEdge( p1, p2 );
+			edge.emplace_back( p1, p2 );
+		}
+		CSRGraph<> csr;
+		csr.Build( n, std::span<const std::pair<int, int>>( edge ) );
+		const auto& ref = tj.solve();
+		auto label = strongly_connected_component( g );
+		EXPECT_TRUE( SamePartition( ref, label ) );
+		EXPECT_TRUE( SamePartition( strongly_connected_component( csr ), label ) );
+		EXPECT_TRUE( SamePartition( ref, parallel_strongly_connected_component( csr, 1, 16 ) ) );
+		EXPECT_TRUE( SamePartition( ref, parallel_strongly_connected_component( csr, 4, 16 ) ) );
+		EXPECT_EQ( parallel_strongly_connected_component( g, 4, 16 ), parallel_strongly_connected_component( csr, 1 ) );
+
+		//condensation is a DAG with edge in topological order
+		auto dag = condensation( g, label, 4 );
+		ASSERT_EQ( dag.size_node(), std::ranges::max( label ) + 1 );
+		std::set<std::pair<int, int>> dag_edge;
+		for( auto e = dag.begin_edge(); e != dag.end_edge(); ++e )
+		{
+			EXPECT_LT( e->GetSource(), e->GetDestination() );
+			EXPECT_TRUE( dag_edge.emplace( e->GetSource(), e->GetDestination() ).second );
+		}
+		for( auto [s, t] : edge )
+			if( label[s] != label[t] )
+			{
+				EXPECT_TRUE( dag_edge.contains( { label[s], label[t] } ) );
+			}
+		EXPECT_EQ( condensation( csr, label, 1 ).size_edge(), dag.size_edge() );
+	}
+}
+TEST( Tarjan, long_path )
+{
+	using namespace Util::GraphTheory;
+	//deep dfs, cycle 0->1->...->n-1->0 plus a tail
+	const int n = 200000;
+	std::vector<std::pair<int, int>> edge;
+	for( int i = 0; i + 1 < n; i++ )
+		edge.emplace_back( i, i + 1 );
+	edge.emplace_back( n / 2, 0 );
+	CSRGraph<> g;
+	g.Build( n, std::span<const std::pair<int, int>>( edge ) );
+	auto label = strongly_connected_component( g );
+	for( int i = 0; i <= n / 2; i++ )
+		ASSERT_EQ( label[i], label[0] );
+	for( int i = n / 2 + 1; i < n; i++ )
+		ASSERT_EQ( label[i], i - n / 2 );
+	EXPECT_TRUE( SamePartition( label, parallel_strongly_connected_component( g, 2 ) ) );
+	EXPECT_EQ( condensation( g, label ).size_edge(), n - n / 2 - 1 );
+
+	Util::Tarjan tj;
+	tj.reset( n );
+	for( auto [s, t] : edge )
+		tj.add( s, t );
+	const auto& group = tj.solve();
+	EXPECT_EQ( tj.get_result_group_size()[group[0]], n / 2 + 1 );
+}
+
+template <typename Graph>
+class SCC_all_graph :public testing::Test
+{};
+namespace GT = Util::GraphTheory;
+using SCC_graph_list = testing::Types<GT::SparseGraph<>, GT::DenseGraph<>, GT::CSRGraph<>, GT::BitsetDenseGraph<>>;
+TYPED_TEST_SUITE( SCC_all_graph, SCC_graph_list );
+//u,v are in the same component iff they reach each other, edge between components goes forward in topological order
+TYPED_TEST( SCC_all_graph, same_as_reachability )
+{
+	using namespace Util::GraphTheory;
+	std::mt19937 rng( 0 );
+	for( int test = 0; test < 50; test++ )
+	{
+		const int n = std::uniform_int_distribution<int>( 1, 150 )( rng );
+		const int m = std::uniform_int_distribution<int>( 0, n * 2 )( rng );
+		std::uniform_int_distribution<int> randpt( 0, n - 1 );
+		std::set<std::pair<int, int>> edge;
+		for( int i = 0; i < m; i++ )
+			edge.emplace( randpt( rng ), randpt( rng ) );
+		TypeParam g;
+		g.resize( n );
+		for( auto [s, t] : edge )
+			g.AddEdge( s, t );
+
+		std::vector<std::vector<char>> reach( n, std::vector<char>( n, false ) );
+		for( int s = 0; s < n; s++ )
+		{
+			std::vector<int> q = { s };
+			reach[s][s] = true;
+			for( size_t h = 0; h < q.size(); h++ )
+				for( auto it = edge.lower_bound( { q[h], 0 } ); it != edge.end() && it->first == q[h]; ++it )
+					if( !reach[s][it->second] )
+					{
+						reach[s][it->second] = true;
+						q.emplace_back( it->second );
+					}
+		}
+		const auto label = strongly_connected_component( g );
+		const auto label_p = parallel_strongly_connected_component( g, 4, 8 );
+		ASSERT_EQ( (int)label.size(), n );
+		for( int u = 0; u < n; u++ )
+			for( int v = 0; v < n; v++ )
+			{
+				const bool same = reach[u][v] && reach[v][u];
+				ASSERT_EQ( label[u] == label[v], same ) << u << ' ' << v;
+				ASSERT_EQ( label_p[u] == label_p[v], same ) << u << ' ' << v;
+			}
+		for( auto [s, t] : edge )
+			ASSERT_LE( label[s], label[t] );
+	}
+}
\ No newline at end of file
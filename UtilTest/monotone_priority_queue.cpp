@@ -0,0 +1,99 @@
+#include "pch.h"
+#include "monotone_priority_queue.h"
+#include "dynamic_priority_queue.h"
+
+using namespace Util;
+
+TEST( RadixHeap, basic )
+{
+	radix_heap<unsigned> q;
+	q.resize( 10 );
+	q.push( 0, 10 );
+	q.push( 1, 5 );
+	q.push( 2, 20 );
+	EXPECT_FALSE( q.empty() );
+	EXPECT_EQ( q.size(), 3 );
+	EXPECT_EQ( q.top().idx, 1 );
+	q.pop();
+	q.update_priority( 2, 8 );
+	EXPECT_EQ( q.top().idx, 2 );
+	EXPECT_EQ( q.top().key, 8 );
+	q.pop();
+	EXPECT_FALSE( q.exists( 2 ) );
+	EXPECT_TRUE( q.exists( 0 ) );
+	q.pop();
+	EXPECT_TRUE( q.empty() );
+}
+TEST( BucketQueue, basic )
+{
+	bucket_queue<int> q( 20 );
+	q.resize( 10 );
+	q.push( 0, 10 );
+	q.push( 1, 5 );
+	q.push( 2, 20 );
+	EXPECT_EQ( q.top().idx, 1 );
+	q.pop();
+	q.push( 3, 25 );
+	q.update_priority( 2, 7 );
+	EXPECT_EQ( q.top().idx, 2 );
+	q.pop();
+	EXPECT_EQ( q.top().idx, 0 );
+	q.pop();
+	EXPECT_EQ( q.top().key, 25 );
+	q.pop();
+	EXPECT_TRUE( q.empty() );
+}
+//random monotone operations, compare with binary heap
+template <typename Queue>
+void CompareWithHeap( Queue q, int max_gap )
+{
+	dynamic_priority_queue<int, std::greater<>> ref;
+	const int n = 1000;
+	RNG rng( 0 );
+	std::uniform_int_distribution<int> randw( 0, max_gap );
+	q.resize( n );
+	ref.resize( n );
+	std::vector<int> key( n );
+	int last = 0;
+	int next = 0;
+	while( next < n || !ref.empty() )
+	{
+		const int op = rng() % 3;
+		if( op == 0 && next < n )
+		{
+			key[next] = last + randw( rng );
+			q.push( next, key[next] );
+			ref.push( next, key[next] );
+			++next;
+		}
+		else if( op == 1 && !ref.empty() )
+		{
+			const int idx = rng() % next;
+			if( ref.exists( idx ) && key[idx] > last )
+			{
+				key[idx] = last + randw( rng ) % ( key[idx] - last );
+				q.update_priority( idx, key[idx] );
+				ref.update_priority( idx, key[idx] );
+			}
+		}
+		else if( !ref.empty() )
+		{
+			ASSERT_EQ( q.size(), ref.size() );
+			ASSERT_EQ( q.top().key, ref.top().key );
+			last = q.top().key;
+			ref.erase( q.top().idx );
+			q.pop();
+		}
+	}
+	EXPECT_TRUE( q.empty() );
+}
+TEST( RadixHeap, random )
+{
+	radix_heap<unsigned> q;
+	CompareWithHeap( q, 1000 );
+}
+TEST( BucketQueue, random )
+{
+	bucket_queue<int> q( 100 );
+	CompareWithHeap( q, 100 );
+}
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include "SimulatedAnnealing.h"
 #include "HillClimb.h"
 #include "ParallelTempering.h"
+#include "GeneticAlgorithm.h"
+#include "TabuSearch.h"
 
 using namespace Util::ORtool;
 
@@ -389,6 +391,39 @@ TEST( SA_TSP_sample, sa_basic_resample )
 		std::cout << e.temperature << ' ';
 	std::cout << '\n';
 }
+TEST( SA_TSP_sample, fast_path_temperature )
+{
+	using State = SA_TSP_sample::tState;
+	int n = 20;
+	SA_TSP_sample sa( n );
+	sa.Config( 10, 5000, true, n );
+	sa.ConfigLog( 5000, (int)State::kRollBack | (int)State::kAcceptSolution );
+	sa.SetTmaxTmin( 100, 0.01 );
+	sa.ConfigFastPath( 64 );
+	ASSERT_TRUE( sa.Execute( 0 ) );
+	auto q = sa.GetLogList();
+	EXPECT_GT( (int)q.size(), 1000 );
+	for( auto& e : q )
+	{
+		const double T = 100 * std::pow( 0.01 / 100, e.iteration / 5000.0 );
+		EXPECT_NEAR( e.temperature, T, T * 1e-9 );
+		EXPECT_DOUBLE_EQ( e.progress, e.iteration / 5000.0 );
+	}
+}
+TEST( SA_TSP_sample, fast_path_accept_ratio )
+{
+	auto run = [] ( size_t chunk )
+	{
+		int n = 20;
+		SA_TSP_sample sa( n );
+		sa.Config( 10, 20000, true, n );
+		sa.SetTmaxTmin( 300, 1 );
+		sa.ConfigFastPath( chunk );
+		EXPECT_TRUE( sa.Execute( 0 ) );
+		return sa.GetAcceptCnt() / 20000.0;
+	};
+	EXPECT_NEAR( run( 0 ), run( 64 ), 0.02 );
+}
 TEST( SA_TSP_sample, sa2hc )
 {
 	int n = 50;
@@ -447,4 +482,437 @@ TEST( ParallelTempering, compile )
 	saList.resize( N );
 	pt.SetMethod( Util::ORtool::ParallelTempering::tMethod::kLinear );
 	pt.Execute( saList.begin(), saList.begin() + N, 0 );
+}
+TEST( ParallelTempering, replica_more_than_thread )
+{
+	const int N = 8;
+	ParallelTempering pt;
+	std::vector<SA_Sample> saList;
+	saList.resize( N );
+	for( auto& sa : saList )
+	{
+		sa.Config( 1, 1000 );
+		sa.SetTmaxTmin( 100, 0.01 );
+	}
+	pt.SetThreadCount( 2 );
+	pt.SetLadder( Util::ORtool::ParallelTempering::tLadder::kSwapFeedback, 0.2 );
+	ASSERT_TRUE( pt.Execute( saList.begin(), saList.end(), 0 ) );
+	for( auto& sa : saList )
+		EXPECT_GE( sa.GetIteration(), sa.GetMaxIteration() );
+	ASSERT_EQ( pt.GetSwapStatList().size(), N - 1 );
+	std::int64_t tot = 0;
+	for( auto& e : pt.GetSwapStatList() )
+	{
+		EXPECT_LE( e.n_accept, e.n_try );
+		tot += e.n_try;
+	}
+	EXPECT_GT( tot, 0 );
+}
+
+namespace
+{
+//maximize number of 1
+class GA_OneMax_sample :public GeneticAlgorithm<std::vector<int>>
+{
+public:
+	int n = 40;
+
+protected:
+	void InitializeSolution( SolutionType& sol ) override
+	{
+		std::uniform_int_distribution<int> rand01( 0, 1 );
+		sol.resize( n );
+		for( auto& e : sol )
+			e = rand01( GetRNG() );
+	}
+	double CalcScore( const SolutionType& sol ) const override
+	{
+		return std::accumulate( sol.begin(), sol.end(), 0 );
+	}
+	void Crossover( const SolutionType& a, const SolutionType& b, SolutionType& child, RNGType& rng ) override
+	{
+		std::uniform_int_distribution<int> randx( 0, n );
+		const int pos = randx( rng );
+		child = a;
+		std::copy( b.begin() + pos, b.end(), child.begin() + pos );
+	}
+	void Mutate( SolutionType& sol, RNGType& rng ) override
+	{
+		std::uniform_int_distribution<int> randx( 0, n - 1 );
+		sol[randx( rng )] ^= 1;
+	}
+	void Neighbor( SolutionType& sol, RNGType& rng ) override
+	{
+		Mutate( sol, rng );
+	}
+};
+}
+
+TEST( GeneticAlgorithm, trival_get )
+{
+	GA_OneMax_sample ga;
+	ga.Config( 12, 34 );
+	EXPECT_DOUBLE_EQ( ga.GetTimeLimit(), 12 );
+	EXPECT_EQ( ga.GetMaxGeneration(), 34 );
+}
+TEST( GeneticAlgorithm, one_max )
+{
+	using State = GA_OneMax_sample::tState;
+	GA_OneMax_sample ga;
+	ga.Config( 10, 300, 30 );
+	ga.ConfigSelection( 3, 2, 0.9, 0.5 );
+	ga.ConfigLog( 300, (int)State::kGeneration );
+	ASSERT_TRUE( ga.Execute( 0 ) );
+	EXPECT_DOUBLE_EQ( ga.GetScore(), ga.n );
+	auto& q = ga.GetLogList();
+	ASSERT_FALSE( q.empty() );
+	double prev = q.front().best_score;
+	for( auto& e : q )
+	{
+		EXPECT_GE( e.best_score, prev );
+		EXPECT_LE( e.avg_score, e.best_score );
+		prev = e.best_score;
+	}
+}
+TEST( GeneticAlgorithm, minimize )
+{
+	GA_OneMax_sample ga;
+	ga.isMaximize = false;
+	ga.Config( 10, 300, 30 );
+	ga.ConfigSelection( 3, 2, 0.9, 0.5 );
+	ASSERT_TRUE( ga.Execute( 0 ) );
+	EXPECT_DOUBLE_EQ( ga.GetScore(), 0 );
+}
+TEST( GeneticAlgorithm, memetic )
+{
+	GA_OneMax_sample ga;
+	ga.Config( 10, 5, 10 );
+	ga.ConfigMemetic( 200 );
+	ASSERT_TRUE( ga.ParallelExecute( 2, 0 ) );
+	EXPECT_DOUBLE_EQ( ga.GetScore(), ga.n );
+}
+TEST( GeneticAlgorithm, island_deterministic )
+{
+	using State = GA_OneMax_sample::tState;
+	auto run = [] ( int n_thread )
+	{
+		GA_OneMax_sample ga;
+		ga.Config( 10, 50, 20 );
+		ga.ConfigIsland( 4, 5, 2 );
+		ga.ConfigLog( 50, (int)State::kGeneration );
+		EXPECT_TRUE( ga.ParallelExecute( n_thread, 1 ) );
+		EXPECT_EQ( ga.GetGeneration(), 50 );
+		std::vector<double> ret;
+		for( auto& e : ga.GetLogList() )
+			ret.emplace_back( e.avg_score );
+		return ret;
+	};
+	auto r1 = run( 1 );
+	auto r3 = run( 3 );
+	EXPECT_EQ( r1, r3 );
+}
+
+namespace
+{
+//assign job i to worker sol[i], minimize cost, move := swap two jobs
+class TS_Assignment_sample :public TabuSearch<std::vector<int>>
+{
+public:
+	int n = 0;
+	std::vector<std::vector<int>> cost;
+
+	TS_Assignment_sample( int _n, int seed = 0 ) :n( _n )
+	{
+		isMaximize = false;
+		Util::RNG my_rng( seed );
+		std::uniform_int_distribution<int> randw( 1, 100 );
+		cost.resize( n, std::vector<int>( n ) );
+		for( auto& row : cost )
+			for( auto& e : row )
+				e = randw( my_rng );
+	}
+	double BruteForce()const
+	{
+		std::vector<int> q( n );
+		std::iota( q.begin(), q.end(), 0 );
+		double best = 1e9;
+		do
+			best = std::min( best, CalcScore( q ) );
+		while( std::next_permutation( q.begin(), q.end() ) );
+		return best;
+	}
+
+protected:
+	void InitializeSolution( SolutionType& sol ) override
+	{
+		sol.resize( n );
+		std::iota( sol.begin(), sol.end(), 0 );
+	}
+	double CalcScore( const SolutionType& sol ) const override
+	{
+		int tot = 0;
+		FOR( i, 0, n )
+			tot += cost[i][sol[i]];
+		return tot;
+	}
+	size_t NeighborhoodSize( const SolutionType& sol )const override
+	{
+		return n * n;
+	}
+	std::uint64_t MoveAttribute( const SolutionType& sol, size_t move )const override
+	{
+		const int a = (int)move / n;
+		const int b = (int)move % n;
+		return std::min( a, b ) * n + std::max( a, b );
+	}
+	void ApplyMove( SolutionType& sol, size_t move ) override
+	{
+		std::swap( sol[move / n], sol[move % n] );
+	}
+	double EvaluateMove( int thread_idx, const SolutionType& sol, size_t move ) override
+	{
+		const int a = (int)move / n;
+		const int b = (int)move % n;
+		return GetCurrScore() - cost[a][sol[a]] - cost[b][sol[b]] + cost[a][sol[b]] + cost[b][sol[a]];
+	}
+};
+}
+
+TEST( TabuSearch, trival_get )
+{
+	TS_Assignment_sample ts( 3 );
+	ts.Config( 12, 34 );
+	EXPECT_DOUBLE_EQ( ts.GetTimeLimit(), 12 );
+	EXPECT_EQ( ts.GetMaxIteration(), 34 );
+}
+TEST( TabuSearch, assignment_opt )
+{
+	using State = TS_Assignment_sample::tState;
+	TS_Assignment_sample ts( 8 );
+	ts.Config( 10, 300 );
+	ts.ConfigTabu( 5, 3 );
+	ts.ConfigLog( 300, (int)State::kMove | (int)State::kFinish );
+	ASSERT_TRUE( ts.Execute( 0 ) );
+	EXPECT_DOUBLE_EQ( ts.GetScore(), ts.BruteForce() );
+	EXPECT_EQ( ts.GetIteration(), 300 );
+	auto& q = ts.GetLogList();
+	ASSERT_GT( (int)q.size(), 100 );
+	for( auto& e : q )
+		EXPECT_LE( e.best_score, e.score );
+}
+TEST( TabuSearch, parallel_sample_diversification )
+{
+	TS_Assignment_sample ts( 8, 1 );
+	ts.Config( 10, 500 );
+	ts.ConfigTabu( 5, 3, 10 );
+	ts.ConfigNeighborhood( 30 );
+	ts.ConfigDiversification( 10 );
+	ASSERT_TRUE( ts.ParallelExecute( 3, 0 ) );
+	EXPECT_DOUBLE_EQ( ts.GetScore(), ts.BruteForce() );
+	EXPECT_GT( ts.GetFrequency( 0 * 8 + 1 ) + ts.GetFrequency( 2 * 8 + 5 ), 0 );
+}
+TEST( TabuSearch, deterministic )
+{
+	auto run = [] ( int n_thread )
+	{
+		TS_Assignment_sample ts( 8, 2 );
+		ts.Config( 10, 100 );
+		ts.ConfigNeighborhood( 20 );
+		ts.ConfigLog( 100, (int)TS_Assignment_sample::tState::kMove );
+		EXPECT_TRUE( ts.ParallelExecute( n_thread, 3 ) );
+		std::vector<double> ret;
+		for( auto& e : ts.GetLogList() )
+			ret.emplace_back( e.score );
+		return ret;
+	};
+	EXPECT_EQ( run( 1 ), run( 4 ) );
+}
+TEST( ParallelTempering, deterministic )
+{
+	auto run = [] ( int n_thread )
+	{
+		std::vector<SA_Sample> saList;
+		saList.resize( 6 );
+		for( auto& sa : saList )
+		{
+			sa.Config( 10, 500 );
+			sa.SetTmaxTmin( 100, 0.01 );
+		}
+		ParallelTempering pt;
+		pt.SetThreadCount( n_thread );
+		EXPECT_TRUE( pt.Execute( saList.begin(), saList.end(), 1 ) );
+		std::vector<double> ret;
+		for( auto& sa : saList )
+			ret.emplace_back( sa.GetSolution() );
+		return ret;
+	};
+	EXPECT_EQ( run( 1 ), run( 3 ) );
+}
+TEST( Telemetry, ring )
+{
+	Util::TelemetryRing<int> ring( 5 );
+	EXPECT_EQ( ring.capacity(), 8 );
+	FOR( i, 0, 10 )
+		EXPECT_EQ( ring.Push( i ), i < 8 );
+	EXPECT_EQ( ring.size(), 8 );
+	EXPECT_EQ( ring.GetDropCount(), 2 );
+	int val = -1;
+	FOR( i, 0, 8 )
+	{
+		ASSERT_TRUE( ring.Pop( val ) );
+		EXPECT_EQ( val, i );
+	}
+	EXPECT_FALSE( ring.Pop( val ) );
+	EXPECT_TRUE( ring.Push( 100 ) );
+	ASSERT_TRUE( ring.Pop( val ) );
+	EXPECT_EQ( val, 100 );
+	EXPECT_TRUE( ring.empty() );
+}
+TEST( Telemetry, sa_export_csv )
+{
+	using sa_type = SA_TSP_sample;
+	int n = 10;
+	sa_type sa( n );
+	sa.isMaximize = false;
+	sa.Config( 3, 10000, true, n );
+	sa.ConfigLog( 100 );
+	sa_type::TelemetryType ring( 1 << 12 );
+	sa.ConfigTelemetry( &ring, 16 );
+	std::stringstream ss;
+	Util::TelemetryExporter<sa_type::LogInfo> exporter;
+	exporter.Start( ring, ss );
+	ASSERT_TRUE( sa.Execute( 0 ) );
+	const std::int64_t n_running = exporter.GetWriteCount();//progress while worker is running
+	exporter.Stop();
+
+	EXPECT_LE( n_running, exporter.GetWriteCount() );
+	EXPECT_TRUE( sa.GetLogList().empty() );
+	EXPECT_EQ( ring.GetDropCount(), 0 );
+	EXPECT_GT( exporter.GetWriteCount(), 5 );
+	std::string line;
+	std::getline( ss, line );
+	EXPECT_EQ( line, sa_type::LogInfo::CSVHeader() );
+	std::int64_t n_line = 0;
+	double last_time = 0;
+	while( std::getline( ss, line ) )
+	{
+		sa_type::LogInfo e;
+		char comma;
+		std::stringstream( line ) >> e.score >> comma >> e.best_score >> comma >> e.iteration >> comma >> e.time_s;
+		EXPECT_LE( last_time, e.time_s );
+		last_time = e.time_s;
+		++n_line;
+	}
+	EXPECT_EQ( n_line, exporter.GetWriteCount() );
+}
+TEST( Telemetry, hc_export_binary )
+{
+	HC_Sample hc;
+	hc.Config( 1, 1000, true );
+	HC_Sample::TelemetryType ring( 1 << 12 );
+	hc.ConfigTelemetry( &ring );
+	std::stringstream ss;
+	Util::TelemetryExporter<HC_Sample::LogInfo> exporter;
+	exporter.Start<decltype( exporter )::tFormat::kBinary>( ring, ss, std::chrono::milliseconds( 1 ) );
+	ASSERT_TRUE( hc.Execute( 0 ) );
+	exporter.Stop();
+
+	EXPECT_TRUE( hc.GetLogList().empty() );
+	const std::string buf = ss.str();
+	ASSERT_EQ( buf.size(), exporter.GetWriteCount() * sizeof( HC_Sample::LogInfo ) );
+	ASSERT_GT( exporter.GetWriteCount(), 0 );
+	HC_Sample::LogInfo last;
+	std::memcpy( &last, buf.data() + buf.size() - sizeof( last ), sizeof( last ) );
+	EXPECT_EQ( last.iteration, 999 );
+}
+TEST( Telemetry, ga_ts_export )
+{
+	GA_OneMax_sample ga;
+	ga.Config( 10, 50, 20 );
+	GA_OneMax_sample::TelemetryType ga_ring( 1 << 8 );
+	ga.ConfigTelemetry( &ga_ring );
+	std::stringstream ga_ss;
+	Util::TelemetryExporter<GA_OneMax_sample::LogInfo> ga_exporter;
+	ga_exporter.Start( ga_ring, ga_ss );
+	ASSERT_TRUE( ga.Execute( 0 ) );
+	ga_exporter.Stop();
+	EXPECT_TRUE( ga.GetLogList().empty() );
+	EXPECT_EQ( ga_exporter.GetWriteCount(), 51 );//each generation and finish
+
+	TS_Assignment_sample ts( 8 );
+	ts.Config( 10, 100 );
+	TS_Assignment_sample::TelemetryType ts_ring( 1 << 8 );
+	ts.ConfigTelemetry( &ts_ring );
+	std::stringstream ts_ss;
+	Util::TelemetryExporter<TS_Assignment_sample::LogInfo> ts_exporter;
+	ts_exporter.Start<decltype( ts_exporter )::tFormat::kBinary>( ts_ring, ts_ss );
+	ASSERT_TRUE( ts.Execute( 0 ) );
+	ts_exporter.Stop();
+	EXPECT_TRUE( ts.GetLogList().empty() );
+	const std::string buf = ts_ss.str();
+	ASSERT_GT( ts_exporter.GetWriteCount(), 0 );
+	ASSERT_EQ( buf.size(), ts_exporter.GetWriteCount() * sizeof( TS_Assignment_sample::LogInfo ) );
+	TS_Assignment_sample::LogInfo last;
+	std::memcpy( &last, buf.data() + buf.size() - sizeof( last ), sizeof( last ) );
+	EXPECT_DOUBLE_EQ( last.best_score, ts.GetScore() );
+}
+
+namespace
+{
+template <typename Policy>
+class SA_Policy_sample :public SimulatedAnnealing<double, Util::RNG, Policy>
+{
+public:
+	using base = SimulatedAnnealing<double, Util::RNG, Policy>;
+	double prev = 0;
+	int n_hook = 0;
+
+	void InitializeSolution( double& sol ) override
+	{
+		prev = sol = 3;
+	}
+	void Neighbor( double& sol ) override
+	{
+		std::uniform_real_distribution<double> rd( -0.5, 0.5 );
+		prev = sol;
+		sol += rd( this->GetRNG() );
+	}
+	void Rollback( double& sol ) override
+	{
+		sol = prev;
+	}
+	double CalcScore( const double& x ) const override
+	{
+		return -x * x;
+	}
+	void Hook( const typename base::tState state ) override
+	{
+		++n_hook;
+	}
+};
+}
+
+TEST( Telemetry, no_hook_policy )
+{
+	auto run = [] ( auto& sa )
+	{
+		sa.Config( 10, 2000 );
+		sa.ConfigLog( 100 );
+		sa.SetTmaxTmin( 1, 0.001 );
+		EXPECT_TRUE( sa.Execute( 1 ) );
+	};
+	SA_Policy_sample<Util::DefaultHookPolicy> a;
+	SA_Policy_sample<Util::NoHookPolicy> b;
+	SA_Policy_sample<Util::HookPolicy<false, true>> c;
+	run( a );
+	run( b );
+	run( c );
+	EXPECT_GT( a.n_hook, 2000 );
+	EXPECT_FALSE( a.GetLogList().empty() );
+	EXPECT_EQ( b.n_hook, 0 );
+	EXPECT_TRUE( b.GetLogList().empty() );
+	EXPECT_EQ( c.n_hook, a.n_hook );
+	EXPECT_TRUE( c.GetLogList().empty() );
+	EXPECT_DOUBLE_EQ( a.GetSolution(), b.GetSolution() );
+	EXPECT_DOUBLE_EQ( a.GetSolution(), c.GetSolution() );
 }
\ No newline at end of file
@@ -0,0 +1,435 @@
+#pragma once
+#include "Graph.h"
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <span>
+
+namespace Util::GraphTheory
+{
+//Adjacency matrix in bits, 64 nodes per word, for unweighted dense graph
+//edge is not stored in the matrix, Edge* is a view of (source,destination) created with the other 63 of its word on first access
+//views are shared by threads and stable until resize/clear/ReleaseView
+//building the graph creates no view (SetEdge, or AddEdge whose result is a scratch edge if the view is absent)
+//traversal by graph_type interface costs O(touched edges) memory of views (64*sizeof(Edge) per touched word), bitset tools cost none
+//edge idx is source*N+destination (mod 2^31)
+template <node_type _Node = BasicNode, edge_type _Edge = BasicEdge>
+requires ( !weighted_edge_type<_Edge> )
+class BitsetDenseGraph
+{
+public:
+	using Node = _Node;
+	using Edge = _Edge;
+	using word_type = std::uint64_t;
+	using is_sparse_graph		= std::false_type;
+	using is_discrete_idx		= std::false_type;
+	using is_node_addable		= std::false_type;
+	using is_node_erasable		= std::false_type;
+	using is_edge_erasable		= std::true_type;
+	using is_edge_duplicatable	= std::false_type;
+	using has_inverse_edge		= std::true_type;
+	static constexpr int kWordBit = 64;
+
+protected:
+	template <bool is_const_iterator>
+	class _Iterator_edge;
+
+	std::vector<Node> m_nodeList;
+	std::vector<word_type> m_bits;//row i := m_bits[i*m_n_word,(i+1)*m_n_word)
+	size_t m_n_word = 0;
+	//m_view[s][i] := views of s->[i*64,i*64+64), both levels are allocated on first access
+	mutable std::unique_ptr<std::atomic<std::atomic<Edge*>*>[]> m_view;
+	Edge m_added;//result of AddEdge if the view is absent, valid until next AddEdge
+
+public:
+	using iterator_node = typename decltype( m_nodeList )::iterator;
+	using iterator_edge = _Iterator_edge<false>;
+	using const_iterator_node = typename decltype( m_nodeList )::const_iterator;
+	using const_iterator_edge = _Iterator_edge<true>;
+
+	BitsetDenseGraph()
+	{}
+	//views are not copied
+	BitsetDenseGraph( const BitsetDenseGraph& other ) :m_nodeList( other.m_nodeList ), m_bits( other.m_bits ), m_n_word( other.m_n_word )
+	{
+		AllocView();
+	}
+	BitsetDenseGraph( BitsetDenseGraph&& other )noexcept
+	{
+		swap( other );
+	}
+	BitsetDenseGraph& operator=( BitsetDenseGraph other )noexcept
+	{
+		swap( other );
+		return *this;
+	}
+	~BitsetDenseGraph()
+	{
+		FreeView();
+	}
+	void swap( BitsetDenseGraph& other )noexcept
+	{
+		m_nodeList.swap( other.m_nodeList );
+		m_bits.swap( other.m_bits );
+		std::swap( m_n_word, other.m_n_word );
+		m_view.swap( other.m_view );
+	}
+	//Common
+
+	iterator_node begin_node()				{		return m_nodeList.begin();	}
+	iterator_node end_node()				{		return m_nodeList.end();	}
+	const_iterator_node begin_node()const	{		return m_nodeList.begin();	}
+	const_iterator_node end_node()const		{		return m_nodeList.end();	}
+	iterator_edge begin_edge()				{		return iterator_edge( this, 0, FindNext( 0, 0 ) );	}
+	iterator_edge end_edge()				{		return iterator_edge( this, (int)size_node(), 0 );	}
+	const_iterator_edge begin_edge()const	{		return const_iterator_edge( this, 0, FindNext( 0, 0 ) );	}
+	const_iterator_edge end_edge()const		{		return const_iterator_edge( this, (int)size_node(), 0 );	}
+
+	Edge& AddEdge( int st_idx, int ed_idx )
+	{
+		SetEdge( st_idx, ed_idx );
+		if( const Edge* e = FindView( st_idx, ed_idx ) )
+			return *const_cast<Edge*>( e );
+		InitEdge( m_added, st_idx, ed_idx );
+		return m_added;
+	}
+	Edge* GetNextEdge( const Edge& e )	{		return const_cast<Edge*>( const_cast<const BitsetDenseGraph*>( this )->GetNextEdge( e ) );	}
+	Node* GetNode( int idx )			{		return const_cast<Node*>( const_cast<const BitsetDenseGraph*>( this )->GetNode( idx ) );	}
+	Edge* GetNextEdge( const Node& p )	{		return const_cast<Edge*>( const_cast<const BitsetDenseGraph*>( this )->GetNextEdge( p ) );	}
+
+	bool HasNode( int idx )const		{		return idx >= 0 && idx < (int)m_nodeList.size();	}
+	const Node* GetNode( int idx )const	{		return &m_nodeList[idx];	}
+	const Edge* GetNextEdge( const Node& p )const
+	{
+		const int t = FindNext( p.GetIdx(), 0 );
+		return t < (int)size_node() ? MakeEdge( p.GetIdx(), t ) : nullptr;
+	}
+	const Edge* GetNextEdge( const Edge& e )const
+	{
+		const int t = FindNext( e.GetSource(), e.GetDestination() + 1 );
+		return t < (int)size_node() ? MakeEdge( e.GetSource(), t ) : nullptr;
+	}
+	size_t CountOutDegree( const Node& p )const
+	{
+		size_t n = 0;
+		for( word_type w : GetRow( p.GetIdx() ) )
+			n += std::popcount( w );
+		return n;
+	}
+
+	size_t size_node()const	{		return m_nodeList.size();	}
+	size_t size_edge()const
+	{
+		size_t n = 0;
+		for( word_type w : m_bits )
+			n += std::popcount( w );
+		return n;
+	}
+
+	void clear()
+	{
+		FreeView();
+		m_nodeList.clear();
+		m_bits.clear();
+		m_n_word = 0;
+	}
+	void reserve( size_t n = 0, size_t m = 0 )
+	{
+		m_nodeList.reserve( n );
+		m_bits.reserve( n * ( ( n + kWordBit - 1 ) / kWordBit ) );
+	}
+	//existing edges between remaining nodes are kept, all edge views are released
+	void resize( size_t n )
+	{
+		FreeView();
+		const size_t old_n = m_nodeList.size();
+		const size_t n_word = ( n + kWordBit - 1 ) / kWordBit;
+		std::vector<word_type> bits( n * n_word );
+		for( size_t i = 0; i < std::min( n, old_n ); i++ )
+			std::copy_n( m_bits.begin() + i * m_n_word, std::min( n_word, m_n_word ), bits.begin() + i * n_word );
+		if( n < old_n && n % kWordBit )//remove edges to removed nodes
+			for( size_t i = 0; i < n; i++ )
+				bits[i * n_word + n_word - 1] &= ( word_type( 1 ) << ( n % kWordBit ) ) - 1;
+		m_bits.swap( bits );
+		m_n_word = n_word;
+		m_nodeList.resize( n );
+		for( int idx = 0; idx < (int)n; idx++ )
+			_Reset_idx( m_nodeList[idx], idx );
+		AllocView();
+	}
+
+	//inverse edge, scan column O(N)
+
+	Edge* GetNextInverseEdge( const Node& p )	{		return const_cast<Edge*>( const_cast<const BitsetDenseGraph*>( this )->GetNextInverseEdge( p ) );	}
+	Edge* GetNextInverseEdge( const Edge& e )	{		return const_cast<Edge*>( const_cast<const BitsetDenseGraph*>( this )->GetNextInverseEdge( e ) );	}
+	const Edge* GetNextInverseEdge( const Node& p )const	{		return FindNextInverse( 0, p.GetIdx() );	}
+	const Edge* GetNextInverseEdge( const Edge& e )const	{		return FindNextInverse( e.GetSource() + 1, e.GetDestination() );	}
+	size_t CountInDegree( const Node& p )const
+	{
+		size_t n = 0;
+		for( int s = 0; s < (int)size_node(); ++s )
+			n += HasEdge( s, p.GetIdx() );
+		return n;
+	}
+
+	//Erase
+	void EraseEdge( Edge& edge )
+	{
+		GetRowData( edge.GetSource() )[edge.GetDestination() / kWordBit] &= ~( word_type( 1 ) << ( edge.GetDestination() % kWordBit ) );
+	}
+
+	//Dense
+	Edge* GetEdge( int st_idx, int ed_idx )	{		return const_cast<Edge*>( const_cast<const BitsetDenseGraph*>( this )->GetEdge( st_idx, ed_idx ) );	}
+	const Edge* GetEdge( int st_idx, int ed_idx )const	{		return HasEdge( st_idx, ed_idx ) ? MakeEdge( st_idx, ed_idx ) : nullptr;	}
+
+	//Bitset
+
+	//same as AddEdge without returning edge
+	void SetEdge( int st_idx, int ed_idx )
+	{
+		assert( HasNode( st_idx ) );
+		assert( HasNode( ed_idx ) );
+		GetRowData( st_idx )[ed_idx / kWordBit] |= word_type( 1 ) << ( ed_idx % kWordBit );
+	}
+	//free memory of views after traversal, Edge* returned before are invalid
+	void ReleaseView()
+	{
+		FreeView();
+		AllocView();
+	}
+	//memory held by views in bytes
+	size_t GetViewBytes()const
+	{
+		size_t n = 0;
+		if( !m_view )
+			return n;
+		for( size_t s = 0; s < size_node(); s++ )
+			if( std::atomic<Edge*>* row = m_view[s].load( std::memory_order_acquire ) )
+			{
+				n += m_n_word * sizeof( std::atomic<Edge*> );
+				for( size_t i = 0; i < m_n_word; i++ )
+					n += row[i].load( std::memory_order_acquire ) ? kWordBit * sizeof( Edge ) : 0;
+			}
+		return n;
+	}
+	bool HasEdge( int st_idx, int ed_idx )const	{		return ( GetRow( st_idx )[ed_idx / kWordBit] >> ( ed_idx % kWordBit ) ) & 1;	}
+	size_t GetWordCount()const noexcept	{		return m_n_word;	}
+	//out neighbors of node idx as bitset
+	std::span<const word_type> GetRow( int idx )const	{		return std::span<const word_type>( m_bits.data() + idx * m_n_word, m_n_word );	}
+	//next |= union of out neighbors of nodes in frontier
+	void ExpandFrontier( std::span<const word_type> frontier, std::span<word_type> next )const
+	{
+		assert( frontier.size() == m_n_word && next.size() == m_n_word );
+		ForEachBit( frontier, [&] ( int u )
+		{
+			const word_type* row = m_bits.data() + u * m_n_word;
+			for( size_t i = 0; i < m_n_word; i++ )
+				next[i] |= row[i];
+		} );
+	}
+	//distance (number of edges) from start, -1 if unreachable
+	std::vector<int> BFS( int start_idx )const
+	{
+		std::vector<int> dis( size_node(), -1 );
+		std::vector<word_type> visited( m_n_word ), frontier( m_n_word ), next( m_n_word );
+		frontier[start_idx / kWordBit] |= word_type( 1 ) << ( start_idx % kWordBit );
+		visited = frontier;
+		dis[start_idx] = 0;
+		for( int depth = 1;; ++depth )
+		{
+			std::fill( next.begin(), next.end(), 0 );
+			ExpandFrontier( frontier, next );
+			bool empty = true;
+			for( size_t i = 0; i < m_n_word; i++ )
+			{
+				next[i] &= ~visited[i];
+				visited[i] |= next[i];
+				empty &= next[i] == 0;
+			}
+			if( empty )
+				break;
+			ForEachBit( next, [&] ( int v ) { dis[v] = depth; } );
+			frontier.swap( next );
+		}
+		return dis;
+	}
+	//|N(a) and N(b)|
+	size_t CountCommonNeighbor( int a, int b )const
+	{
+		auto ra = GetRow( a );
+		auto rb = GetRow( b );
+		size_t n = 0;
+		for( size_t i = 0; i < m_n_word; i++ )
+			n += std::popcount( ra[i] & rb[i] );
+		return n;
+	}
+	//number of triangles, graph is treated as undirected (adjacency should be symmetric)
+	std::uint64_t CountTriangle()const
+	{
+		std::uint64_t n = 0;
+		for( int u = 0; u < (int)size_node(); u++ )
+		{
+			auto ru = GetRow( u );
+			for( int v = FindNext( u, u + 1 ); v < (int)size_node(); v = FindNext( u, v + 1 ) )
+			{
+				//count w>v in N(u) and N(v)
+				auto rv = GetRow( v );
+				size_t i = ( v + 1 ) / kWordBit;
+				if( i < m_n_word )
+					n += std::popcount( ru[i] & rv[i] & ( ~word_type( 0 ) << ( ( v + 1 ) % kWordBit ) ) );
+				for( ++i; i < m_n_word; i++ )
+					n += std::popcount( ru[i] & rv[i] );
+			}
+		}
+		return n;
+	}
+	template <typename Fn>
+	static void ForEachBit( std::span<const word_type> bits, Fn&& fn )
+	{
+		for( size_t i = 0; i < bits.size(); i++ )
+			for( word_type w = bits[i]; w; w &= w - 1 )
+				fn( int( i * kWordBit + std::countr_zero( w ) ) );
+	}
+
+protected:
+	word_type* GetRowData( int idx )	{		return m_bits.data() + idx * m_n_word;	}
+	//first t>=from with edge s->t, N if not found
+	int FindNext( int s, int from )const
+	{
+		const int n = (int)size_node();
+		if( s >= n || from >= n )
+			return n;
+		auto row = GetRow( s );
+		size_t i = from / kWordBit;
+		word_type w = row[i] & ( ~word_type( 0 ) << ( from % kWordBit ) );
+		while( !w )
+		{
+			if( ++i == m_n_word )
+				return n;
+			w = row[i];
+		}
+		return int( i * kWordBit + std::countr_zero( w ) );
+	}
+	const Edge* FindNextInverse( int from, int t )const
+	{
+		for( int s = from; s < (int)size_node(); ++s )
+			if( HasEdge( s, t ) )
+				return MakeEdge( s, t );
+		return nullptr;
+	}
+	const Edge* MakeEdge( int s, int t )const
+	{
+		std::atomic<Edge*>* row = m_view[s].load( std::memory_order_acquire );
+		if( !row )[[unlikely]]
+			row = Publish( m_view[s], new std::atomic<Edge*>[m_n_word]() );
+		const int i = t / kWordBit;
+		Edge* block = row[i].load( std::memory_order_acquire );
+		if( !block )[[unlikely]]
+		{
+			block = new Edge[kWordBit];
+			for( int k = 0; k < kWordBit; k++ )
+				InitEdge( block[k], s, i * kWordBit + k );
+			block = Publish( row[i], block );
+		}
+		return block + t % kWordBit;
+	}
+	//view of s->t if it is created, nullptr otherwise
+	const Edge* FindView( int s, int t )const
+	{
+		std::atomic<Edge*>* row = m_view[s].load( std::memory_order_acquire );
+		if( !row )
+			return nullptr;
+		Edge* block = row[t / kWordBit].load( std::memory_order_acquire );
+		return block ? block + t % kWordBit : nullptr;
+	}
+	void InitEdge( Edge& e, int s, int t )const
+	{
+		_Reset_idx( e, int( ( (std::uint64_t)s * size_node() + t ) & std::numeric_limits<int>::max() ) );
+		_Reset_source( e, s );
+		_Reset_destination( e, t );
+	}
+	//install p if slot is empty, otherwise another thread has done it, p is freed
+	template <typename T>
+	static T* Publish( std::atomic<T*>& slot, T* p )
+	{
+		T* expected = nullptr;
+		if( slot.compare_exchange_strong( expected, p, std::memory_order_acq_rel, std::memory_order_acquire ) )
+			return p;
+		delete[] p;
+		return expected;
+	}
+	void AllocView()
+	{
+		m_view = std::make_unique<std::atomic<std::atomic<Edge*>*>[]>( size_node() );
+	}
+	//before size_node() or m_n_word changes
+	void FreeView()noexcept
+	{
+		if( !m_view )
+			return;
+		for( size_t s = 0; s < size_node(); s++ )
+			if( std::atomic<Edge*>* row = m_view[s].load() )
+			{
+				for( size_t i = 0; i < m_n_word; i++ )
+					delete[] row[i].load();
+				delete[] row;
+			}
+		m_view.reset();
+	}
+
+	//iterate edge by (source,destination)
+	template <bool is_const_iterator>
+	class _Iterator_edge
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type		= Edge;
+		using difference_type	= int;
+		using pointer			= std::conditional_t<is_const_iterator, const Edge*, Edge*>;
+		using reference			= std::conditional_t<is_const_iterator, const Edge&, Edge&>;
+
+	protected:
+		const BitsetDenseGraph* g = nullptr;
+		int s = 0;
+		int t = 0;
+
+		_Iterator_edge( const BitsetDenseGraph* g, int s, int t ) :g( g ), s( s ), t( t )
+		{
+			Normalize();
+		}
+		void Normalize()
+		{
+			const int n = (int)g->size_node();
+			while( s < n && t >= n )
+				t = g->FindNext( ++s, 0 );
+			if( s >= n )
+			{
+				s = n;
+				t = 0;
+			}
+		}
+	public:
+		friend class BitsetDenseGraph;
+		_Iterator_edge& operator++()
+		{
+			t = g->FindNext( s, t + 1 );
+			Normalize();
+			return *this;
+		}
+		_Iterator_edge operator++( int )
+		{
+			_Iterator_edge retval = *this;
+			++( *this );
+			return retval;
+		}
+		bool operator==( const _Iterator_edge& other ) const		{			return s == other.s && t == other.t && g == other.g;		}
+		bool operator!=( const _Iterator_edge& other ) const		{			return !( *this == other );		}
+		pointer operator->() const		{			return &**this;		}
+		reference operator*() const
+		{
+			return const_cast<reference>( *g->MakeEdge( s, t ) );
+		}
+	};
+};
+static_assert( graph_type<BitsetDenseGraph<BasicNode, BasicEdge>> );
+}
\ No newline at end of file
@@ -12,6 +12,11 @@
 #include <functional>
 #include <deque>
 #include <format>
+#include <memory>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <utility>
 
 namespace CFG
 {
@@ -58,6 +63,7 @@ private:
 	std::vector<int> seq;//data (ex. A->BCD)
 	std::vector<Rule> relation;
 	std::vector<std::span<const Rule>> dom2relation;
+	std::vector<char> nullable;//nonterminal->derive empty string
 	std::map<int, StringType> terminal2str;//for visualization
 	std::map<int, StringType> nonterminal2str;//for generating desc
 	
@@ -80,6 +86,9 @@ public:
 	const Rule& GetRule( const int idx )const												{		return relation[idx];	}
 	typename decltype( dom2relation )::value_type GetRuleListByDom( const int dom )const	{		return dom2relation[dom];	}
 	int GetTerminalOffset()const noexcept													{		return terminal_offset;	}
+	int GetNonTerminalCount()const noexcept													{		return (int)dom2relation.size();	}
+	int GetRuleCount()const noexcept														{		return (int)relation.size();	}
+	bool isNullable( const int id )const noexcept											{		return !isTerminal( id ) && id >= 0 && id < (int)nullable.size() && nullable[id];	}
 	void SetTerminalOffset( const int val )noexcept
 	{
 		assert( val > 0 );
@@ -147,6 +156,7 @@ public:
 		}
 		for( auto [dom, range] : dom2range )
 			dom2relation[dom] = decltype( dom2relation )::value_type( relation.begin() + range.first, relation.begin() + range.second + 1 );
+		CalcNullable();
 		//final
 		GenerateDescription();
 		
@@ -166,9 +176,9 @@ public:
 			e = toTerminal( e );
 		AddNonTerminal( dom, q, ext_info );
 	}
+	//empty q := dom->epsilon
 	void AddNonTerminal( int dom, const std::vector<int>& q, const ExternalStruct& ext_info = {} )
 	{
-		assert( !q.empty() );
 		seq.insert( seq.end(), q.begin(), q.end() );
 		seq.emplace_back( Seperator );
 		auto& e = relation.emplace_back( ext_info );
@@ -201,6 +211,7 @@ public:
 		seq.clear();
 		relation.clear();
 		dom2relation.clear();
+		nullable.clear();
 		terminal2str.clear();
 	}
 	bool isTerminal( int val )const noexcept	{		return val >= terminal_offset;	}
@@ -211,6 +222,24 @@ public:
 	}
 
 private:
+	//fixed point, A is nullable iff A->BC... with all B,C,... nullable (A->epsilon included)
+	void CalcNullable()
+	{
+		nullable.assign( dom2relation.size(), 0 );
+		for( bool update = true; update; )
+		{
+			update = false;
+			for( auto& rule : relation )
+				if( !nullable[rule.dom] && std::all_of( rule.dest.begin(), rule.dest.end(), [this] ( int id )
+				{
+					return isNullable( id );
+				} ) )
+				{
+					nullable[rule.dom] = 1;
+					update = true;
+				}
+		}
+	}
 	void GenerateDescription()
 	{
 		nonterminal2str[StartNonTerminal] = T( "S" );
@@ -349,6 +378,375 @@ template <grammar_type G>
 }
 }
 
+//LALR(1) parse table, LR(1) states with the same core are merged while lookahead is propagated to fixed point
+//grammar with shift-reduce or reduce-reduce conflict is rejected, so the parse tree is unique and same as Earley
+//operator priority of AddExprWithPriority is encoded by the levels of rules, no conflict is resolved by priority here
+template <grammar_type T_Grammar>
+class LALRtable
+{
+public:
+	using Grammar = T_Grammar;
+	//0 := error, >0 := shift to state val-1, <0 := reduce rule -val-1 (rule GetRuleCount() := accept)
+	using Action = std::int32_t;
+
+	enum struct tError
+	{
+		kSuc = 0,
+		kEmptyGrammar,
+		kConflict,
+		kTooManyState,
+	};
+
+private:
+	using Bits = std::vector<std::uint64_t>;
+	using Item = std::pair<int, int>;//<rule idx,offset>
+	struct LRState
+	{
+		std::vector<Item> core;//kernel items, sorted
+		std::vector<Bits> la;//lookahead of core[i]
+		std::vector<std::pair<int, int>> trans;//<symbol,state>
+	};
+
+	tError status = tError::kEmptyGrammar;
+	int n_state = 0;
+	int n_class = 0;//terminal class (same column of action), -1 := error
+	int n_nonterminal = 0;
+	int accept_rule = -1;
+	int end_class = -1;
+	std::vector<int> token2class;//raw token->class
+	std::vector<Action> action;//[state][class]
+	std::vector<int> go;//[state][nonterminal], -1 := error
+	std::vector<int> rule_len;
+	std::vector<int> rule_dom;
+
+public:
+	LALRtable()
+	{}
+	void clear()
+	{
+		status = tError::kEmptyGrammar;
+		n_state = n_class = n_nonterminal = 0;
+		accept_rule = end_class = -1;
+		token2class.clear();
+		action.clear();
+		go.clear();
+		rule_len.clear();
+		rule_dom.clear();
+	}
+	tError GetStatus()const noexcept	{		return status;	}
+	bool isValid()const noexcept		{		return status == tError::kSuc;	}
+	int GetStateCount()const noexcept	{		return n_state;	}
+	int GetClassCount()const noexcept	{		return n_class;	}
+	int GetEndClass()const noexcept		{		return end_class;	}
+	int GetClass( const int token )const noexcept
+	{
+		return (unsigned)token < token2class.size() ? token2class[token] : -1;
+	}
+	Action GetAction( const int state, const int cls )const noexcept
+	{
+		return cls < 0 ? 0 : action[(size_t)state * n_class + cls];
+	}
+	int GetGoto( const int state, const int nonterminal )const noexcept	{		return go[(size_t)state * n_nonterminal + nonterminal];	}
+	int GetRuleLength( const int rule_idx )const noexcept				{		return rule_len[rule_idx];	}
+	int GetRuleDom( const int rule_idx )const noexcept					{		return rule_dom[rule_idx];	}
+	static constexpr bool isShift( const Action a )noexcept		{		return a > 0;	}
+	static constexpr bool isReduce( const Action a )noexcept	{		return a < 0;	}
+	static constexpr int GetShiftState( const Action a )noexcept	{		return a - 1;	}
+	static constexpr int GetReduceRule( const Action a )noexcept	{		return -a - 1;	}
+	bool isAccept( const Action a )const noexcept	{		return a == -accept_rule - 1;	}
+
+	//grammar must be initialized
+	tError Build( const Grammar& g, const int max_state = 1 << 16 )
+	{
+		clear();
+		const int n_rule = g.GetRuleCount();
+		if( n_rule == 0 )
+			return status;
+		n_nonterminal = g.GetNonTerminalCount();
+		accept_rule = n_rule;
+		//augmented rule S'->S
+		const int start_symbol[1] = { StartNonTerminal };
+		auto rhs = [&] ( const int rule_idx )->std::span<const int>
+		{
+			return rule_idx == accept_rule ? std::span<const int>( start_symbol ) : g.GetRule( rule_idx ).dest;
+		};
+		//dense terminal idx, the last one := end of text
+		const int offset = g.GetTerminalOffset();
+		std::vector<int> raw2term;
+		std::vector<int> term2raw;
+		for( int i = 0; i < n_rule; ++i )
+			for( int id : g.GetRule( i ).dest )
+				if( g.isTerminal( id ) )
+				{
+					const int raw = id - offset;
+					if( raw >= (int)raw2term.size() )
+						raw2term.resize( raw + 1, -1 );
+					if( raw2term[raw] == -1 )
+					{
+						raw2term[raw] = (int)term2raw.size();
+						term2raw.push_back( raw );
+					}
+				}
+		const int n_term = (int)term2raw.size();
+		const int end_term = n_term;
+		const size_t width = ( n_term + 1 + 63 ) / 64;
+		auto set_bit = [] ( Bits& b, const int x )
+		{
+			b[x >> 6] |= 1ULL << ( x & 63 );
+		};
+		auto merge = [] ( Bits& to, const Bits& from )->bool
+		{
+			bool changed = false;
+			for( size_t k = 0; k < to.size(); ++k )
+				if( ( to[k] | from[k] ) != to[k] )
+				{
+					to[k] |= from[k];
+					changed = true;
+				}
+			return changed;
+		};
+		//first set of nonterminal
+		std::vector<Bits> first( n_nonterminal, Bits( width, 0 ) );
+		for( bool update = true; update; )
+		{
+			update = false;
+			for( int i = 0; i < n_rule; ++i )
+			{
+				auto& to = first[g.GetRule( i ).dom];
+				for( int id : g.GetRule( i ).dest )
+				{
+					if( g.isTerminal( id ) )
+					{
+						const int t = raw2term[id - offset];
+						if( !( to[t >> 6] >> ( t & 63 ) & 1 ) )
+						{
+							set_bit( to, t );
+							update = true;
+						}
+						break;
+					}
+					update |= merge( to, first[id] );
+					if( !g.isNullable( id ) )
+						break;
+				}
+			}
+		}
+		//LR(1) closure of kernel, lookahead of nonkernel item A->.x is kept per rule
+		std::vector<int> rule2item( n_rule, -1 );
+		auto closure = [&] ( const LRState& s, std::vector<Item>& item, std::vector<Bits>& la )
+		{
+			item = s.core;
+			la = s.la;
+			std::vector<int> stk( item.size() );
+			for( int k = 0; k < (int)item.size(); ++k )
+				stk[k] = (int)item.size() - 1 - k;
+			std::vector<char> in_stk( item.size(), 1 );
+			Bits tmp( width );
+			while( !stk.empty() )
+			{
+				const int k = stk.back();
+				stk.pop_back();
+				in_stk[k] = 0;
+				const auto q = rhs( item[k].first );
+				const int pos = item[k].second;
+				if( pos >= (int)q.size() || g.isTerminal( q[pos] ) )
+					continue;
+				//first(rest)+(rest is nullable ? la : empty)
+				std::fill( tmp.begin(), tmp.end(), 0 );
+				bool nullable_rest = true;
+				for( int j = pos + 1; j < (int)q.size() && nullable_rest; ++j )
+				{
+					if( g.isTerminal( q[j] ) )
+					{
+						set_bit( tmp, raw2term[q[j] - offset] );
+						nullable_rest = false;
+					}
+					else
+					{
+						merge( tmp, first[q[j]] );
+						nullable_rest = g.isNullable( q[j] );
+					}
+				}
+				if( nullable_rest )
+					merge( tmp, la[k] );
+				for( auto& rule : g.GetRuleListByDom( q[pos] ) )
+				{
+					int& x = rule2item[rule.idx];
+					bool changed = false;
+					if( x == -1 )
+					{
+						x = (int)item.size();
+						item.emplace_back( rule.idx, 0 );
+						la.push_back( tmp );
+						in_stk.push_back( 0 );
+						changed = true;
+					}
+					else
+						changed = merge( la[x], tmp );
+					if( changed && !in_stk[x] )
+					{
+						in_stk[x] = 1;
+						stk.push_back( x );
+					}
+				}
+			}
+			for( auto& e : item )
+				if( e.second == 0 && e.first != accept_rule )
+					rule2item[e.first] = -1;
+		};
+
+		std::vector<LRState> state;
+		std::map<std::vector<Item>, int> core2state;
+		auto& s0 = state.emplace_back();
+		s0.core = { Item( accept_rule,0 ) };
+		s0.la = { Bits( width,0 ) };
+		set_bit( s0.la[0], end_term );
+		core2state[s0.core] = 0;
+		std::deque<int> wait = { 0 };
+		std::vector<char> in_wait = { 1 };
+		std::vector<Item> item;
+		std::vector<Bits> la;
+		while( !wait.empty() )
+		{
+			const int cur = wait.front();
+			wait.pop_front();
+			in_wait[cur] = 0;
+			closure( state[cur], item, la );
+			//group by next symbol
+			std::map<int, std::vector<int>> next;
+			for( int k = 0; k < (int)item.size(); ++k )
+				if( const auto q = rhs( item[k].first ); item[k].second < (int)q.size() )
+					next[q[item[k].second]].push_back( k );
+			std::vector<std::pair<int, int>> trans;
+			trans.reserve( next.size() );
+			for( auto& [symbol, list] : next )
+			{
+				std::vector<std::pair<Item, int>> kernel;
+				kernel.reserve( list.size() );
+				for( int k : list )
+					kernel.emplace_back( Item( item[k].first, item[k].second + 1 ), k );
+				std::sort( kernel.begin(), kernel.end() );
+				std::vector<Item> core;
+				core.reserve( kernel.size() );
+				for( auto& e : kernel )
+					core.push_back( e.first );
+				auto [it, inserted] = core2state.try_emplace( std::move( core ), (int)state.size() );
+				const int to = it->second;
+				bool changed = inserted;
+				if( inserted )
+				{
+					if( (int)state.size() >= max_state )
+						return status = tError::kTooManyState;
+					auto& s = state.emplace_back();
+					s.core = it->first;
+					s.la.assign( kernel.size(), Bits( width, 0 ) );
+					in_wait.push_back( 0 );
+				}
+				for( size_t j = 0; j < kernel.size(); ++j )
+					changed |= merge( state[to].la[j], la[kernel[j].second] );
+				if( changed && !in_wait[to] )
+				{
+					in_wait[to] = 1;
+					wait.push_back( to );
+				}
+				trans.emplace_back( symbol, to );
+			}
+			state[cur].trans.swap( trans );
+		}
+
+		//action and goto
+		n_state = (int)state.size();
+		const int n_column = n_term + 1;
+		std::vector<Action> full( (size_t)n_state * n_column, 0 );
+		go.assign( (size_t)n_state * n_nonterminal, -1 );
+		bool conflict = false;
+		auto set_action = [&] ( const int s, const int column, const Action a )
+		{
+			Action& e = full[(size_t)s * n_column + column];
+			if( e == 0 )
+				e = a;
+			else if( e != a )
+				conflict = true;
+		};
+		for( int s = 0; s < n_state && !conflict; ++s )
+		{
+			for( auto [symbol, to] : state[s].trans )
+				if( g.isTerminal( symbol ) )
+					set_action( s, raw2term[symbol - offset], to + 1 );
+				else
+					go[(size_t)s * n_nonterminal + symbol] = to;
+			closure( state[s], item, la );
+			for( int k = 0; k < (int)item.size(); ++k )
+				if( item[k].second == (int)rhs( item[k].first ).size() )
+					for( int t = 0; t < n_column; ++t )
+						if( la[k][t >> 6] >> ( t & 63 ) & 1 )
+							set_action( s, t, -item[k].first - 1 );
+		}
+		if( conflict )
+		{
+			clear();
+			return status = tError::kConflict;
+		}
+		//compress identical columns
+		std::map<std::vector<Action>, int> column2class;
+		std::vector<int> term2class( n_column );
+		for( int t = 0; t < n_column; ++t )
+		{
+			std::vector<Action> column( n_state );
+			for( int s = 0; s < n_state; ++s )
+				column[s] = full[(size_t)s * n_column + t];
+			term2class[t] = column2class.try_emplace( std::move( column ), (int)column2class.size() ).first->second;
+		}
+		n_class = (int)column2class.size();
+		action.assign( (size_t)n_state * n_class, 0 );
+		for( int t = 0; t < n_column; ++t )
+			for( int s = 0; s < n_state; ++s )
+				action[(size_t)s * n_class + term2class[t]] = full[(size_t)s * n_column + t];
+		token2class.assign( raw2term.size(), -1 );
+		for( int t = 0; t < n_term; ++t )
+			token2class[term2raw[t]] = term2class[t];
+		end_class = term2class[end_term];
+		rule_len.resize( n_rule + 1 );
+		rule_dom.resize( n_rule + 1 );
+		for( int i = 0; i < n_rule; ++i )
+		{
+			rule_len[i] = (int)g.GetRule( i ).dest.size();
+			rule_dom[i] = g.GetRule( i ).dom;
+		}
+		rule_len[accept_rule] = 1;
+		rule_dom[accept_rule] = -1;
+		return status = tError::kSuc;
+	}
+};
+
+//immutable grammar and its LALR table, shared by parsers (read only, thread safe)
+template <grammar_type T_Grammar>
+class CompiledGrammar
+{
+public:
+	using Grammar = T_Grammar;
+
+private:
+	Grammar grammar;
+	LALRtable<Grammar> lalr;
+
+public:
+	explicit CompiledGrammar( const Grammar& g )
+	{
+		grammar.DeepCopy( g );
+		lalr.Build( grammar );
+	}
+	CompiledGrammar( const CompiledGrammar& ) = delete;
+	CompiledGrammar& operator=( const CompiledGrammar& ) = delete;
+
+	static std::shared_ptr<const CompiledGrammar> Create( const Grammar& g )
+	{
+		return std::make_shared<const CompiledGrammar>( g );
+	}
+	const Grammar& GetGrammar()const noexcept				{		return grammar;	}
+	const LALRtable<Grammar>& GetLALRtable()const noexcept	{		return lalr;	}
+};
+
 template <grammar_type T_Grammar = Grammar<>>
 class CFGparser
 {
@@ -382,18 +780,169 @@ public:
 			return std::make_tuple( this->rule_idx, this->pos, this->pos_end, this->offset ) < std::make_tuple( other.rule_idx, other.pos, other.pos_end, other.offset );
 		}
 	};
+	//open addressing hash map State->int, linear probing, capacity is power of 2
+	class StateMap
+	{
+	private:
+		std::vector<State> key;//rule_idx==-1 := empty slot
+		std::vector<int> val;
+		size_t n = 0;
+
+	public:
+		size_t size()const noexcept	{		return n;	}
+		bool empty()const noexcept	{		return n == 0;	}
+		//capacity is kept
+		void clear()noexcept
+		{
+			if( n != 0 )
+				std::fill( key.begin(), key.end(), State{ -1,0,0 } );
+			n = 0;
+		}
+		const int* find( const State& s )const noexcept
+		{
+			if( key.empty() )
+				return nullptr;
+			const size_t mask = key.size() - 1;
+			for( size_t i = Hash( s ) & mask;; i = ( i + 1 ) & mask )
+			{
+				if( key[i].rule_idx == -1 )
+					return nullptr;
+				if( Equal( key[i], s ) )
+					return &val[i];
+			}
+		}
+		//<stored value,inserted>
+		std::pair<int, bool> insert( const State& s, const int v )
+		{
+			if( ( n + 1 ) * 2 > key.size() )
+				rehash( std::max<size_t>( 16, key.size() * 2 ) );
+			const size_t mask = key.size() - 1;
+			size_t i = Hash( s ) & mask;
+			for( ; key[i].rule_idx != -1; i = ( i + 1 ) & mask )
+				if( Equal( key[i], s ) )
+					return { val[i],false };
+			key[i] = s;
+			val[i] = v;
+			++n;
+			return { v,true };
+		}
+
+	private:
+		static size_t Hash( const State& s )noexcept
+		{
+			std::uint64_t h = ( (std::uint64_t)(std::uint32_t)s.rule_idx << 32 | (std::uint32_t)s.pos ) * 0x9E3779B97F4A7C15ULL;
+			h ^= (std::uint64_t)(std::uint32_t)s.offset * 0xC2B2AE3D27D4EB4FULL;
+			return (size_t)( h ^ ( h >> 31 ) );
+		}
+		static bool Equal( const State& a, const State& b )noexcept
+		{
+			return a.rule_idx == b.rule_idx && a.pos == b.pos && a.offset == b.offset;
+		}
+		void rehash( const size_t capacity )
+		{
+			std::vector<State> old_key( capacity, State{ -1,0,0 } );
+			std::vector<int> old_val( capacity, -1 );
+			old_key.swap( key );
+			old_val.swap( val );
+			const size_t mask = capacity - 1;
+			for( size_t j = 0; j < old_key.size(); ++j )
+				if( old_key[j].rule_idx != -1 )
+				{
+					size_t i = Hash( old_key[j] ) & mask;
+					while( key[i].rule_idx != -1 )
+						i = ( i + 1 ) & mask;
+					key[i] = old_key[j];
+					val[i] = old_val[j];
+				}
+		}
+	};
+	//node storage in fixed size blocks, handle is the int idx, handle and reference are stable when growing
+	//reset() releases all nodes in O(1), blocks are kept for the next parse
+	template <typename T, int BlockBit = 12>
+	class NodeArena
+	{
+	private:
+		static constexpr int block_size = 1 << BlockBit;
+		std::vector<std::unique_ptr<T[]>> block;
+		int n = 0;
+
+	public:
+		int size()const noexcept		{		return n;	}
+		bool empty()const noexcept		{		return n == 0;	}
+		size_t capacity()const noexcept	{		return block.size() * block_size;	}
+		void reset()noexcept			{		n = 0;	}
+		T& operator[]( const int h )noexcept				{		return block[h >> BlockBit][h & ( block_size - 1 )];	}
+		const T& operator[]( const int h )const noexcept	{		return block[h >> BlockBit][h & ( block_size - 1 )];	}
+		template <typename... Args>
+		T& emplace_back( Args&&... args )
+		{
+			if( (size_t)n == capacity() )
+				block.emplace_back( std::make_unique<T[]>( block_size ) );
+			T& e = ( *this )[n++];
+			e = T( std::forward<Args>( args )... );
+			return e;
+		}
+	};
+	//Reference:Leo, A general context-free parsing algorithm running in linear time on every LR(k) grammar
+	//A->a.B is the only item waiting for symbol B, completing B from here ends up with top (a complete item)
+	//items between are skipped when parsing and only created for the parse tree
+	struct LeoItem
+	{
+		int symbol = -1;
+		int chain = -1;//idx of leo_chain
+		State top;
+	};
 	struct Phase
 	{
 		int idx = -1;
-		std::set<State> used;
+		StateMap used;//state->node idx in expressionDAG
 		std::vector<State> q;
+		std::vector<int> node;//node idx of q[i]
+		std::vector<std::pair<int, int>> wait;//sorted <next nonterminal,q idx>, built after phase is finished
+		std::vector<LeoItem> leo;//sorted by symbol
+		int mark = 0;//-1 := discarded
+
+		//capacity is kept
+		void clear()noexcept
+		{
+			idx = -1;
+			used.clear();
+			q.clear();
+			node.clear();
+			wait.clear();
+			leo.clear();
+			mark = 0;
+		}
 	};
 
 private:
-	Grammar grammar;
+	std::shared_ptr<const CompiledGrammar<Grammar>> compiled;
 	std::vector<int> text;
+	std::vector<int> m_input;//scratch of Parse()
+	bool m_enable_lalr = true;//shift-reduce parse is used in Parse() if the grammar is LALR(1)
 
 	std::vector<Phase> dp;
+	std::vector<Phase> phase_pool;//cleared phase for reuse
+	std::vector<int> predicted_at;//nonterminal->last dp idx which predicted it
+	std::vector<int> wait_head;//nullable nonterminal->last processed q idx of current phase waiting for it, valid iff predicted_at is current phase
+	std::vector<int> wait_next;//q idx->previous q idx waiting for the same nonterminal
+	bool m_discard_phase = false;
+	int m_discard_mark = 0;
+	std::vector<int> m_kept_phase;//not discarded, descending
+	//step of leo item chain, kept outside phase so that phase can be discarded
+	struct LeoChain
+	{
+		State done;//A->aB.
+		int old_node = -1;//node of A->a.B
+		int next = -1;//-1 := done is top
+	};
+	struct LeoLink
+	{
+		int complete_node = -1;//node of completed B
+		int chain = -1;
+	};
+	std::vector<LeoChain> leo_chain;
+	std::vector<LeoLink> leo_link;//left of node is -2-idx of this until the skipped items are created
 	/*
 	* Expr->ABCD (finish D)
 	* Expr.left==D
@@ -402,12 +951,14 @@ private:
 	* Expr.right.right==Expr->ABCD (finish B)
 	* Expr.right.right.left==B
 	*/
+	//node handle is the idx in expressionDAG
+	//8 ints per node (FullState and 4 links), not packed
 	struct ExprNode :public FullState
 	{
-		int idx = -1;
 		int parent = -1;//ambiguous when parsing, need to calc after parsing from root with GetChildList
 		int left = -1;//child of current element
 		int right = -1;//right->right->... to visit each element in dest in BW order
+		int child = -1;//tree node := begin in child_list, set with parent
 
 		int GetNextNodeIdx()const noexcept
 		{
@@ -419,25 +970,55 @@ private:
 		}
 	};
 	int root = -1;
-	std::map<FullState, int> state2idx;
-	std::vector<ExprNode> expressionDAG;
+	NodeArena<ExprNode> expressionDAG;//node of FullState(dp idx,state) is dp[dp idx].used[state]
+	std::vector<int> child_list;//children of each tree node from left to right, ended by -1
+	struct LRStackEntry
+	{
+		int state = 0;
+		int node = -1;//-1 := terminal
+		int end = 0;//end of matching string
+	};
+	std::vector<LRStackEntry> m_lr_stack;//scratch of ParseLALR
+	std::vector<int> m_queue;//scratch of CalcParent
 
 public:
-	CFGparser()
+	CFGparser() :compiled( CompiledGrammar<Grammar>::Create( Grammar() ) )
 	{}
+	explicit CFGparser( std::shared_ptr<const CompiledGrammar<Grammar>> g ) :compiled( std::move( g ) )
+	{
+		assert( compiled );
+	}
 	~CFGparser()
 	{}
 
-	const Grammar& GetGrammar()const			{		return grammar;	}
+	const Grammar& GetGrammar()const			{		return compiled->GetGrammar();	}
 	const decltype( text )& GetText()const		{		return text;	}
-	void SetGrammar( const Grammar& g )			{		grammar.DeepCopy( g );	}
+	const LALRtable<Grammar>& GetLALRtable()const	{		return compiled->GetLALRtable();	}
+	const std::shared_ptr<const CompiledGrammar<Grammar>>& GetCompiledGrammar()const	{		return compiled;	}
+	//compile a private copy, share one CompiledGrammar instead when many parsers use the same grammar
+	void SetGrammar( const Grammar& g )			{		compiled = CompiledGrammar<Grammar>::Create( g );	}
+	void SetGrammar( std::shared_ptr<const CompiledGrammar<Grammar>> g )
+	{
+		assert( g );
+		compiled = std::move( g );
+	}
 	void SetText( const decltype( text )& val )	{		text = val;	}
 	void clear()
 	{
 		root = -1;
+		for( auto& e : dp )
+		{
+			e.clear();
+			phase_pool.emplace_back( std::move( e ) );
+		}
 		dp.clear();
-		state2idx.clear();
-		expressionDAG.clear();
+		predicted_at.clear();
+		wait_head.clear();
+		leo_chain.clear();
+		leo_link.clear();
+		m_kept_phase.clear();
+		expressionDAG.reset();
+		child_list.clear();
 	}
 	bool Parse( const Grammar& g, const decltype( text )& _text )
 	{
@@ -450,80 +1031,81 @@ public:
 		SetText( _text );
 		return Parse();
 	}
+	//table-driven shift-reduce parse if the grammar is LALR(1), otherwise (or on syntax error, for the report) Earley
 	bool Parse()
+	{
+		if( m_enable_lalr && GetLALRtable().isValid() )
+		{
+			clear();
+			if( ParseLALR() )
+				return true;
+		}
+		m_input.swap( text );
+		StartStream();
+		Feed( m_input );
+		return Finish();
+	}
+	//use LALR table in Parse() when the grammar has no conflict, tree is same as Earley
+	void ConfigLALR( bool enable )noexcept	{		m_enable_lalr = enable;	}
+
+	/*push style parse: StartStream -> Feed (any times) -> Finish*/
+
+	enum struct tStreamState
+	{
+		kReject,//no sentence starts with the text
+		kPrefix,//text is prefix of some sentence
+		kMatch,//text is a sentence (and maybe prefix of others)
+	};
+	//release phase which is not reachable from the last phase after each Feed, this bounds the Earley phase data only
+	//text, expressionDAG and leo chain still grow with the whole input since Finish() builds the parse tree of whole text
+	void ConfigDiscardPhase( bool discard_phase )noexcept	{		m_discard_phase = discard_phase;	}
+	void StartStream()
 	{
 		clear();
-		dp.resize( text.size() + 1 );
-		for( int idx = 0; auto & e:dp )
-			e.idx = idx++;
-		//init
-		for( auto& it : grammar.GetRuleListByDom( StartNonTerminal ) )
+		text.clear();
+		NewPhase( 0 );
+		predicted_at.assign( GetGrammar().GetNonTerminalCount(), -1 );
+		wait_head.assign( GetGrammar().GetNonTerminalCount(), -1 );
+		for( auto& it : GetGrammar().GetRuleListByDom( StartNonTerminal ) )
 		{
 			State x{ it.idx,0,0 };
 			tryAddState( dp.front(), x );
 		}
-		//dp
-		for( int i = 0; i <= (int)text.size(); ++i )
-		{
-			auto& cur_dp = dp[i];
-			for( int j = 0; j < (int)cur_dp.q.size(); ++j )
-			{
-				auto cur = cur_dp.q[j];
-				if( isComplete( cur ) )
-				{
-					assert( cur.pos < i );
-					for( auto& e : dp[cur.pos].q )
-					{
-						if( isComplete( e ) )
-							continue;
-						const int nxt_id = GetNextSymbol( e );
-						if( nxt_id == grammar.GetRule( cur.rule_idx ).dom )
-						{
-							auto tmp = e;
-							++tmp.offset;
-							tryAddState( cur_dp, tmp );
-							addLink( FullState( cur_dp.idx, tmp ), FullState( cur_dp.idx, cur ), FullState( cur.pos, e ) );//<new,complete,old>
-						}
-					}
-				}
-				else
-				{
-					const int id = GetNextSymbol( cur );
-					if( grammar.isTerminal( id ) )
-					{
-						if( i < (int)text.size() && id - grammar.GetTerminalOffset() == text[i] )
-						{
-							auto tmp = cur;
-							++tmp.offset;
-							tryAddState( dp[i + 1], tmp );
-							addLink( FullState( i + 1, tmp ), std::nullopt, FullState( cur_dp.idx, cur ) );//<new,null,old>
-						}
-					}
-					else
-					{
-						for( auto& e : grammar.GetRuleListByDom( id ) )
-						{
-							State tmp{ .rule_idx = e.idx,.pos = i,.offset = 0 };
-							tryAddState( cur_dp, tmp );
-						}
-					}
-				}
-			}
-		}
-		//find root (if more than one possible S, choose any)
-		for( auto& rule : grammar.GetRuleListByDom( StartNonTerminal ) )
+		ClosePhase( 0 );
+		m_kept_phase = { 0 };
+	}
+	//tokens after rejection are appended without parsing
+	tStreamState Feed( std::span<const int> token )
+	{
+		assert( !dp.empty() );
+		for( int ch : token )
 		{
-			State done;
-			done.rule_idx = rule.idx;
-			done.pos = 0;
-			done.offset = static_cast<int>( rule.dest.size() );
-			if( dp[text.size()].used.find( done ) != dp[text.size()].used.end() )
+			const int i = (int)text.size();
+			text.emplace_back( ch );
+			NewPhase( i + 1 );
+			if( !dp[i].q.empty() )
 			{
-				auto r = state2idx.find( FullState( (int)text.size(), done ) );
-				root = ( r == state2idx.end() ) ? -1 : r->second;
-				break;
+				ScanPhase( i );
+				ClosePhase( i + 1 );
 			}
 		}
+		if( m_discard_phase && !dp.back().q.empty() )
+			DiscardPhase();
+		return GetStreamState();
+	}
+	tStreamState GetStreamState()const
+	{
+		if( dp.empty() )
+			return root != -1 ? tStreamState::kMatch : tStreamState::kReject;
+		if( dp.back().q.empty() )
+			return tStreamState::kReject;
+		return FindRoot() != -1 ? tStreamState::kMatch : tStreamState::kPrefix;
+	}
+	//build parse tree of whole text
+	bool Finish()
+	{
+		root = FindRoot();
+		CreateLeoNode();
 		const bool r = CalcParent();
 		return r;
 	}
@@ -542,17 +1124,29 @@ public:
 	}
 	const FullState& GetNode( int idx )const	{		return expressionDAG[idx];	}
 	int GetParent( int idx )const				{		return expressionDAG[idx].parent;	}
-	//from left to right in dest
+	int GetNodeCount()const noexcept			{		return expressionDAG.size();	}
+	//from left to right in dest, no allocation, empty if idx is not in the parse tree
+	std::span<const int> GetChildren( int idx )const
+	{
+		if( idx < 0 || idx >= expressionDAG.size() || expressionDAG[idx].child < 0 ) [[unlikely]]
+			return {};
+		const int* bg = child_list.data() + expressionDAG[idx].child;
+		const int* ed = bg;
+		while( *ed != -1 )
+			++ed;
+		return std::span<const int>( bg, ed );
+	}
+	//from left to right in dest, any node in DAG
 	std::vector<int> GetChildList( int idx )const
 	{
-		if( idx < 0 || idx >= (int)expressionDAG.size() ) [[unlikely]]
+		if( idx < 0 || idx >= expressionDAG.size() ) [[unlikely]]
 			return {};
 		std::vector<int> ret;
 		ret.reserve( 8 );
 		for( int p = idx; p != -1; p = expressionDAG[p].GetNextNodeIdx() )
 		{
 			const int child = expressionDAG[p].GetChildIdx();
-			if( child != -1 )
+			if( child >= 0 )
 				ret.emplace_back( child );
 		}
 		std::reverse( ret.begin(), ret.end() );
@@ -567,11 +1161,11 @@ public:
 	void toExprTreeString( StringStreamType& ss, const int root, const int deep = 1 )const
 	{
 		auto& me = expressionDAG[root];
-		ss << me.idx << '(' << me.parent << ')' << ": " << grammar.GetRule( me.rule_idx ).desc << " -> " << grammar.toString( GetText( me ) ) << '\n';
+		ss << root << '(' << me.parent << ')' << ": " << GetGrammar().GetRule( me.rule_idx ).desc << " -> " << GetGrammar().toString( GetText( me ) ) << '\n';
 		for( int p = root; p != -1; p = expressionDAG[p].GetNextNodeIdx() )
 		{
 			const int child = expressionDAG[p].GetChildIdx();
-			if( child != -1 && grammar.GetRule( expressionDAG[child].rule_idx ).isPrint )
+			if( child >= 0 && GetGrammar().GetRule( expressionDAG[child].rule_idx ).isPrint )
 			{
 				ss << StringType( deep * 2, ' ' );
 				toExprTreeString( ss, child, deep + 1 );
@@ -616,11 +1210,11 @@ public:
 			if( ng_pos < (int)text.size() && ng_pos >= 0 )
 			{
 				int ch[1] = { text[ng_pos] };
-				ret.ch = grammar.toString( ch );
+				ret.ch = GetGrammar().toString( ch );
 			}
 			else
-				ret.ch = grammar.T( "End" );
-			ret.text = grammar.toString( GetText() );
+				ret.ch = GetGrammar().T( "End" );
+			ret.text = GetGrammar().toString( GetText() );
 			ret.type = ( ng_pos == text.size() ) ? tError::kFinalState : tError::kMidState;
 
 			std::vector<int> expect_charlist;
@@ -632,28 +1226,28 @@ public:
 				if( isComplete( *it ) )
 				{
 					state = 1;
-					state_str = grammar.T( "complete" );
+					state_str = GetGrammar().T( "complete" );
 				}
-				else if( grammar.isTerminal( GetNextSymbol( *it ) ) )
+				else if( GetGrammar().isTerminal( GetNextSymbol( *it ) ) )
 				{
 					state = 2;
-					state_str = grammar.T( "expect" );
+					state_str = GetGrammar().T( "expect" );
 				}
 				else
 				{
 					state = 3;
-					state_str = grammar.T( "predict" );
+					state_str = GetGrammar().T( "predict" );
 				}
 
 				if( state == 2 )
-					expect_charlist.emplace_back( GetNextSymbol( *it ) - grammar.GetTerminalOffset() );
-				const auto& cur_rule_desc = grammar.GetRule( it->rule_idx ).desc;
+					expect_charlist.emplace_back( GetNextSymbol( *it ) - GetGrammar().GetTerminalOffset() );
+				const auto& cur_rule_desc = GetGrammar().GetRule( it->rule_idx ).desc;
 				std::span<const int> match_text( GetText().begin() + it->pos, GetText().begin() + ng_pos );
-				auto match_str = grammar.toString( match_text );
+				auto match_str = GetGrammar().toString( match_text );
 				if( match_str.empty() )
-					match_str = grammar.T( "nothing" );
+					match_str = GetGrammar().T( "nothing" );
 				else
-					match_str = grammar.T( "'" ) + match_str + grammar.T( "'" );
+					match_str = GetGrammar().T( "'" ) + match_str + GetGrammar().T( "'" );
 
 				if constexpr( std::same_as<char, StringElemType> )
 					ret.debug_msg.emplace_back( std::format( "Rule {}:{} is {}, matches {} with {} symbols.", it->rule_idx, cur_rule_desc, state_str, match_str, it->offset ) );
@@ -669,7 +1263,7 @@ public:
 			for( int ch : expect_charlist )
 			{
 				int tmp[1] = { ch };
-				expect_strlist.emplace_back( grammar.toString( tmp ) );
+				expect_strlist.emplace_back( GetGrammar().toString( tmp ) );
 			}
 			std::sort( expect_strlist.begin(), expect_strlist.end() );
 
@@ -679,20 +1273,20 @@ public:
 				expect_str += s;
 			ret.expect_rawstr = expect_str;
 			//compress expect_str
-			if( auto pos = expect_str.find( grammar.T( "0123456789" ) ); pos != StringType::npos )
+			if( auto pos = expect_str.find( GetGrammar().T( "0123456789" ) ); pos != StringType::npos )
 			{
 				expect_str.erase( pos, 10 );
-				special_str += grammar.T( "[0-9]" );
+				special_str += GetGrammar().T( "[0-9]" );
 			}
-			if( auto pos = expect_str.find( grammar.T( "abcdefghijklmnopqrstuvwxyz" ) ); pos != StringType::npos )
+			if( auto pos = expect_str.find( GetGrammar().T( "abcdefghijklmnopqrstuvwxyz" ) ); pos != StringType::npos )
 			{
 				expect_str.erase( pos, 26 );
-				special_str += grammar.T( "[a-z]" );
+				special_str += GetGrammar().T( "[a-z]" );
 			}
-			if( auto pos = expect_str.find( grammar.T( "ABCDEFGHIJKLMNOPQRSTUVWXYZ" ) ); pos != StringType::npos )
+			if( auto pos = expect_str.find( GetGrammar().T( "ABCDEFGHIJKLMNOPQRSTUVWXYZ" ) ); pos != StringType::npos )
 			{
 				expect_str.erase( pos, 26 );
-				special_str += grammar.T( "[A-Z]" );
+				special_str += GetGrammar().T( "[A-Z]" );
 			}
 			auto tmp = expect_str;
 			expect_str = special_str;
@@ -722,71 +1316,365 @@ public:
 	}
 
 private:
+	//node chain of each reduction is the same as Earley: A->XY. (left=Y, right=A->X.Y (left=X, right=A->.XY))
+	//every node is in the tree, parent and children are set when reducing
+	bool ParseLALR()
+	{
+		using Table = LALRtable<Grammar>;
+		const auto& lalr = GetLALRtable();
+		auto& stk = m_lr_stack;
+		stk.assign( 1, LRStackEntry{} );
+		auto new_node = [this] ( const int rule_idx, const int pos, const int offset, const int pos_end )
+		{
+			const int x = expressionDAG.size();
+			expressionDAG.emplace_back( FullState( pos_end, State{ rule_idx,pos,offset } ) );
+			return x;
+		};
+		for( int i = 0;; )
+		{
+			const int cls = i < (int)text.size() ? lalr.GetClass( text[i] ) : lalr.GetEndClass();
+			const auto act = lalr.GetAction( stk.back().state, cls );
+			if( Table::isShift( act ) )
+			{
+				stk.push_back( LRStackEntry{ Table::GetShiftState( act ),-1,++i } );
+			}
+			else if( lalr.isAccept( act ) )
+			{
+				root = stk.back().node;
+				break;
+			}
+			else if( Table::isReduce( act ) )
+			{
+				const int rule_idx = Table::GetReduceRule( act );
+				const int len = lalr.GetRuleLength( rule_idx );
+				const size_t base = stk.size() - len - 1;
+				const int pos = stk[base].end;
+				const int top = expressionDAG.size() + len;
+				const int bg = (int)child_list.size();
+				int x = new_node( rule_idx, pos, 0, pos );
+				for( int k = 1; k <= len; ++k )
+				{
+					const auto& sym = stk[base + k];
+					const int y = new_node( rule_idx, pos, k, sym.end );
+					expressionDAG[y].left = sym.node;
+					expressionDAG[y].right = x;
+					if( sym.node >= 0 )
+					{
+						expressionDAG[sym.node].parent = top;
+						child_list.emplace_back( sym.node );
+					}
+					x = y;
+				}
+				child_list.emplace_back( -1 );
+				expressionDAG[x].child = bg;
+				const int end = stk.back().end;
+				stk.resize( base + 1 );
+				stk.push_back( LRStackEntry{ lalr.GetGoto( stk[base].state, lalr.GetRuleDom( rule_idx ) ),x,end } );
+			}
+			else
+				return false;
+		}
+		return true;
+	}
 	bool CalcParent()
 	{
 		const int root = GetRoot();
 		if( root == -1 )
 			return false;
 
-		std::set<int> visit = { root };
-		std::deque<int> q = { root };
-
-		while( !q.empty() )
+		if( expressionDAG[root].child >= 0 )
+			return true;//calculated
+		//child==-2 := in queue
+		child_list.clear();
+		expressionDAG[root].child = -2;
+		m_queue.assign( 1, root );
+		for( size_t k = 0; k < m_queue.size(); ++k )
 		{
-			expressionDAG[q.front()].parent;
-			for( int idx : GetChildList( q.front() ) )
+			const int x = m_queue[k];
+			const int bg = (int)child_list.size();
+			for( int p = x; p != -1; p = expressionDAG[p].GetNextNodeIdx() )
+				if( const int idx = expressionDAG[p].GetChildIdx(); idx >= 0 )
+				{
+					expressionDAG[idx].parent = x;
+					if( expressionDAG[idx].child != -1 )
+						return false;
+					expressionDAG[idx].child = -2;
+					child_list.emplace_back( idx );
+					m_queue.emplace_back( idx );
+				}
+			std::reverse( child_list.begin() + bg, child_list.end() );
+			child_list.emplace_back( -1 );
+			expressionDAG[x].child = bg;
+		}
+		return true;
+	}
+	void NewPhase( const int idx )
+	{
+		if( phase_pool.empty() )
+			dp.emplace_back();
+		else
+		{
+			dp.emplace_back( std::move( phase_pool.back() ) );
+			phase_pool.pop_back();
+		}
+		dp.back().idx = idx;
+	}
+	//node of id=>empty string at dp[idx], -1 := not found yet
+	int FindEmptyNode( const int idx, const int id )const
+	{
+		for( auto& rule : GetGrammar().GetRuleListByDom( id ) )
+			if( auto r = dp[idx].used.find( State{ rule.idx,idx,(int)rule.dest.size() } ); r )
+				return *r;
+		return -1;
+	}
+	void IndexPhase( Phase& p )
+	{
+		p.wait.clear();
+		for( int k = 0; k < (int)p.q.size(); ++k )
+			if( !isComplete( p.q[k] ) && !GetGrammar().isTerminal( GetNextSymbol( p.q[k] ) ) )
+				p.wait.emplace_back( GetNextSymbol( p.q[k] ), k );
+		std::sort( p.wait.begin(), p.wait.end() );
+		//leo item, chain is followed through previous phases only
+		p.leo.clear();
+		for( size_t k = 0; k < p.wait.size(); )
+		{
+			size_t end = k + 1;
+			while( end < p.wait.size() && p.wait[end].first == p.wait[k].first )
+				++end;
+			const auto& e = p.q[p.wait[k].second];
+			const auto& rule = GetGrammar().GetRule( e.rule_idx );
+			if( end == k + 1 && e.offset + 1 == (int)rule.dest.size() )
 			{
-				expressionDAG[idx].parent = q.front();
-				q.emplace_back( idx );
-				if( !visit.insert( idx ).second )
-					return false;
+				const State done{ e.rule_idx,e.pos,e.offset + 1 };
+				auto& it = p.leo.emplace_back( LeoItem{ p.wait[k].first,(int)leo_chain.size(),done } );
+				auto& chain = leo_chain.emplace_back( LeoChain{ done,p.node[p.wait[k].second],-1 } );
+				//S->a. from 0 stays top so that FindRoot sees it in the last phase
+				if( e.pos < p.idx && !( e.pos == 0 && rule.dom == StartNonTerminal ) )
+					if( const int nxt = FindLeoItem( dp[e.pos], rule.dom ); nxt != -1 )
+					{
+						chain.next = dp[e.pos].leo[nxt].chain;
+						it.top = dp[e.pos].leo[nxt].top;
+					}
 			}
-			q.pop_front();
+			k = end;
 		}
-		return true;
 	}
-	int GetNextSymbol( const State s )const
+	//predict and complete
+	void ClosePhase( const int i )
 	{
-		return grammar.GetRule( s.rule_idx ).dest[s.offset];
+		auto& cur_dp = dp[i];
+		for( int j = 0; j < (int)cur_dp.q.size(); ++j )
+		{
+			const auto cur = cur_dp.q[j];
+			const int cur_node = cur_dp.node[j];
+			if( isComplete( cur ) )
+			{
+				const int dom = GetGrammar().GetRule( cur.rule_idx ).dom;
+				if( cur.pos < i )
+				{
+					const auto& from = dp[cur.pos];
+					if( auto leo = FindLeoItem( from, dom ); leo != -1 )
+					{
+						const int x = tryAddState( cur_dp, from.leo[leo].top );
+						expressionDAG[x].left = -2 - (int)leo_link.size();
+						expressionDAG[x].right = -1;
+						leo_link.push_back( LeoLink{ cur_node,from.leo[leo].chain } );
+						continue;
+					}
+					auto range = std::equal_range( from.wait.begin(), from.wait.end(), std::make_pair( dom, 0 ), [] ( auto& l, auto& r )
+					{
+						return l.first < r.first;
+					} );
+					for( auto it = range.first; it != range.second; ++it )
+					{
+						auto tmp = from.q[it->second];
+						++tmp.offset;
+						addLink( tryAddState( cur_dp, tmp ), cur_node, from.node[it->second] );//<new,complete,old>
+					}
+				}
+				else//empty string, items processed later are advanced when predicting
+				{
+					for( int k = wait_head[dom]; k != -1; k = wait_next[k] )
+					{
+						auto tmp = cur_dp.q[k];
+						++tmp.offset;
+						addLink( tryAddState( cur_dp, tmp ), cur_node, cur_dp.node[k] );//<new,complete,old>
+					}
+				}
+			}
+			else
+			{
+				const int id = GetNextSymbol( cur );
+				if( GetGrammar().isTerminal( id ) )
+					continue;//scan after next token is known
+				else
+				{
+					if( predicted_at[id] != i )
+					{
+						predicted_at[id] = i;
+						wait_head[id] = -1;
+						for( auto& e : GetGrammar().GetRuleListByDom( id ) )
+						{
+							State tmp{ .rule_idx = e.idx,.pos = i,.offset = 0 };
+							tryAddState( cur_dp, tmp );
+						}
+					}
+					//Aycock-Horspool, skip nullable symbol, left child is linked here or when the empty one completes
+					if( GetGrammar().isNullable( id ) )
+					{
+						if( (int)wait_next.size() <= j )
+							wait_next.resize( cur_dp.q.size() );
+						wait_next[j] = wait_head[id];
+						wait_head[id] = j;
+						auto tmp = cur;
+						++tmp.offset;
+						addLink( tryAddState( cur_dp, tmp ), FindEmptyNode( i, id ), cur_node );
+					}
+				}
+			}
+		}
+		IndexPhase( cur_dp );
 	}
-	bool isComplete( const State s )const
+	void ScanPhase( const int i )
 	{
-		return grammar.GetRule( s.rule_idx ).dest.size() == s.offset;
+		const int id = text[i] + GetGrammar().GetTerminalOffset();
+		auto& cur_dp = dp[i];
+		auto& nxt_dp = dp[i + 1];
+		for( int j = 0; j < (int)cur_dp.q.size(); ++j )
+		{
+			const auto& cur = cur_dp.q[j];
+			if( !isComplete( cur ) && GetNextSymbol( cur ) == id )
+			{
+				auto tmp = cur;
+				++tmp.offset;
+				addLink( tryAddState( nxt_dp, tmp ), -1, cur_dp.node[j] );//<new,null,old>
+			}
+		}
 	}
-	void tryAddState( Phase& p, const State val )
+	//find root (if more than one possible S, choose any)
+	int FindRoot()const
 	{
-		if( p.used.insert( val ).second )
+		for( auto& rule : GetGrammar().GetRuleListByDom( StartNonTerminal ) )
 		{
-			p.q.emplace_back( val );
-			tryAddExprNode( FullState( p.idx, val ) );
+			State done;
+			done.rule_idx = rule.idx;
+			done.pos = 0;
+			done.offset = static_cast<int>( rule.dest.size() );
+			if( auto r = dp.back().used.find( done ); r )
+				return *r;
 		}
+		return -1;
 	}
-	void tryAddExprNode( const FullState& s )
+	//phase is reachable iff it is the last one or it is the origin of an item in reachable phase
+	void DiscardPhase()
 	{
-		if( auto it = state2idx.insert( std::make_pair( s, -1 ) ); it.second )
+		++m_discard_mark;
+		std::vector<int> live = { (int)dp.size() - 1 };
+		dp.back().mark = m_discard_mark;
+		for( size_t k = 0; k < live.size(); ++k )
+			for( const auto& e : dp[live[k]].q )
+				if( dp[e.pos].mark != m_discard_mark )
+				{
+					assert( dp[e.pos].mark != -1 );
+					dp[e.pos].mark = m_discard_mark;
+					live.emplace_back( e.pos );
+				}
+		auto release = [this] ( const int x )
+		{
+			if( dp[x].mark != m_discard_mark )
+			{
+				Phase tmp;
+				tmp.idx = x;
+				tmp.mark = -1;
+				std::swap( dp[x], tmp );
+			}
+		};
+		for( int x : m_kept_phase )
+			release( x );
+		for( int x = m_kept_phase.empty() ? 0 : m_kept_phase.front() + 1; x + 1 < (int)dp.size(); ++x )
+			release( x );
+		std::sort( live.begin(), live.end(), std::greater<int>() );
+		m_kept_phase.swap( live );
+	}
+	int FindLeoItem( const Phase& p, const int symbol )const
+	{
+		auto it = std::lower_bound( p.leo.begin(), p.leo.end(), symbol, [] ( const LeoItem& l, int r )
+		{
+			return l.symbol < r;
+		} );
+		return ( it != p.leo.end() && it->symbol == symbol ) ? (int)( it - p.leo.begin() ) : -1;
+	}
+	//create the skipped items of leo link in parse tree
+	void CreateLeoNode()
+	{
+		if( root == -1 || leo_link.empty() )
+			return;
+		std::vector<char> visit( expressionDAG.size(), 0 );
+		std::vector<int> stk = { root };
+		while( !stk.empty() )
 		{
-			it.first->second = (int)expressionDAG.size();
-			auto& e = expressionDAG.emplace_back( s );
-			e.idx = it.first->second;
+			const int x = stk.back();
+			stk.pop_back();
+			for( int p = x; p >= 0; p = expressionDAG[p].GetNextNodeIdx() )
+			{
+				if( p >= (int)visit.size() )
+					visit.resize( expressionDAG.size(), 0 );
+				if( visit[p] )
+					break;
+				visit[p] = 1;
+				if( expressionDAG[p].left <= -2 )
+					ResolveLeoLink( p );
+				if( expressionDAG[p].left >= 0 )
+					stk.push_back( expressionDAG[p].left );
+			}
 		}
 	}
-	void addLink( const FullState& head, const std::optional<FullState>& l, const std::optional<FullState>& r )
+	void ResolveLeoLink( const int top_node )
 	{
-		assert( state2idx.find( head ) != state2idx.end() );
-		const int x = state2idx.find( head )->second;
-		auto& e = expressionDAG[x];
-		if( l.has_value() )
+		const LeoLink link = leo_link[-2 - expressionDAG[top_node].left];
+		const int pos_end = expressionDAG[top_node].pos_end;
+		int child = link.complete_node;
+		int c = link.chain;
+		for( ; leo_chain[c].next != -1; c = leo_chain[c].next )
 		{
-			assert( state2idx.find( l.value() ) != state2idx.end() );
-			const int y = state2idx.find( l.value() )->second;
-			e.left = y;
+			//skipped complete item, not in any phase
+			const int x = expressionDAG.size();
+			expressionDAG.emplace_back( FullState( pos_end, leo_chain[c].done ) );
+			addLink( x, child, leo_chain[c].old_node );
+			child = x;
 		}
-		if( r.has_value() )
+		//chain ends with top
+		addLink( top_node, child, leo_chain[c].old_node );
+	}
+	int GetNextSymbol( const State s )const
+	{
+		return GetGrammar().GetRule( s.rule_idx ).dest[s.offset];
+	}
+	bool isComplete( const State s )const
+	{
+		return GetGrammar().GetRule( s.rule_idx ).dest.size() == s.offset;
+	}
+	//return node idx of val
+	int tryAddState( Phase& p, const State val )
+	{
+		auto [x, inserted] = p.used.insert( val, expressionDAG.size() );
+		if( inserted )
 		{
-			assert( state2idx.find( r.value() ) != state2idx.end() );
-			const int y = state2idx.find( r.value() )->second;
-			e.right = y;
+			p.q.emplace_back( val );
+			p.node.emplace_back( x );
+			expressionDAG.emplace_back( FullState( p.idx, val ) );
 		}
+		return x;
+	}
+	//-1 := no link
+	void addLink( const int head, const int l, const int r )
+	{
+		assert( head >= 0 && head < expressionDAG.size() );
+		auto& e = expressionDAG[head];
+		if( l != -1 )
+			e.left = l;
+		if( r != -1 )
+			e.right = r;
 	}
 };
 
@@ -847,7 +1735,7 @@ std::vector<int> toPostorderSequence( const Parser& cfg, const std::set<int>& ta
 			return;
 		}
 
-		auto q = cfg.GetChildList( root );
+		const auto q = cfg.GetChildren( root );
 		switch( g.GetRule( me.rule_idx ).mark )
 		{
 		case UnaryOperatorExpandMark:
@@ -886,6 +1774,36 @@ std::vector<int> toPostorderSequence( const Parser& cfg, const std::set<int>& ta
 	seq.shrink_to_fit();
 	return seq;
 }
+//parse inputs on n_thread workers (0 := #logical core), each worker reuses one parser
+//fn( input idx, const parser& ) is called in the worker right after Parse() and must be thread safe
+//return result of Parse() of each input
+template <grammar_type G, typename Fn>
+std::vector<char> ParseBatch( const std::shared_ptr<const CompiledGrammar<G>>& g, std::span<const std::vector<int>> inputs, Fn&& fn, int n_thread = 0 )
+{
+	if( n_thread <= 0 )
+		n_thread = (int)std::max( 1u, std::thread::hardware_concurrency() );
+	n_thread = std::max( 1, std::min( n_thread, (int)inputs.size() ) );
+	std::vector<char> ret( inputs.size(), 0 );
+	std::atomic<size_t> next = 0;
+	constexpr size_t chunk = 16;
+	auto task = [&] ()->void
+	{
+		CFGparser<G> cfg( g );
+		for( size_t bg; ( bg = next.fetch_add( chunk ) ) < inputs.size(); )
+			for( size_t i = bg; i < std::min( bg + chunk, inputs.size() ); ++i )
+			{
+				ret[i] = cfg.Parse( inputs[i] );
+				fn( i, std::as_const( cfg ) );
+			}
+	};
+	std::vector<std::future<void>> thread_pool;
+	thread_pool.reserve( n_thread );
+	for( int i = 0; i < n_thread; i++ )
+		thread_pool.emplace_back( std::async( std::launch::async, task ) );
+	for( auto& e : thread_pool )
+		e.get();
+	return ret;
+}
 template <cfg_type Parser>
 typename Parser::StringType toPostorderExprString( const Parser& cfg, const std::set<int>& targetNT )
 {
@@ -0,0 +1,262 @@
+#pragma once
+#include "Graph.h"
+#include <span>
+
+namespace Util::GraphTheory
+{
+//Compressed sparse row graph, out edges of node are contiguous (sorted by source, stable)
+//build once with Build() (from graph or edge list), it is not immutable: AddEdge and resize are kept for graph_type
+//but each AddEdge rebuilds the offsets in O(N+E), so do not build it edge by edge
+//inverse edge is another CSR of edge position sorted by destination
+template <node_type _Node = BasicNode, edge_type _Edge = BasicEdge, bool HasInverse = true>
+class CSRGraph
+{
+public:
+	using Node = _Node;
+	using Edge = _Edge;
+	using is_sparse_graph		= std::true_type;
+	using is_discrete_idx		= std::false_type;
+	using is_node_addable		= std::false_type;
+	using is_node_erasable		= std::false_type;
+	using is_edge_erasable		= std::false_type;
+	using is_edge_duplicatable	= std::true_type;
+	using has_inverse_edge		= std::bool_constant<HasInverse>;
+
+protected:
+	std::vector<Node> m_nodeList;
+	std::vector<Edge> m_edgeList;//sorted by source
+	std::vector<int> m_offset;//out edges of node i := m_edgeList[m_offset[i],m_offset[i+1])
+	std::vector<int> m_destination;//destination of m_edgeList[i]
+	std::vector<int> m_inverse_offset;//in edges of node i := m_inverse_edge[m_inverse_offset[i],m_inverse_offset[i+1])
+	std::vector<int> m_inverse_edge;//position in m_edgeList
+	std::vector<int> m_inverse_pos;//position in m_edgeList->position in m_inverse_edge
+
+public:
+	using iterator_node = typename decltype( m_nodeList )::iterator;
+	using iterator_edge = typename decltype( m_edgeList )::iterator;
+	using const_iterator_node = typename decltype( m_nodeList )::const_iterator;
+	using const_iterator_edge = typename decltype( m_edgeList )::const_iterator;
+
+	CSRGraph()
+	{
+		m_offset = { 0 };
+		m_inverse_offset = { 0 };
+	}
+	//node idx of g must be 0,1,2,...
+	template <graph_type Graph>
+	requires ( !_Is_discrete_idx<Graph> )
+	explicit CSRGraph( const Graph& g ) :CSRGraph()
+	{
+		Build( g );
+	}
+	~CSRGraph(){}
+	//Common
+
+	iterator_node begin_node()				{		return m_nodeList.begin();	}
+	iterator_node end_node()				{		return m_nodeList.end();	}
+	const_iterator_node begin_node()const	{		return m_nodeList.begin();	}
+	const_iterator_node end_node()const		{		return m_nodeList.end();	}
+	iterator_edge begin_edge()				{		return m_edgeList.begin();	}
+	iterator_edge end_edge()				{		return m_edgeList.end();	}
+	const_iterator_edge begin_edge()const	{		return m_edgeList.begin();	}
+	const_iterator_edge end_edge()const		{		return m_edgeList.end();	}
+
+	//O(N+E), reference is valid until next AddEdge
+	Edge& AddEdge( int st_idx, int ed_idx )
+	{
+		assert( HasNode( st_idx ) );
+		assert( HasNode( ed_idx ) );
+		const int pos = m_offset[st_idx + 1];
+		Edge e;
+		_Reset_idx( e, (int)m_edgeList.size() );
+		_Reset_source( e, st_idx );
+		_Reset_destination( e, ed_idx );
+		m_edgeList.insert( m_edgeList.begin() + pos, e );
+		m_destination.insert( m_destination.begin() + pos, ed_idx );
+		for( int i = st_idx + 1; i < (int)m_offset.size(); ++i )
+			++m_offset[i];
+		BuildInverse();
+		return m_edgeList[pos];
+	}
+	Edge* GetNextEdge( const Edge& e )	{		return const_cast<Edge*>( const_cast<const CSRGraph*>( this )->GetNextEdge( e ) );	}
+	Node* GetNode( int idx )			{		return const_cast<Node*>( const_cast<const CSRGraph*>( this )->GetNode( idx ) );	}
+	Edge* GetNextEdge( const Node& p )	{		return const_cast<Edge*>( const_cast<const CSRGraph*>( this )->GetNextEdge( p ) );	}
+
+	bool HasNode( int idx )const		{		return idx >= 0 && idx < (int)m_nodeList.size();	}
+	const Node* GetNode( int idx )const	{		return &m_nodeList[idx];	}
+	const Edge* GetNextEdge( const Node& p )const
+	{
+		const int pos = m_offset[p.GetIdx()];
+		return pos == m_offset[p.GetIdx() + 1] ? nullptr : &m_edgeList[pos];
+	}
+	const Edge* GetNextEdge( const Edge& e )const
+	{
+		const int pos = int( &e - m_edgeList.data() ) + 1;
+		return pos == m_offset[e.GetSource() + 1] ? nullptr : &m_edgeList[pos];
+	}
+	size_t CountOutDegree( const Node& p )const	{		return m_offset[p.GetIdx() + 1] - m_offset[p.GetIdx()];	}
+
+	size_t size_node()const	{		return m_nodeList.size();	}
+	size_t size_edge()const	{		return m_edgeList.size();	}
+
+	void clear()
+	{
+		m_nodeList.clear();
+		m_edgeList.clear();
+		m_offset = { 0 };
+		m_destination.clear();
+		m_inverse_offset = { 0 };
+		m_inverse_edge.clear();
+		m_inverse_pos.clear();
+	}
+	void reserve( size_t n, size_t m )
+	{
+		m_nodeList.reserve( n );
+		m_offset.reserve( n + 1 );
+		m_edgeList.reserve( m );
+		m_destination.reserve( m );
+		if constexpr( HasInverse )
+		{
+			m_inverse_offset.reserve( n + 1 );
+			m_inverse_edge.reserve( m );
+			m_inverse_pos.reserve( m );
+		}
+	}
+	//edges to removed nodes are not allowed
+	void resize( size_t n )
+	{
+		const int old = (int)m_nodeList.size();
+		m_nodeList.resize( n );
+		for( int idx = old; idx < (int)n; ++idx )
+			_Reset_idx( m_nodeList[idx], idx );
+		m_offset.resize( n + 1, m_offset.back() );
+		if constexpr( HasInverse )
+			m_inverse_offset.resize( n + 1, m_inverse_offset.back() );
+	}
+
+	//inverse edge
+
+	Edge* GetNextInverseEdge( const Node& p )requires HasInverse	{		return const_cast<Edge*>( const_cast<const CSRGraph*>( this )->GetNextInverseEdge( p ) );	}
+	Edge* GetNextInverseEdge( const Edge& e )requires HasInverse	{		return const_cast<Edge*>( const_cast<const CSRGraph*>( this )->GetNextInverseEdge( e ) );	}
+	const Edge* GetNextInverseEdge( const Node& p )const requires HasInverse
+	{
+		const int k = m_inverse_offset[p.GetIdx()];
+		return k == m_inverse_offset[p.GetIdx() + 1] ? nullptr : &m_edgeList[m_inverse_edge[k]];
+	}
+	const Edge* GetNextInverseEdge( const Edge& e )const requires HasInverse
+	{
+		const int k = m_inverse_pos[&e - m_edgeList.data()] + 1;
+		return k == m_inverse_offset[e.GetDestination() + 1] ? nullptr : &m_edgeList[m_inverse_edge[k]];
+	}
+	size_t CountInDegree( const Node& p )const requires HasInverse	{		return m_inverse_offset[p.GetIdx() + 1] - m_inverse_offset[p.GetIdx()];	}
+
+	//CSR
+
+	//copy nodes and edges of g, node idx of g must be 0,1,2,...
+	template <graph_type Graph>
+	requires ( !_Is_discrete_idx<Graph> )
+	void Build( const Graph& g )
+	{
+		clear();
+		resize( g.size_node() );
+		for( auto p = g.begin_node(); p != g.end_node(); ++p )
+		{
+			m_nodeList[p->GetIdx()] = static_cast<const Node&>( *p );
+			assert( m_nodeList[p->GetIdx()].GetIdx() == p->GetIdx() );
+		}
+		//counting sort by source
+		for( auto e = g.begin_edge(); e != g.end_edge(); ++e )
+			++m_offset[e->GetSource() + 1];
+		for( size_t i = 1; i < m_offset.size(); ++i )
+			m_offset[i] += m_offset[i - 1];
+		m_edgeList.resize( m_offset.back() );
+		m_destination.resize( m_offset.back() );
+		std::vector<int> cur( m_offset.begin(), m_offset.end() - 1 );
+		for( auto e = g.begin_edge(); e != g.end_edge(); ++e )
+		{
+			const int pos = cur[e->GetSource()]++;
+			m_edgeList[pos] = static_cast<const Edge&>( *e );
+			m_destination[pos] = e->GetDestination();
+		}
+		BuildInverse();
+	}
+	//n nodes, edge i is edge_list[i]=<source,destination> with weight[i] (if not empty)
+	void Build( size_t n, std::span<const std::pair<int, int>> edge_list )
+	{
+		Build( n, edge_list, std::span<const int>() );
+	}
+	template <typename W>
+	void Build( size_t n, std::span<const std::pair<int, int>> edge_list, std::span<const W> weight )
+	{
+		assert( weight.empty() || weight.size() == edge_list.size() );
+		clear();
+		resize( n );
+		for( auto [s, t] : edge_list )
+		{
+			assert( HasNode( s ) && HasNode( t ) );
+			++m_offset[s + 1];
+		}
+		for( size_t i = 1; i < m_offset.size(); ++i )
+			m_offset[i] += m_offset[i - 1];
+		m_edgeList.resize( edge_list.size() );
+		m_destination.resize( edge_list.size() );
+		std::vector<int> cur( m_offset.begin(), m_offset.end() - 1 );
+		for( int i = 0; i < (int)edge_list.size(); ++i )
+		{
+			auto [s, t] = edge_list[i];
+			const int pos = cur[s]++;
+			auto& e = m_edgeList[pos];
+			_Reset_idx( e, i );
+			_Reset_source( e, s );
+			_Reset_destination( e, t );
+			if constexpr( weighted_edge_type<Edge> )
+				if( !weight.empty() )
+					e.GetWeight() = static_cast<typename Edge::weight_type>( weight[i] );
+			m_destination[pos] = t;
+		}
+		BuildInverse();
+	}
+
+	//destinations of out edges of node idx, same order as GetNextEdge
+	std::span<const int> GetOutNeighbor( int idx )const
+	{
+		return std::span<const int>( m_destination.data() + m_offset[idx], m_destination.data() + m_offset[idx + 1] );
+	}
+	//out edges of node idx
+	std::span<const Edge> GetOutEdge( int idx )const
+	{
+		return std::span<const Edge>( m_edgeList.data() + m_offset[idx], m_edgeList.data() + m_offset[idx + 1] );
+	}
+	std::span<Edge> GetOutEdge( int idx )
+	{
+		return std::span<Edge>( m_edgeList.data() + m_offset[idx], m_edgeList.data() + m_offset[idx + 1] );
+	}
+	//position of edge in out edge array (not edge idx)
+	int GetEdgePos( const Edge& e )const	{		return int( &e - m_edgeList.data() );	}
+
+private:
+	void BuildInverse()
+	{
+		if constexpr( HasInverse )
+		{
+			const int n = (int)m_nodeList.size();
+			m_inverse_offset.assign( n + 1, 0 );
+			for( int t : m_destination )
+				++m_inverse_offset[t + 1];
+			for( int i = 1; i <= n; ++i )
+				m_inverse_offset[i] += m_inverse_offset[i - 1];
+			m_inverse_edge.resize( m_destination.size() );
+			m_inverse_pos.resize( m_destination.size() );
+			std::vector<int> cur( m_inverse_offset.begin(), m_inverse_offset.end() - 1 );
+			for( int pos = 0; pos < (int)m_destination.size(); ++pos )
+			{
+				const int k = cur[m_destination[pos]]++;
+				m_inverse_edge[k] = pos;
+				m_inverse_pos[pos] = k;
+			}
+		}
+	}
+};
+static_assert( graph_type<CSRGraph<BasicNode, BasicEdge>> );
+static_assert( graph_type<CSRGraph<BasicNode, BasicEdge, false>> );
+}
\ No newline at end of file
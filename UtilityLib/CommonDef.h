@@ -12,6 +12,7 @@
 #include <string>
 #include <sstream>
 #include "low_fragmentation_allocator.h"
+#include "Random.h"
 
 #define FOR(i,a,b) for(int i=(a); (i)<(b); (i)++)
 //#define FOR(i,a,b,step) for(int i=(a); (i)<(b); (i)+=(step))
@@ -85,4 +86,6 @@ typedef std::random_device NRNG;
 //Pseudorandom number generator
 typedef std::mt19937 RNG;
 typedef std::mt19937_64 RNG64;
+//Counter-based pseudorandom number generator, cheap to copy and splittable by SplitRNG(...)
+typedef Philox4x32 CRNG;
 }
@@ -183,16 +183,17 @@ protected:
 		using reference			= std::conditional_t<is_const_iterator, const Edge&, Edge&>;
 
 	protected:
+		using matrix_reference	= std::conditional_t<is_const_iterator, const _Graph_matrix&, _Graph_matrix&>;
 		int s = 0;
 		int t = 0;
-		_Graph_matrix& ref;
+		matrix_reference ref;
 		
-		_Iterator_edge( _Graph_matrix& mat ) : ref( mat )
+		_Iterator_edge( matrix_reference mat ) : ref( mat )
 		{
 			if( !ref.empty() && !ref.front().empty() && ref.front().front().GetIdx() <= 0 )
 				operator++();
 		}
-		_Iterator_edge( int s, int t, _Graph_matrix& mat ) : ref( mat ), s( s ), t( t )
+		_Iterator_edge( int s, int t, matrix_reference mat ) : ref( mat ), s( s ), t( t )
 		{
 			if( s < (int)ref.size() && ref[s][t].GetIdx() <= 0 )
 				operator++();
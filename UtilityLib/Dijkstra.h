@@ -1,12 +1,21 @@
 #pragma once
 #include "Graph.h"
 #include "dynamic_priority_queue.h"
+#include "monotone_priority_queue.h"
 #include "VecUtil.h"
+#include "Matrix.h"
+#include <barrier>
+#include <future>
+#include <atomic>
+#include <span>
 
 namespace Util::GraphTheory
 {
 // **Important** Dijkstra only works on *positive* weight 
 
+template <graph_type Graph>
+class PointToPointDijkstra;
+
 //Result Info
 template <graph_type Graph>
 requires weighted_edge_type<typename Graph::Edge>
@@ -20,44 +29,52 @@ protected:
 	bool visited = false;//for Dijkstra
 public:
 	friend std::vector<DistanceInfo_Dijkstra<Graph>> Dijkstra<Graph>( const Graph&, int, const GraphNodeIdx2List<Graph>& );
+	friend class PointToPointDijkstra<Graph>;
+	template <typename Queue, graph_type G>
+	friend std::vector<DistanceInfo_Dijkstra<G>> Dijkstra( const G&, int, const GraphNodeIdx2List<G>&, Queue&& );
+	template <graph_type G>
+	friend std::vector<DistanceInfo_Dijkstra<G>> DeltaStepping( const G&, int, typename G::Edge::weight_type, int );
 
 	DistanceInfo_Dijkstra()	{}
 	const weight_type& GetDistance()const noexcept	{		return dis;	}
 	bool isReachable()const noexcept				{		return reachable;	}
 };
 
-//Sparse Graph (heap) O((N+E)*log(N))
-template <graph_type Graph>
-requires weighted_edge_type<typename Graph::Edge>&& _Is_sparse_graph<Graph>
-std::vector<DistanceInfo_Dijkstra<Graph>> Dijkstra( const Graph& g, int start_idx, const GraphNodeIdx2List<Graph>& node_idx2idx )
+//Sparse Graph with given min priority queue, O((N+E)*log(N)) for binary heap
+//queue interface is same as dynamic_priority_queue (resize,push,update_priority,top,pop,empty)
+template <typename Queue, graph_type Graph>
+std::vector<DistanceInfo_Dijkstra<Graph>> Dijkstra( const Graph& g, int start_idx, const GraphNodeIdx2List<Graph>& node_idx2idx, Queue&& heap )
 {
+	static_assert( weighted_edge_type<typename Graph::Edge> && _Is_sparse_graph<Graph> );
 	using weight_type = typename Graph::Edge::weight_type;
 	std::vector<DistanceInfo_Dijkstra<Graph>> dis_vector;
 	const int n = (int)g.size_node();
 	dis_vector.resize( n );
 
 	dis_vector[node_idx2idx[start_idx]].reachable = true;
-	dynamic_priority_queue<weight_type, std::greater<>> heap;//smallest top
 	heap.resize( n );
 	int heap_st_idx = node_idx2idx[start_idx];
 	heap.push( heap_st_idx, weight_type() );
 	
 	while( !heap.empty() )
 	{
-		const int node_idx = node_idx2idx.GetNodeIdx( heap.top().idx );
+		const int cur_idx = heap.top().idx;
+		const weight_type cur_dis = heap.top().key;
+		heap.pop();
+		const int node_idx = node_idx2idx.GetNodeIdx( cur_idx );
 		auto st = g.GetNode( node_idx );
 		assert( st );
 		assert( st->valid() );
-		dis_vector[st->GetIdx()].visited = true;
+		dis_vector[cur_idx].visited = true;
 		for( auto e = g.GetNextEdge( *st ); e; e = g.GetNextEdge( *e ) )
 		{
 			assert( e->GetSource() == st->GetIdx() );
 			assert( e->valid() );
-			auto& dest = dis_vector[e->GetDestination()];
-			if( !dest.visited && ( !dest.reachable || heap.top().key + e->GetWeight() < dest.dis ) )
+			const int idx = node_idx2idx[e->GetDestination()];
+			auto& dest = dis_vector[idx];
+			if( !dest.visited && ( !dest.reachable || cur_dis + e->GetWeight() < dest.dis ) )
 			{
-				dest.dis = heap.top().key + e->GetWeight();
-				const int idx = node_idx2idx[e->GetDestination()];
+				dest.dis = cur_dis + e->GetWeight();
 				if( dest.reachable )
 				{
 					assert( heap.exists( idx ) );
@@ -71,10 +88,284 @@ std::vector<DistanceInfo_Dijkstra<Graph>> Dijkstra( const Graph& g, int start_id
 				}
 			}
 		}
-		heap.pop();
 	}
 	return dis_vector;
 }
+//Sparse Graph, radix heap for unsigned integral weight, otherwise binary heap
+template <graph_type Graph>
+requires weighted_edge_type<typename Graph::Edge>&& _Is_sparse_graph<Graph>
+std::vector<DistanceInfo_Dijkstra<Graph>> Dijkstra( const Graph& g, int start_idx, const GraphNodeIdx2List<Graph>& node_idx2idx )
+{
+	using weight_type = typename Graph::Edge::weight_type;
+	if constexpr( std::unsigned_integral<weight_type> )
+		return Dijkstra( g, start_idx, node_idx2idx, radix_heap<weight_type>() );
+	else
+		return Dijkstra( g, start_idx, node_idx2idx, dynamic_priority_queue<weight_type, std::greater<>>() );//smallest top
+}
+//Sparse Graph with integral weight in [0,max_weight], Dial's buckets O(N*max_weight+E)
+template <graph_type Graph>
+requires weighted_edge_type<typename Graph::Edge>&& _Is_sparse_graph<Graph>&& std::integral<typename Graph::Edge::weight_type>
+std::vector<DistanceInfo_Dijkstra<Graph>> DijkstraWithMaxWeight( const Graph& g, int start_idx, typename Graph::Edge::weight_type max_weight )
+{
+	GraphNodeIdx2List<Graph> node_idx2idx( g );
+	return Dijkstra( g, start_idx, node_idx2idx, bucket_queue<typename Graph::Edge::weight_type>( max_weight ) );
+}
+//Sparse Graph, parallel delta-stepping
+//node in bucket i has distance in [i*delta,(i+1)*delta), bucket is settled by relaxing light edges (weight<=delta) until stable, then heavy edges once
+//node is owned by thread (list idx % n_thread), only owner writes its distance, so there is no atomic on distance
+//small delta -> close to Dijkstra (more rounds), large delta -> close to Bellman-Ford (more relaxations), delta ~ max weight / average degree is a good start
+//n_thread = 0 means all logical cores
+template <graph_type Graph>
+std::vector<DistanceInfo_Dijkstra<Graph>> DeltaStepping( const Graph& g, int start_idx, typename Graph::Edge::weight_type delta, int n_thread )
+{
+	static_assert( weighted_edge_type<typename Graph::Edge> && _Is_sparse_graph<Graph> );
+	using weight_type = typename Graph::Edge::weight_type;
+	static_assert( std::is_arithmetic_v<weight_type> );
+	assert( delta > weight_type() );
+	GraphNodeIdx2List<Graph> node_idx2idx( g );
+	const int n = (int)g.size_node();
+	std::vector<DistanceInfo_Dijkstra<Graph>> dis_vector( n );
+	if( n_thread <= 0 )
+		n_thread = std::max( 1, GetLogicalCoreCount() );
+	n_thread = std::max( 1, std::min( n_thread, n ) );
+
+	weight_type max_weight = weight_type();
+	for( auto e = g.begin_edge(); e != g.end_edge(); ++e )
+		max_weight = std::max( max_weight, e->GetWeight() );
+	//circular buckets, live buckets are within [cur,cur+n_bucket)
+	const size_t n_bucket = size_t( max_weight / delta ) + 2;
+	auto GetBucket = [delta] ( const weight_type& d )->size_t	{		return size_t( d / delta );	};
+
+	struct Local
+	{
+		std::vector<std::vector<int>> bucket;
+		std::vector<int> frontier;
+		std::vector<int> settled;//nodes in current bucket, heavy edges are relaxed once at last
+		std::vector<std::vector<std::pair<int, weight_type>>> request;//request[owner]
+		size_t min_bucket = 0;
+	};
+	std::vector<Local> local( n_thread );
+	for( auto& e : local )
+	{
+		e.bucket.resize( n_bucket );
+		e.request.resize( n_thread );
+	}
+	std::vector<int> stamp( n, -1 );
+
+	enum struct tPhase
+	{
+		kCollect,//owner moves current bucket to frontier
+		kLight,//relax light edges of frontier
+		kHeavy,//relax heavy edges of settled
+		kApply,//owner applies requests
+		kNext,//owner finds its smallest bucket
+	};
+	tPhase phase = tPhase::kCollect;
+	bool is_heavy = false;
+	bool stop = false;
+	size_t cur = 0;
+	int round = 0;
+	constexpr size_t kNone = std::numeric_limits<size_t>::max();
+
+	const int st = node_idx2idx[start_idx];
+	dis_vector[st].reachable = true;
+	local[st % n_thread].bucket[0].emplace_back( st );
+
+	std::barrier guard( n_thread, [&] ()noexcept
+	{
+		switch( phase )
+		{
+		case tPhase::kCollect:
+			++round;
+			phase = std::ranges::all_of( local, [] ( const Local& e ) { return e.frontier.empty(); } ) ? tPhase::kHeavy : tPhase::kLight;
+			is_heavy = phase == tPhase::kHeavy;
+			break;
+		case tPhase::kLight:
+		case tPhase::kHeavy:
+			phase = tPhase::kApply;
+			break;
+		case tPhase::kApply:
+			phase = is_heavy ? tPhase::kNext : tPhase::kCollect;
+			break;
+		case tPhase::kNext:
+			cur = std::ranges::min( local, {}, &Local::min_bucket ).min_bucket;
+			stop = cur == kNone;
+			phase = tPhase::kCollect;
+			break;
+		}
+	} );
+	auto relax = [&] ( Local& self, const std::vector<int>& list, const bool heavy )
+	{
+		for( int u : list )
+		{
+			auto p = g.GetNode( node_idx2idx.GetNodeIdx( u ) );
+			assert( p && p->valid() );
+			const weight_type du = dis_vector[u].dis;
+			for( auto e = g.GetNextEdge( *p ); e; e = g.GetNextEdge( *e ) )
+				if( ( e->GetWeight() > delta ) == heavy )
+				{
+					const int v = node_idx2idx[e->GetDestination()];
+					self.request[v % n_thread].emplace_back( v, du + e->GetWeight() );
+				}
+		}
+	};
+	auto task = [&] ( const int thread_idx )->void
+	{
+		Local& self = local[thread_idx];
+		while( !stop )
+		{
+			switch( phase )
+			{
+			case tPhase::kCollect:
+			{
+				self.frontier.clear();
+				auto& b = self.bucket[cur % n_bucket];
+				for( int v : b )
+				{
+					auto& info = dis_vector[v];
+					if( info.reachable && stamp[v] != round && GetBucket( info.dis ) == cur )
+					{
+						stamp[v] = round;
+						self.frontier.emplace_back( v );
+						if( !info.visited )
+						{
+							info.visited = true;
+							self.settled.emplace_back( v );
+						}
+					}
+				}
+				b.clear();
+				break;
+			}
+			case tPhase::kLight:
+				relax( self, self.frontier, false );
+				break;
+			case tPhase::kHeavy:
+				relax( self, self.settled, true );
+				self.settled.clear();
+				break;
+			case tPhase::kApply:
+				for( auto& other : local )
+				{
+					for( auto [v, d] : other.request[thread_idx] )
+					{
+						auto& info = dis_vector[v];
+						if( !info.reachable || d < info.dis )
+						{
+							info.dis = d;
+							info.reachable = true;
+							self.bucket[GetBucket( d ) % n_bucket].emplace_back( v );
+						}
+					}
+					other.request[thread_idx].clear();
+				}
+				break;
+			case tPhase::kNext:
+				self.min_bucket = kNone;
+				for( size_t i = cur; i < cur + n_bucket; ++i )
+				{
+					auto& b = self.bucket[i % n_bucket];
+					std::erase_if( b, [&] ( int v ) { return GetBucket( dis_vector[v].dis ) != i; } );
+					if( !b.empty() )
+					{
+						self.min_bucket = i;
+						break;
+					}
+				}
+				break;
+			}
+			guard.arrive_and_wait();
+		}
+	};
+
+	std::vector<std::future<void>> thread_pool;
+	thread_pool.reserve( n_thread );
+	for( int i = 0; i < n_thread; i++ )
+		thread_pool.emplace_back( std::async( std::launch::async, task, i ) );
+	for( auto& e : thread_pool )
+		e.wait();
+	return dis_vector;
+}
+//Sparse Graph, distance from many sources in parallel
+//dis[i][j] := distance from sources[i] to node j (list idx), inf if unreachable, dis is resized to |sources|*N if needed
+//each thread keeps its own queue and node state, reset by touched nodes only
+//n_thread = 0 means all logical cores
+template <graph_type Graph>
+requires weighted_edge_type<typename Graph::Edge>&& _Is_sparse_graph<Graph>
+void MultiSourceDijkstra( const Graph& g, std::span<const int> sources, Matrix<typename Graph::Edge::weight_type>& dis,
+						  const typename Graph::Edge::weight_type inf = std::numeric_limits<typename Graph::Edge::weight_type>::max(), int n_thread = 0 )
+{
+	using weight_type = typename Graph::Edge::weight_type;
+	using Queue = std::conditional_t<std::unsigned_integral<weight_type>, radix_heap<weight_type>, dynamic_priority_queue<weight_type, std::greater<>>>;
+	GraphNodeIdx2List<Graph> node_idx2idx( g );
+	const int n = (int)g.size_node();
+	if( dis.size() != std::make_pair( sources.size(), (size_t)n ) )
+		dis.resize( sources.size(), n );
+	if( n_thread <= 0 )
+		n_thread = std::max( 1, GetLogicalCoreCount() );
+	n_thread = std::max( 1, std::min( n_thread, (int)sources.size() ) );
+
+	enum tState :char
+	{
+		kNone,
+		kQueue,
+		kVisited,
+	};
+	std::atomic<size_t> next = 0;
+	auto task = [&] ()->void
+	{
+		Queue heap;
+		heap.resize( n );
+		std::vector<char> state( n, kNone );
+		std::vector<int> touched;
+		for( size_t i; ( i = next++ ) < sources.size(); )
+		{
+			for( int idx : touched )
+				state[idx] = kNone;
+			touched.clear();
+			heap.clear();
+			auto& row = dis[(int)i];
+			std::fill( row.begin(), row.end(), inf );
+			const int st = node_idx2idx[sources[i]];
+			row[st] = weight_type();
+			state[st] = kQueue;
+			touched.emplace_back( st );
+			heap.push( st, weight_type() );
+			while( !heap.empty() )
+			{
+				const int cur = heap.top().idx;
+				const weight_type cur_dis = heap.top().key;
+				heap.pop();
+				state[cur] = kVisited;
+				auto p = g.GetNode( node_idx2idx.GetNodeIdx( cur ) );
+				assert( p && p->valid() );
+				for( auto e = g.GetNextEdge( *p ); e; e = g.GetNextEdge( *e ) )
+				{
+					const int t = node_idx2idx[e->GetDestination()];
+					const weight_type d = cur_dis + e->GetWeight();
+					if( state[t] == kNone )
+					{
+						state[t] = kQueue;
+						touched.emplace_back( t );
+						row[t] = d;
+						heap.push( t, d );
+					}
+					else if( state[t] == kQueue && d < row[t] )
+					{
+						row[t] = d;
+						heap.update_priority( t, d );
+					}
+				}
+			}
+		}
+	};
+	std::vector<std::future<void>> thread_pool;
+	thread_pool.reserve( n_thread );
+	for( int i = 0; i < n_thread; i++ )
+		thread_pool.emplace_back( std::async( std::launch::async, task ) );
+	for( auto& e : thread_pool )
+		e.get();
+}
 
 //Dense Graph (brute) O(N^2)
 template <graph_type Graph>
@@ -121,13 +412,215 @@ std::vector<DistanceInfo_Dijkstra<Graph>> Dijkstra( const Graph& g, int start_id
 	}
 	return dis_vector;
 }
-//Distance from start to end
+
+//Point to point query on sparse graph, stop as soon as end is settled
+//reusable for many queries on the same graph, only touched nodes are reset between queries
+template <graph_type Graph>
+class PointToPointDijkstra
+{
+	static_assert( weighted_edge_type<typename Graph::Edge> && _Is_sparse_graph<Graph> );
+public:
+	using weight_type = typename Graph::Edge::weight_type;
+	using Info = DistanceInfo_Dijkstra<Graph>;
+protected:
+	using Heap = dynamic_priority_queue<weight_type, std::greater<>>;//smallest top
+
+	const Graph& g;
+	GraphNodeIdx2List<Graph> node_idx2idx;
+	std::vector<Info> forward;
+	std::vector<Info> backward;
+	std::vector<int> touched;//list idx touched by last query
+	Heap heap_forward;
+	Heap heap_backward;
+	int n_visited = 0;
+
+public:
+	//graph must not be changed during lifetime
+	explicit PointToPointDijkstra( const Graph& g ) :g( g ), node_idx2idx( g )
+	{
+		const int n = (int)g.size_node();
+		forward.resize( n );
+		heap_forward.resize( n );
+		if constexpr( _Has_inverse_edge<Graph> )
+		{
+			backward.resize( n );
+			heap_backward.resize( n );
+		}
+	}
+	//number of settled nodes in last query
+	int GetVisitedCount()const noexcept	{		return n_visited;	}
+
+	Info Dijkstra( int start_idx, int end_idx )
+	{
+		return AStar( start_idx, end_idx, [] ( int ) { return weight_type(); } );
+	}
+	//heuristic(node_idx) is lower bound of distance from node to end
+	//must be consistent, heuristic(u)<=w(u,v)+heuristic(v), otherwise result is not optimal
+	template <typename Heuristic>
+	requires std::is_invocable_r_v<weight_type, Heuristic, int>
+	Info AStar( int start_idx, int end_idx, Heuristic&& heuristic )
+	{
+		Reset();
+		const int st = node_idx2idx[start_idx];
+		const int ed = node_idx2idx[end_idx];
+		Touch( st );
+		forward[st].reachable = true;
+		heap_forward.push( st, heuristic( start_idx ) );
+		while( !heap_forward.empty() )
+		{
+			const int cur = heap_forward.top().idx;
+			heap_forward.pop();
+			forward[cur].visited = true;
+			++n_visited;
+			if( cur == ed )
+				return forward[cur];
+			auto p = g.GetNode( node_idx2idx.GetNodeIdx( cur ) );
+			assert( p && p->valid() );
+			for( auto e = g.GetNextEdge( *p ); e; e = g.GetNextEdge( *e ) )
+			{
+				assert( e->valid() );
+				const int t = node_idx2idx[e->GetDestination()];
+				auto& dest = forward[t];
+				const weight_type d = forward[cur].dis + e->GetWeight();
+				if( dest.visited || ( dest.reachable && !( d < dest.dis ) ) )
+					continue;
+				dest.dis = d;
+				if( dest.reachable )
+					heap_forward.update_priority( t, d + heuristic( e->GetDestination() ) );
+				else
+				{
+					Touch( t );
+					dest.reachable = true;
+					heap_forward.push( t, d + heuristic( e->GetDestination() ) );
+				}
+			}
+		}
+		return Info();
+	}
+	//search from start on edges and from end on inverse edges alternately
+	//stop when top of both heap can not improve the best path
+	Info Bidirectional( int start_idx, int end_idx )requires _Has_inverse_edge<Graph>
+	{
+		Reset();
+		const int st = node_idx2idx[start_idx];
+		const int ed = node_idx2idx[end_idx];
+		Info best;
+		Touch( st );
+		Touch( ed );
+		forward[st].reachable = true;
+		backward[ed].reachable = true;
+		heap_forward.push( st, weight_type() );
+		heap_backward.push( ed, weight_type() );
+		if( st == ed )
+		{
+			best.reachable = true;
+			return best;
+		}
+		while( !heap_forward.empty() && !heap_backward.empty() )
+		{
+			if( best.reachable && !( heap_forward.top().key + heap_backward.top().key < best.dis ) )
+				break;
+			if( heap_forward.size() <= heap_backward.size() )
+				Expand<false>( best );
+			else
+				Expand<true>( best );
+		}
+		return best;
+	}
+
+protected:
+	void Reset()
+	{
+		for( int i : touched )
+		{
+			forward[i] = Info();
+			if constexpr( _Has_inverse_edge<Graph> )
+				backward[i] = Info();
+		}
+		touched.clear();
+		heap_forward.clear();
+		if constexpr( _Has_inverse_edge<Graph> )
+			heap_backward.clear();
+		n_visited = 0;
+	}
+	void Touch( int idx )
+	{
+		if( !forward[idx].reachable && ( backward.empty() || !backward[idx].reachable ) )
+			touched.emplace_back( idx );
+	}
+	template <bool IsBackward, typename T>
+	auto GetNextEdge( const T& val )const
+	{
+		if constexpr( IsBackward )
+			return g.GetNextInverseEdge( val );
+		else
+			return g.GetNextEdge( val );
+	}
+	//settle one node of forward (or backward) search, update best path through relaxed edge
+	template <bool IsBackward>
+	void Expand( Info& best )
+	{
+		auto& heap = IsBackward ? heap_backward : heap_forward;
+		auto& info = IsBackward ? backward : forward;
+		auto& other = IsBackward ? forward : backward;
+		const int cur = heap.top().idx;
+		heap.pop();
+		info[cur].visited = true;
+		++n_visited;
+		auto p = g.GetNode( node_idx2idx.GetNodeIdx( cur ) );
+		assert( p && p->valid() );
+		for( auto e = GetNextEdge<IsBackward>( *p ); e; e = GetNextEdge<IsBackward>( *e ) )
+		{
+			assert( e->valid() );
+			const int t = node_idx2idx[IsBackward ? e->GetSource() : e->GetDestination()];
+			auto& dest = info[t];
+			const weight_type d = info[cur].dis + e->GetWeight();
+			if( other[t].reachable && ( !best.reachable || d + other[t].dis < best.dis ) )
+			{
+				best.dis = d + other[t].dis;
+				best.reachable = true;
+			}
+			if( dest.visited || ( dest.reachable && !( d < dest.dis ) ) )
+				continue;
+			dest.dis = d;
+			if( dest.reachable )
+				heap.update_priority( t, d );
+			else
+			{
+				Touch( t );
+				dest.reachable = true;
+				heap.push( t, d );
+			}
+		}
+	}
+};
+
+//Distance from start to end, sparse graph stops as soon as end is settled
 template <graph_type Graph>
 requires weighted_edge_type<typename Graph::Edge>
 DistanceInfo_Dijkstra<Graph> Dijkstra( const Graph& g, int start_idx, int end_idx )
 {
-	GraphNodeIdx2List<Graph> node_idx2idx( g );
-	return Dijkstra( g, start_idx, node_idx2idx )[end_idx];
+	if constexpr( _Is_sparse_graph<Graph> )
+		return PointToPointDijkstra<Graph>( g ).Dijkstra( start_idx, end_idx );
+	else
+	{
+		GraphNodeIdx2List<Graph> node_idx2idx( g );
+		return Dijkstra( g, start_idx, node_idx2idx )[end_idx];
+	}
+}
+//Distance from start to end, heuristic(node_idx) is consistent lower bound of distance to end
+template <graph_type Graph, typename Heuristic>
+requires weighted_edge_type<typename Graph::Edge>&& _Is_sparse_graph<Graph>
+DistanceInfo_Dijkstra<Graph> AStar( const Graph& g, int start_idx, int end_idx, Heuristic&& heuristic )
+{
+	return PointToPointDijkstra<Graph>( g ).AStar( start_idx, end_idx, std::forward<Heuristic>( heuristic ) );
+}
+//Distance from start to end, search from both side
+template <graph_type Graph>
+requires weighted_edge_type<typename Graph::Edge>&& _Is_sparse_graph<Graph>&& _Has_inverse_edge<Graph>
+DistanceInfo_Dijkstra<Graph> BidirectionalDijkstra( const Graph& g, int start_idx, int end_idx )
+{
+	return PointToPointDijkstra<Graph>( g ).Bidirectional( start_idx, end_idx );
 }
 
 template <graph_type Graph>
@@ -0,0 +1,65 @@
+#pragma once
+#include "Graph.h"
+#include "Matrix.h"
+
+namespace Util::GraphTheory
+{
+//All pairs shortest path O(N^3), negative weight is allowed but negative cycle is not
+//dis[i][j] := distance from node i to node j (list idx), inf (larger than any distance) if unreachable
+//blocked by BlockSize*BlockSize tiles, k-loop of each tile only touches 3 tiles which stay in cache
+template <graph_type Graph, int BlockSize = 64>
+requires weighted_edge_type<typename Graph::Edge>
+void FloydWarshall( const Graph& g, Matrix<typename Graph::Edge::weight_type>& dis,
+					const typename Graph::Edge::weight_type inf = std::numeric_limits<typename Graph::Edge::weight_type>::max() )
+{
+	using weight_type = typename Graph::Edge::weight_type;
+	GraphNodeIdx2List<Graph> node_idx2idx( g );
+	const int n = (int)g.size_node();
+	dis.resize( n, n, inf );
+	for( int i = 0; i < n; i++ )
+		dis[i][i] = weight_type();
+	for( auto e = g.begin_edge(); e != g.end_edge(); ++e )
+	{
+		auto& d = dis[node_idx2idx[e->GetSource()]][node_idx2idx[e->GetDestination()]];
+		d = std::min( d, e->GetWeight() );
+	}
+
+	//relax tile (bi,bj) through k in tile bk
+	auto relax = [&dis, inf, n] ( int bi, int bj, int bk )
+	{
+		const int k_end = std::min( n, bk + BlockSize );
+		const int i_end = std::min( n, bi + BlockSize );
+		const int j_end = std::min( n, bj + BlockSize );
+		for( int k = bk; k < k_end; k++ )
+		{
+			const weight_type* dk = dis[k].data();
+			for( int i = bi; i < i_end; i++ )
+			{
+				weight_type* di = dis[i].data();
+				const weight_type dik = di[k];
+				if( dik == inf )
+					continue;
+				for( int j = bj; j < j_end; j++ )
+					if( dk[j] != inf && dik + dk[j] < di[j] )
+						di[j] = dik + dk[j];
+			}
+		}
+	};
+	for( int bk = 0; bk < n; bk += BlockSize )
+	{
+		//diagonal tile first, then its row and column, then the rest
+		relax( bk, bk, bk );
+		for( int b = 0; b < n; b += BlockSize )
+			if( b != bk )
+			{
+				relax( bk, b, bk );
+				relax( b, bk, bk );
+			}
+		for( int bi = 0; bi < n; bi += BlockSize )
+			if( bi != bk )
+				for( int bj = 0; bj < n; bj += BlockSize )
+					if( bj != bk )
+						relax( bi, bj, bk );
+	}
+}
+}
\ No newline at end of file
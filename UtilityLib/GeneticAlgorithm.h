@@ -0,0 +1,480 @@
+#pragma once
+#include "pch.h"
+#include "CommonDef.h"
+#include "Timer.h"
+#include "Util.h"
+#include "HillClimb.h"
+#include "Telemetry.h"
+#include <atomic>
+#include <barrier>
+#include <future>
+
+namespace Util::ORtool
+{
+//maxmize score (default)
+//population is split into islands, each generation: breed (parallel by island) -> evaluate (parallel by child) -> replace
+//Crossover(...), Mutate(...), Neighbor(...) and CalcScore(...) must be parallel executable
+template <typename Solution, typename Engine = Util::RNG, typename Policy = DefaultHookPolicy>
+class GeneticAlgorithm
+{
+public:
+	using SolutionType = Solution;
+	using RNGType = Engine;
+	using PolicyType = Policy;
+
+	enum struct tState
+	{
+		kInit = 1,
+		kGeneration = 2,
+		kUpdateSolution = 4,
+		kMigration = 8,
+		kFinish = 16,
+		kUndefinded = 32,
+	};
+	struct LogInfo
+	{
+		double best_score = 0;
+		double avg_score = 0;
+		std::int64_t generation = 0;
+		double time_s = 0;
+		double progress = 0;
+
+		static const char* CSVHeader()noexcept	{		return "best_score,avg_score,generation,time_s,progress";	}
+		void WriteCSV( std::ostream& os )const
+		{
+			os << best_score << ',' << avg_score << ',' << generation << ',' << time_s << ',' << progress;
+		}
+	};
+	using TelemetryType = TelemetryRing<LogInfo>;
+	struct Individual
+	{
+		Solution sol;
+		double score = 0;
+		unsigned int seed = 0;//seed of local improvement
+		bool improve = false;
+	};
+	bool isMaximize = true;
+
+private:
+	struct Island
+	{
+		std::vector<Individual> population;//sorted, best first
+		std::vector<Individual> offspring;
+		RNGType rng;
+	};
+	//run HillClimb on one individual, backup is kept here so Neighbor(...) needs no rollback
+	class LocalImprovement :public HillClimb<Solution, Engine, Policy>
+	{
+	private:
+		GeneticAlgorithm& me;
+		const Solution* start = nullptr;
+		Solution backup;
+	public:
+		LocalImprovement( GeneticAlgorithm& _me ) :me( _me )
+		{
+			this->isMaximize = _me.isMaximize;
+		}
+		void Run( Individual& e, double timelimit_s, std::int64_t max_iteration )
+		{
+			start = &e.sol;
+			this->Config( timelimit_s, max_iteration );
+			this->Execute( e.seed );
+			e.sol = this->GetSolution();
+			e.score = this->GetScore();
+		}
+	protected:
+		void InitializeSolution( Solution& sol )override
+		{
+			sol = *start;
+		}
+		void Neighbor( Solution& sol )override
+		{
+			backup = sol;
+			me.Neighbor( sol, this->GetRNG() );
+		}
+		void Rollback( Solution& sol )override
+		{
+			sol = std::move( backup );
+		}
+		double CalcScore( const Solution& sol )const override
+		{
+			return me.CalcScore( sol );
+		}
+	};
+
+	Timer global_time;
+	double m_timelimit_s = 1;//second
+	std::int64_t m_max_generation = 100;
+	std::int64_t m_generation = 0;
+	double m_progress = 0;//0-1
+
+	size_t m_population_size = 50;//per island
+	size_t m_tournament_size = 2;
+	size_t m_n_elite = 1;
+	double m_crossover_rate = 0.9;
+	double m_mutation_rate = 0.1;
+
+	int m_n_island = 1;
+	std::int64_t m_migration_gap = 10;//generation
+	size_t m_n_migrant = 1;
+
+	std::int64_t m_local_iteration = 0;//0 := no memetic step
+	double m_local_rate = 1;
+
+	std::vector<Island> m_island;
+	Solution opt_solution;
+	double m_opt_score = 0;
+	double m_avg_score = 0;
+
+	LFA::deque<LogInfo> m_logList;
+	std::int64_t m_max_log_size = 0;
+	std::int64_t m_generation_per_log = 0;
+	int m_collect_flag = (int)tState::kGeneration | (int)tState::kFinish;
+	std::int64_t m_last_log_generation = -1;
+	TelemetryType* m_telemetry = nullptr;//log to ring instead of m_logList
+	SampledTimer m_telemetry_time;
+
+protected:
+	mutable Engine rng;
+
+public:
+	decltype( m_max_generation ) GetMaxGeneration()const noexcept	{		return m_max_generation;	}
+	double GetTimeLimit()const noexcept	{		return m_timelimit_s;	}
+
+	void Config( double timelimit_s, std::int64_t max_generation, size_t population_size = 50 )noexcept;
+	//tournament selection, best n_elite individuals always survive
+	void ConfigSelection( size_t tournament_size = 2, size_t n_elite = 1, double crossover_rate = 0.9, double mutation_rate = 0.1 )noexcept;
+	//ring migration, best n_migrant of each island replace the worst of next island every migration_gap generations
+	void ConfigIsland( int n_island, std::int64_t migration_gap = 10, size_t n_migrant = 1 )noexcept;
+	//run HillClimb with Neighbor(...) on p of children for local_iteration steps, 0 := disable
+	void ConfigMemetic( std::int64_t local_iteration, double p = 1 )noexcept	{		m_local_iteration = local_iteration; m_local_rate = p;	}
+	//Record information after each state (or finish) iff generation changes >= m_max_generation/max_log_size
+	void ConfigLog( std::int64_t max_log_size = 0, int flag = (int)tState::kGeneration | (int)tState::kFinish ) noexcept;
+	//push log into preallocated ring (drained by TelemetryExporter) instead of m_logList, nullptr := disable
+	//time_s is sampled once every time_sample_gap logs
+	void ConfigTelemetry( TelemetryType* ring, std::uint32_t time_sample_gap = 64 )noexcept	{		m_telemetry = ring; m_telemetry_time.SetGap( time_sample_gap );	}
+
+	const Solution& GetSolution()const noexcept	{		return opt_solution;	}
+	double GetScore()const noexcept	{		return m_opt_score;	}
+	decltype( rng )& GetRNG()const noexcept	{		return rng;	}
+	const decltype( m_logList )& GetLogList()const noexcept	{		return m_logList;	}
+	double GetElapsedTime()const	{		return global_time.GetTime();	}
+	decltype( m_generation )GetGeneration()const noexcept	{		return m_generation;	}
+	//sorted, best first
+	const std::vector<Individual>& GetPopulation( int island_idx = 0 )const	{		return m_island[island_idx].population;	}
+
+	bool Execute( unsigned int seed = 0 )	{		return ParallelExecute( 1, seed );	}
+	bool ParallelExecute( const int n_thread, unsigned int seed = 0 );
+
+protected:
+	virtual void InitializeSolution( SolutionType& sol ) = 0;
+	virtual double CalcScore( const SolutionType& sol )const = 0;
+	virtual void Crossover( const SolutionType& a, const SolutionType& b, SolutionType& child, RNGType& rng ) = 0;
+	virtual void Mutate( SolutionType& sol, RNGType& rng ) = 0;
+	//local move for memetic step
+	virtual void Neighbor( SolutionType& sol, RNGType& rng )	{}
+	virtual void Hook( const tState state )	{}
+
+	double GetProgress()const noexcept	{		return m_progress;	}
+	double GetAvgScore()const noexcept	{		return m_avg_score;	}
+
+	void DefaultHook( const tState state )
+	{
+		if constexpr( Policy::enable_log )
+			UpdateLog( state );
+		if constexpr( Policy::enable_hook )
+			Hook( state );
+	}
+	void UpdateLog( const tState state );
+	bool isBetter( const double nxt_score, const double old_score )const noexcept	{		return isMaximize ? GT( nxt_score, old_score ) : LT( nxt_score, old_score );	}
+	bool Terminate()const	{		return global_time.GetTime() > m_timelimit_s || m_generation >= m_max_generation;	}
+
+private:
+	const Individual& Tournament( const Island& island, RNGType& r )const;
+	void Breed( Island& island );
+	void Replace( Island& island );
+	void Migrate();
+	void UpdateBest();
+};
+
+template<typename Solution, typename Engine, typename Policy>
+inline void GeneticAlgorithm<Solution, Engine, Policy>::Config( double timelimit_s, std::int64_t max_generation, size_t population_size ) noexcept
+{
+	m_timelimit_s = timelimit_s;
+	m_max_generation = max_generation;
+	m_population_size = std::max( population_size, (size_t)2 );
+}
+
+template<typename Solution, typename Engine, typename Policy>
+inline void GeneticAlgorithm<Solution, Engine, Policy>::ConfigSelection( size_t tournament_size, size_t n_elite, double crossover_rate, double mutation_rate ) noexcept
+{
+	m_tournament_size = std::max( tournament_size, (size_t)1 );
+	m_n_elite = n_elite;
+	m_crossover_rate = crossover_rate;
+	m_mutation_rate = mutation_rate;
+}
+
+template<typename Solution, typename Engine, typename Policy>
+inline void GeneticAlgorithm<Solution, Engine, Policy>::ConfigIsland( int n_island, std::int64_t migration_gap, size_t n_migrant ) noexcept
+{
+	m_n_island = std::max( n_island, 1 );
+	m_migration_gap = std::max( migration_gap, (std::int64_t)1 );
+	m_n_migrant = n_migrant;
+}
+
+template<typename Solution, typename Engine, typename Policy>
+inline void GeneticAlgorithm<Solution, Engine, Policy>::ConfigLog( std::int64_t max_log_size, int flag ) noexcept
+{
+	m_max_log_size = max_log_size;
+	m_collect_flag = flag;
+	m_generation_per_log = 0;
+	if( m_max_log_size != 0 )
+	{
+		m_generation_per_log = m_max_generation / m_max_log_size;
+		m_generation_per_log += m_generation_per_log == 0;
+	}
+}
+
+template<typename Solution, typename Engine, typename Policy>
+inline bool GeneticAlgorithm<Solution, Engine, Policy>::ParallelExecute( const int n_thread, unsigned int seed )
+{
+	if( n_thread < 1 )
+		return false;
+	RELEASE_VER_TRY;
+
+	global_time.SetTime();
+	rng = Engine( seed );
+	m_generation = 0;
+	m_progress = 0;
+	m_logList.clear();
+	m_last_log_generation = -1;
+	m_telemetry_time.SetTime();
+	const size_t n_elite = std::min( m_n_elite, m_population_size - 1 );
+	const size_t n_child = m_population_size - n_elite;
+
+	//initialize in order, so that result only depends on seed
+	m_island.clear();
+	m_island.resize( m_n_island );
+	for( std::uint64_t idx = 0; auto& island : m_island )
+	{
+		island.rng = SplitRNG( rng, idx++ );
+		island.population.resize( m_population_size );
+		island.offspring.resize( n_child );
+		for( auto& e : island.population )
+			InitializeSolution( e.sol );
+	}
+
+	//evaluate initial population in parallel
+	std::vector<Individual*> evalList;
+	evalList.reserve( m_population_size * m_n_island );
+	for( auto& island : m_island )
+		for( auto& e : island.population )
+			evalList.emplace_back( &e );
+	std::vector<LocalImprovement> local;
+	local.reserve( n_thread );
+	for( int i = 0; i < n_thread; i++ )
+		local.emplace_back( *this );
+
+	enum struct tPhase
+	{
+		kBreed,
+		kEvaluate,
+	};
+	tPhase phase = tPhase::kEvaluate;
+	bool is_init = true;
+	bool stop = false;
+	std::atomic<size_t> next_item = 0;
+	std::barrier guard( n_thread, [&] ()noexcept
+	{
+		next_item = 0;
+		if( phase == tPhase::kBreed )
+		{
+			phase = tPhase::kEvaluate;
+			return;
+		}
+		if( is_init )
+		{
+			is_init = false;
+			for( auto& island : m_island )
+				std::sort( island.population.begin(), island.population.end(), [this] ( const Individual& a, const Individual& b )
+				{
+					return this->isBetter( a.score, b.score );
+				} );
+			opt_solution = m_island.front().population.front().sol;
+			m_opt_score = m_island.front().population.front().score;
+			UpdateBest();
+			DefaultHook( tState::kInit );
+		}
+		else
+		{
+			for( auto& island : m_island )
+				Replace( island );
+			++m_generation;
+			if( m_n_island > 1 && m_generation % m_migration_gap == 0 )
+			{
+				Migrate();
+				DefaultHook( tState::kMigration );
+			}
+			UpdateBest();
+			DefaultHook( tState::kGeneration );
+		}
+		m_progress = std::max( global_time.GetTime() / m_timelimit_s, m_generation / static_cast<double>( m_max_generation ) );
+		stop = Terminate();
+		if( !stop )
+		{
+			evalList.clear();
+			for( auto& island : m_island )
+				for( auto& e : island.offspring )
+					evalList.emplace_back( &e );
+		}
+		phase = tPhase::kBreed;
+	} );
+	auto task = [&] ( const int thread_idx )->void
+	{
+		while( !stop )
+		{
+			if( phase == tPhase::kBreed )
+			{
+				for( size_t idx = next_item++; idx < m_island.size(); idx = next_item++ )
+					Breed( m_island[idx] );
+			}
+			else
+			{
+				for( size_t idx = next_item++; idx < evalList.size(); idx = next_item++ )
+				{
+					Individual& e = *evalList[idx];
+					if( e.improve )
+						local[thread_idx].Run( e, std::max( 0.0, m_timelimit_s - global_time.GetTime() ), m_local_iteration );
+					else
+						e.score = CalcScore( e.sol );
+				}
+			}
+			guard.arrive_and_wait();
+		}
+	};
+
+	std::vector<std::future<void>> thread_pool;
+	thread_pool.reserve( n_thread );
+	for( int i = 0; i < n_thread; i++ )
+		thread_pool.emplace_back( std::async( std::launch::async, task, i ) );
+
+	for( auto& e : thread_pool )
+		e.wait();
+
+	DefaultHook( tState::kFinish );
+
+	RELEASE_VER_CATCH_START( const std::exception& );
+	RELEASE_VER_CATCH_CONTENT( return false );
+	RELEASE_VER_CATCH_START( ... );
+	RELEASE_VER_CATCH_CONTENT( return false );
+	RELEASE_VER_CATCH_END;
+
+	return true;
+}
+
+template<typename Solution, typename Engine, typename Policy>
+inline void GeneticAlgorithm<Solution, Engine, Policy>::UpdateLog( const tState state )
+{
+	if( ( m_max_log_size > 0 || m_telemetry ) && ( (int)state & m_collect_flag ) != 0
+		&& ( state == tState::kFinish || m_last_log_generation < 0 || m_last_log_generation + m_generation_per_log <= m_generation ) )
+	{
+		m_last_log_generation = m_generation;
+		if( m_telemetry )
+			m_telemetry->Push( LogInfo{ GetScore(), GetAvgScore(), GetGeneration(), m_telemetry_time.GetTime(), GetProgress() } );
+		else
+			m_logList.emplace_back( GetScore(), GetAvgScore(), GetGeneration(), global_time.GetTime(), GetProgress() );
+	}
+}
+
+template<typename Solution, typename Engine, typename Policy>
+inline const typename GeneticAlgorithm<Solution, Engine, Policy>::Individual& GeneticAlgorithm<Solution, Engine, Policy>::Tournament( const Island& island, RNGType& r )const
+{
+	std::uniform_int_distribution<size_t> randx( 0, island.population.size() - 1 );
+	//population is sorted, the smallest index wins
+	size_t best = randx( r );
+	for( size_t i = 1; i < m_tournament_size; i++ )
+		best = std::min( best, randx( r ) );
+	return island.population[best];
+}
+
+template<typename Solution, typename Engine, typename Policy>
+inline void GeneticAlgorithm<Solution, Engine, Policy>::Breed( Island& island )
+{
+	std::uniform_real_distribution<double> rand01( 0.0, 1.0 );
+	for( auto& child : island.offspring )
+	{
+		const Individual& a = Tournament( island, island.rng );
+		if( rand01( island.rng ) < m_crossover_rate )
+		{
+			const Individual& b = Tournament( island, island.rng );
+			Crossover( a.sol, b.sol, child.sol, island.rng );
+		}
+		else
+			child.sol = a.sol;
+		if( rand01( island.rng ) < m_mutation_rate )
+			Mutate( child.sol, island.rng );
+		child.improve = m_local_iteration > 0 && rand01( island.rng ) < m_local_rate;
+		child.seed = (unsigned int)island.rng();
+	}
+}
+
+//elitist generational replacement, population = elite + offspring
+template<typename Solution, typename Engine, typename Policy>
+inline void GeneticAlgorithm<Solution, Engine, Policy>::Replace( Island& island )
+{
+	const auto cmp = [this] ( const Individual& a, const Individual& b )
+	{
+		return this->isBetter( a.score, b.score );
+	};
+	auto& pop = island.population;
+	const size_t n_elite = pop.size() - island.offspring.size();
+	for( size_t i = 0; i < island.offspring.size(); i++ )
+		std::swap( pop[n_elite + i], island.offspring[i] );
+	std::stable_sort( pop.begin(), pop.end(), cmp );
+}
+
+//ring topology, island i sends its best to island i+1
+template<typename Solution, typename Engine, typename Policy>
+inline void GeneticAlgorithm<Solution, Engine, Policy>::Migrate()
+{
+	const size_t n_migrant = std::min( m_n_migrant, m_population_size / 2 );
+	if( n_migrant == 0 )
+		return;
+	const auto cmp = [this] ( const Individual& a, const Individual& b )
+	{
+		return this->isBetter( a.score, b.score );
+	};
+	std::vector<Individual> migrant;
+	migrant.reserve( n_migrant * m_island.size() );
+	for( auto& island : m_island )
+		migrant.insert( migrant.end(), island.population.begin(), island.population.begin() + n_migrant );
+	const int n = (int)m_island.size();
+	for( int i = 0; i < n; i++ )
+	{
+		auto& pop = m_island[( i + 1 ) % n].population;
+		std::copy( migrant.begin() + i * n_migrant, migrant.begin() + ( i + 1 ) * n_migrant, pop.end() - n_migrant );
+		std::stable_sort( pop.begin(), pop.end(), cmp );
+	}
+}
+
+template<typename Solution, typename Engine, typename Policy>
+inline void GeneticAlgorithm<Solution, Engine, Policy>::UpdateBest()
+{
+	double tot = 0;
+	size_t cnt = 0;
+	for( auto& island : m_island )
+	{
+		for( auto& e : island.population )
+			tot += e.score;
+		cnt += island.population.size();
+		const Individual& best = island.population.front();
+		if( isBetter( best.score, m_opt_score ) )
+		{
+			opt_solution = best.sol;
+			m_opt_score = best.score;
+			DefaultHook( tState::kUpdateSolution );
+		}
+	}
+	m_avg_score = tot / cnt;
+}
+}
\ No newline at end of file
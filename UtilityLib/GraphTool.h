@@ -1,6 +1,10 @@
 #pragma once
 #include "Graph.h"
 #include "VecUtil.h"
+#include "Util.h"
+#include <atomic>
+#include <barrier>
+#include <future>
 
 namespace Util::GraphTheory
 {
@@ -77,4 +81,285 @@ std::vector<int> topological_sort( const Graph& g )
 	GraphNodeIdx2List<Graph> node_idx2idx( g );
 	return topological_sort( g, node_idx2idx );
 }
+
+//Direction-optimizing parallel BFS, depth[i] := number of edges from start to node (list idx i), -1 if unreachable
+//top-down expands out edges of frontier, bottom-up (inverse edge only) lets each unvisited node look for a parent in frontier
+//switch to bottom-up when edges of frontier > unexplored edges / alpha, back to top-down when frontier < N / beta
+//n_thread = 0 means all logical cores
+template<graph_type Graph>
+std::vector<int> parallel_bfs( const Graph& g, int start_idx, int n_thread = 0, int alpha = 14, int beta = 24 )
+{
+	GraphNodeIdx2List<Graph> node_idx2idx( g );
+	const int n = (int)g.size_node();
+	if( n_thread <= 0 )
+		n_thread = std::max( 1, GetLogicalCoreCount() );
+	n_thread = std::max( 1, std::min( n_thread, n ) );
+	std::vector<std::atomic<int>> depth( n );
+	for( auto& e : depth )
+		e.store( -1, std::memory_order_relaxed );
+	auto degree = [&g, &node_idx2idx] ( int idx )->std::int64_t	{		return (std::int64_t)g.CountOutDegree( *g.GetNode( node_idx2idx.GetNodeIdx( idx ) ) );	};
+
+	struct Local
+	{
+		std::vector<int> next;
+		std::int64_t m_next = 0;//out edges of next
+	};
+	std::vector<Local> local( n_thread );
+	const int st = node_idx2idx[start_idx];
+	depth[st] = 0;
+	std::vector<int> frontier = { st };
+	std::int64_t m_frontier = degree( st );
+	std::int64_t m_unexplored = (std::int64_t)g.size_edge() - m_frontier;
+	int cur_depth = 0;
+	bool bottom_up = false;
+	bool stop = false;
+	std::atomic<size_t> next_item = 0;
+	constexpr size_t chunk = 64;
+
+	std::barrier guard( n_thread, [&] ()noexcept
+	{
+		frontier.clear();
+		m_frontier = 0;
+		for( auto& e : local )
+		{
+			frontier.insert( frontier.end(), e.next.begin(), e.next.end() );
+			m_frontier += e.m_next;
+			e.next.clear();
+			e.m_next = 0;
+		}
+		++cur_depth;
+		next_item = 0;
+		stop = frontier.empty();
+		m_unexplored -= m_frontier;
+		if constexpr( _Has_inverse_edge<Graph> )
+		{
+			if( !bottom_up && m_frontier > m_unexplored / alpha )
+				bottom_up = true;
+			else if( bottom_up && (std::int64_t)frontier.size() < n / beta )
+				bottom_up = false;
+		}
+	} );
+	auto task = [&] ( const int thread_idx )->void
+	{
+		Local& self = local[thread_idx];
+		while( !stop )
+		{
+			if( !bottom_up )
+			{
+				for( size_t bg; ( bg = next_item.fetch_add( chunk ) ) < frontier.size(); )
+					for( size_t i = bg; i < std::min( bg + chunk, frontier.size() ); ++i )
+					{
+						auto p = g.GetNode( node_idx2idx.GetNodeIdx( frontier[i] ) );
+						for( auto e = g.GetNextEdge( *p ); e; e = g.GetNextEdge( *e ) )
+						{
+							const int v = node_idx2idx[e->GetDestination()];
+							int expect = -1;
+							if( depth[v].load( std::memory_order_relaxed ) == -1 && depth[v].compare_exchange_strong( expect, cur_depth + 1, std::memory_order_relaxed ) )
+							{
+								self.next.emplace_back( v );
+								self.m_next += degree( v );
+							}
+						}
+					}
+			}
+			else if constexpr( _Has_inverse_edge<Graph> )
+			{
+				for( size_t bg; ( bg = next_item.fetch_add( chunk ) ) < (size_t)n; )
+					for( int v = (int)bg; v < (int)std::min( bg + chunk, (size_t)n ); ++v )
+					{
+						if( depth[v].load( std::memory_order_relaxed ) != -1 )
+							continue;
+						auto p = g.GetNode( node_idx2idx.GetNodeIdx( v ) );
+						for( auto e = g.GetNextInverseEdge( *p ); e; e = g.GetNextInverseEdge( *e ) )
+							if( depth[node_idx2idx[e->GetSource()]].load( std::memory_order_relaxed ) == cur_depth )
+							{
+								depth[v].store( cur_depth + 1, std::memory_order_relaxed );
+								self.next.emplace_back( v );
+								self.m_next += degree( v );
+								break;
+							}
+					}
+			}
+			guard.arrive_and_wait();
+		}
+	};
+	std::vector<std::future<void>> thread_pool;
+	thread_pool.reserve( n_thread );
+	for( int i = 0; i < n_thread; i++ )
+		thread_pool.emplace_back( std::async( std::launch::async, task, i ) );
+	for( auto& e : thread_pool )
+		e.get();
+
+	std::vector<int> retval( n );
+	for( int i = 0; i < n; i++ )
+		retval[i] = depth[i].load( std::memory_order_relaxed );
+	return retval;
+}
+
+//Weakly connected component by parallel union-find (edge direction is ignored)
+//label[i] := smallest list idx in the component of node (list idx i)
+//n_thread = 0 means all logical cores
+template<graph_type Graph>
+std::vector<int> connected_component_label( const Graph& g, int n_thread = 0 )
+{
+	GraphNodeIdx2List<Graph> node_idx2idx( g );
+	const int n = (int)g.size_node();
+	if( n_thread <= 0 )
+		n_thread = std::max( 1, GetLogicalCoreCount() );
+	n_thread = std::max( 1, std::min( n_thread, n ) );
+	//parent[i]<=i, root is the smallest idx
+	std::vector<std::atomic<int>> parent( n );
+	for( int i = 0; i < n; i++ )
+		parent[i].store( i, std::memory_order_relaxed );
+	auto find = [&parent] ( int x )->int
+	{
+		while( true )
+		{
+			int p = parent[x].load();
+			if( p == x )
+				return x;
+			const int gp = parent[p].load();
+			if( p != gp )
+				parent[x].compare_exchange_weak( p, gp );//path halving
+			x = gp;
+		}
+	};
+	auto unite = [&parent, &find] ( int a, int b )
+	{
+		while( true )
+		{
+			a = find( a );
+			b = find( b );
+			if( a == b )
+				return;
+			if( a < b )
+				std::swap( a, b );
+			int expect = a;
+			if( parent[a].compare_exchange_strong( expect, b ) )
+				return;
+		}
+	};
+
+	std::atomic<size_t> next_item = 0;
+	constexpr size_t chunk = 256;
+	auto run = [&] ( auto&& fn )
+	{
+		next_item = 0;
+		auto task = [&] ()->void
+		{
+			for( size_t bg; ( bg = next_item.fetch_add( chunk ) ) < (size_t)n; )
+				for( int i = (int)bg; i < (int)std::min( bg + chunk, (size_t)n ); ++i )
+					fn( i );
+		};
+		std::vector<std::future<void>> thread_pool;
+		thread_pool.reserve( n_thread );
+		for( int i = 0; i < n_thread; i++ )
+			thread_pool.emplace_back( std::async( std::launch::async, task ) );
+		for( auto& e : thread_pool )
+			e.get();
+	};
+	run( [&] ( int u )
+	{
+		auto p = g.GetNode( node_idx2idx.GetNodeIdx( u ) );
+		for( auto e = g.GetNextEdge( *p ); e; e = g.GetNextEdge( *e ) )
+			unite( u, node_idx2idx[e->GetDestination()] );
+	} );
+	std::vector<int> label( n );
+	run( [&] ( int u )
+	{
+		label[u] = find( u );
+	} );
+	return label;
+}
+
+//Kahn's algorithm by levels in parallel
+//level[k] := nodes (node idx, ascending) whose longest path from an in-degree 0 node has k edges
+//total size of levels is less than N if there is a cycle
+//n_thread = 0 means all logical cores
+template<graph_type Graph>
+std::vector<std::vector<int>> parallel_topological_sort( const Graph& g, int n_thread = 0 )
+{
+	GraphNodeIdx2List<Graph> node_idx2idx( g );
+	const int n = (int)g.size_node();
+	std::vector<std::vector<int>> level;
+	if( n == 0 )
+		return level;
+	if( n_thread <= 0 )
+		n_thread = std::max( 1, GetLogicalCoreCount() );
+	n_thread = std::max( 1, std::min( n_thread, n ) );
+	std::vector<std::atomic<int>> indegree( n );
+
+	enum struct tPhase
+	{
+		kCount,//count in-degree by out edges
+		kSource,//collect in-degree 0
+		kLevel,//remove current level
+	};
+	tPhase phase = tPhase::kCount;
+	bool stop = false;
+	std::vector<std::vector<int>> local( n_thread );//list idx
+	std::vector<int> cur;//list idx
+	std::atomic<size_t> next_item = 0;
+	constexpr size_t chunk = 64;
+
+	std::barrier guard( n_thread, [&] ()noexcept
+	{
+		next_item = 0;
+		if( phase == tPhase::kCount )
+		{
+			phase = tPhase::kSource;
+			return;
+		}
+		phase = tPhase::kLevel;
+		cur.clear();
+		for( auto& e : local )
+		{
+			cur.insert( cur.end(), e.begin(), e.end() );
+			e.clear();
+		}
+		stop = cur.empty();
+		if( stop )
+			return;
+		auto& lv = level.emplace_back();
+		lv.reserve( cur.size() );
+		for( int idx : cur )
+			lv.emplace_back( node_idx2idx.GetNodeIdx( idx ) );
+		std::ranges::sort( lv );
+	} );
+	auto task = [&] ( const int thread_idx )->void
+	{
+		while( !stop )
+		{
+			const size_t len = phase == tPhase::kLevel ? cur.size() : (size_t)n;
+			for( size_t bg; ( bg = next_item.fetch_add( chunk ) ) < len; )
+				for( size_t i = bg; i < std::min( bg + chunk, len ); ++i )
+				{
+					if( phase == tPhase::kSource )
+					{
+						if( indegree[i].load( std::memory_order_relaxed ) == 0 )
+							local[thread_idx].emplace_back( (int)i );
+						continue;
+					}
+					const int u = phase == tPhase::kLevel ? cur[i] : (int)i;
+					auto p = g.GetNode( node_idx2idx.GetNodeIdx( u ) );
+					for( auto e = g.GetNextEdge( *p ); e; e = g.GetNextEdge( *e ) )
+					{
+						const int v = node_idx2idx[e->GetDestination()];
+						if( phase == tPhase::kCount )
+							indegree[v].fetch_add( 1, std::memory_order_relaxed );
+						else if( indegree[v].fetch_sub( 1, std::memory_order_relaxed ) == 1 )
+							local[thread_idx].emplace_back( v );
+					}
+				}
+			guard.arrive_and_wait();
+		}
+	};
+	std::vector<std::future<void>> thread_pool;
+	thread_pool.reserve( n_thread );
+	for( int i = 0; i < n_thread; i++ )
+		thread_pool.emplace_back( std::async( std::launch::async, task, i ) );
+	for( auto& e : thread_pool )
+		e.get();
+	return level;
+}
 }
\ No newline at end of file
@@ -3,19 +3,21 @@
 #include "CommonDef.h"
 #include "Timer.h"
 #include "Util.h"
+#include "Telemetry.h"
 
 namespace Util::ORtool
 {
-template <typename Solution, typename Engine>
+template <typename Solution, typename Engine, typename Policy>
 class SimulatedAnnealing;
 
 //maxmize score (default)
-template <typename Solution, typename Engine = Util::RNG>
+template <typename Solution, typename Engine = Util::RNG, typename Policy = DefaultHookPolicy>
 class HillClimb
 {
 public:
 	using SolutionType = Solution;
 	using RNGType = Engine;
+	using PolicyType = Policy;
 
 	enum struct tState
 	{
@@ -33,7 +35,14 @@ public:
 		double time_s = 0;
 		double progress = 0;
 		bool accept = false;
+
+		static const char* CSVHeader()noexcept	{		return "score,iteration,time_s,progress,accept";	}
+		void WriteCSV( std::ostream& os )const
+		{
+			os << score << ',' << iteration << ',' << time_s << ',' << progress << ',' << accept;
+		}
 	};
+	using TelemetryType = TelemetryRing<LogInfo>;
 
 	bool isMaximize = true;
 
@@ -51,12 +60,15 @@ private:
 	LFA::deque<LogInfo> m_logList;
 	bool m_is_collect = false;
 	int m_collect_flag = (int)tState::kAcceptSolution | (int)tState::kRollback;
+	TelemetryType* m_telemetry = nullptr;//log to ring instead of m_logList
+	SampledTimer m_telemetry_time;
 
 protected:
 	mutable Engine rng;
 
 public:
-	friend class SimulatedAnnealing<Solution, Engine>;
+	template <typename, typename, typename>
+	friend class SimulatedAnnealing;
 	
 	decltype( m_max_iteration ) GetMaxIteration()const noexcept	{		return m_max_iteration;	}
 	double GetTimeLimit()const noexcept	{		return m_timelimit_s;	}
@@ -68,6 +80,9 @@ public:
 		m_is_collect = collect_log;
 		m_collect_flag = collect_flag;
 	}
+	//push log into preallocated ring (drained by TelemetryExporter) instead of m_logList, nullptr := disable
+	//time_s is sampled once every time_sample_gap logs, collect_log of Config is still required
+	void ConfigTelemetry( TelemetryType* ring, std::uint32_t time_sample_gap = 64 )noexcept	{		m_telemetry = ring; m_telemetry_time.SetGap( time_sample_gap );	}
 	const Solution& GetSolution()const noexcept	{		return m_sol;	}
 	double GetScore()const noexcept	{		return m_best_score;	}
 	decltype( rng )& GetRNG()const noexcept	{		return rng;	}
@@ -87,20 +102,23 @@ protected:
 	double GetProgress()const	{		return std::max( global_time.GetTime() / m_timelimit_s, m_iteration / static_cast<double>( m_max_iteration ) );	}
 	void DefaultHook( const tState state )
 	{
-		UpdateLog( state );
-		Hook( state );
+		if constexpr( Policy::enable_log )
+			UpdateLog( state );
+		if constexpr( Policy::enable_hook )
+			Hook( state );
 	}
 	double GetNextScore()const noexcept	{		return m_nxt_score;	}
 	bool Terminate()const	{		return global_time.GetTime() > m_timelimit_s || m_iteration >= m_max_iteration;	}
 	void UpdateLog( const tState state );
 };
 
-template<typename Solution, typename Engine>
-inline bool HillClimb<Solution, Engine>::Execute( unsigned int seed )
+template<typename Solution, typename Engine, typename Policy>
+inline bool HillClimb<Solution, Engine, Policy>::Execute( unsigned int seed )
 {
 	RELEASE_VER_TRY;
 
 	global_time.SetTime();
+	m_telemetry_time.SetTime();
 	rng = Engine( seed );
 	m_iteration = 0;
 	m_logList.clear();
@@ -135,26 +153,30 @@ inline bool HillClimb<Solution, Engine>::Execute( unsigned int seed )
 
 	return true;
 }
-template<typename Solution, typename Engine>
-inline void HillClimb<Solution, Engine>::UpdateLog( const tState state )
+template<typename Solution, typename Engine, typename Policy>
+inline void HillClimb<Solution, Engine, Policy>::UpdateLog( const tState state )
 {
 	if( m_is_collect && ( m_collect_flag & (int)state ) != 0 )
 	{
-		auto& e = m_logList.emplace_back();
+		LogInfo e;
 		e.iteration = GetIteration();
-		e.time_s = global_time.GetTime();
+		e.time_s = m_telemetry ? m_telemetry_time.GetTime() : global_time.GetTime();
 		e.progress = GetProgress();
 		e.accept = !( state == tState::kRollback );
 		e.score = ( state == tState::kRollback || state == tState::kAcceptSolution ) ? GetNextScore() : GetScore();
+		if( m_telemetry )
+			m_telemetry->Push( e );
+		else
+			m_logList.push_back( e );
 	}
 }
 
 //Transform from SA to HC
 template<typename SimulatedAnnealingEntity>
-class HillClimbFromSimulatedAnnealing :public HillClimb<typename SimulatedAnnealingEntity::SolutionType, typename SimulatedAnnealingEntity::RNGType>
+class HillClimbFromSimulatedAnnealing :public HillClimb<typename SimulatedAnnealingEntity::SolutionType, typename SimulatedAnnealingEntity::RNGType, typename SimulatedAnnealingEntity::PolicyType>
 {
 private:
-	static_assert( std::is_base_of_v<SimulatedAnnealing<SimulatedAnnealingEntity::SolutionType,SimulatedAnnealingEntity::RNGType>, SimulatedAnnealingEntity>,
+	static_assert( std::is_base_of_v<SimulatedAnnealing<typename SimulatedAnnealingEntity::SolutionType, typename SimulatedAnnealingEntity::RNGType, typename SimulatedAnnealingEntity::PolicyType>, SimulatedAnnealingEntity>,
 				   "SimulatedAnnealingEntity must inherit from SimulatedAnnealing" );
 
 	SimulatedAnnealingEntity& me;
@@ -1,13 +1,17 @@
 #pragma once
 #include <vector>
 #include <functional>
+#include <limits>
+#include "Matrix.h"
 
-//  HungarianAlgorithm ʵ㷨ڽͼƥ⡣
-//  㷨 O(n^3) ʱҵһͼƥ䣬 n ͼнڵ
+//  HungarianAlgorithm ʵ˶ͼƥ㷨
+//  ƥʹ Hopcroft-Karp 㷨ʵ֣޵ݹ飩ʱ临Ӷ O(E*sqrt(V))
+//  Ȩƥ䣨ָ⣩ʹ Jonker-Volgenant ·㷨ʱ临Ӷ O(n^3)
 //  ṩ¹ܣ
 //  - ʼʹøҽڵʼ㷨
 //  - ڽӱߣڽӱӱߡ
 //  - ⣺ͼƥ䡣
+//  - ָɣ۾С۵ȫƥ䡣
 //  - գ㷨״̬ԱڽµĶͼƥ⡣
 class HungarianAlgorithm
 {
@@ -16,7 +20,10 @@ private:
 	int numRight = 0; // Ҳڵ
 	std::vector<std::vector<int>> adjList; // ͼڽӱʾ
 	std::vector<int> matchedRight; // 洢ÿҲڵƥڵ
-	std::vector<bool> visited; //  DFS зʹҲڵ
+	std::vector<int> matchedLeft; // 洢ÿڵƥҲڵ
+	std::vector<int> dist; // BFS ڵĲ-1 ʾɴ
+	std::vector<int> iter; // DFS ڵ㵱ǰʵڽӱ
+	std::vector<int> path; // DFS ʽջ
 	int maxMatching = 0; // 洢ƥĴС
 
 public:
@@ -29,7 +36,9 @@ public:
 		numRight = rightCount;
 		adjList.resize( leftCount + 1 ); // ΪÿڵڽбĴС
 		matchedRight.resize( rightCount + 1, 0 );
-		visited.resize( rightCount + 1, false );
+		matchedLeft.resize( leftCount + 1, 0 );
+		dist.resize( leftCount + 1, -1 );
+		iter.resize( leftCount + 1, 0 );
 		maxMatching = 0;
 	}
 
@@ -43,44 +52,194 @@ public:
 		//  ڵЧִκβ
 	}
 
-	//  Ѱ·
+	//  BFS δƥڵֲ㣬Ƿ·
+	bool BuildLayer()
+	{
+		std::vector<int>& queue = path;
+		queue.clear();
+		for( int i = 1; i <= numLeft; ++i )
+		{
+			dist[i] = matchedLeft[i] == 0 ? 0 : -1;
+			if( dist[i] == 0 )
+				queue.push_back( i );
+		}
+		int limit = -1; // ׸δƥҲڵĲ㣬ֻ·
+		for( size_t head = 0; head < queue.size(); ++head )
+		{
+			const int leftNode = queue[head];
+			if( limit != -1 && dist[leftNode] > limit )
+			{
+				dist[leftNode] = -1; // ·Ĳ㲻뱾׶
+				continue;
+			}
+			for( int rightNode : adjList[leftNode] )
+			{
+				const int next = matchedRight[rightNode];
+				if( next == 0 )
+					limit = dist[leftNode];
+				else if( limit == -1 && dist[next] == -1 )
+				{
+					dist[next] = dist[leftNode] + 1;
+					queue.push_back( next );
+				}
+			}
+		}
+		return limit != -1;
+	}
+
+	//  طֲͼʽջѰ·ҵջתƥ
 	bool FindAugmentingPath( int leftNode )
 	{
-		for( int rightNode : adjList[leftNode] )
+		path.clear();
+		path.push_back( leftNode );
+		while( !path.empty() )
 		{
-			if( !visited[rightNode] )
+			const int cur = path.back();
+			if( iter[cur] == (int)adjList[cur].size() )
+			{
+				dist[cur] = -1; // 㣬׶βٷ
+				path.pop_back();
+				continue;
+			}
+			const int rightNode = adjList[cur][iter[cur]];
+			const int next = matchedRight[rightNode];
+			if( next == 0 )
 			{
-				visited[rightNode] = true;
-				if( matchedRight[rightNode] == 0 || FindAugmentingPath( matchedRight[rightNode] ) )
+				for( int node : path )
 				{
-					matchedRight[rightNode] = leftNode;
-					return true;
+					const int r = adjList[node][iter[node]];
+					matchedLeft[node] = r;
+					matchedRight[r] = node;
 				}
+				return true;
 			}
+			if( dist[next] == dist[cur] + 1 )
+				path.push_back( next ); // ʱ dist[next] ѱΪ -1 
+			else
+				++iter[cur];
 		}
 		return false;
 	}
 
 	int Solve()
 	{
-		for( int i = 1; i <= numLeft; ++i )
+		while( BuildLayer() )
 		{
-			std::fill( visited.begin(), visited.end(), false );
-			if( FindAugmentingPath( i ) )
+			std::fill( iter.begin(), iter.end(), 0 );
+			for( int i = 1; i <= numLeft; ++i )
 			{
-				maxMatching++;
+				if( matchedLeft[i] == 0 && FindAugmentingPath( i ) )
+				{
+					maxMatching++;
+				}
 			}
 		}
 		return maxMatching;
 	}
 
+	//  Ҳڵƥڵ㣬0 ʾδƥ
+	const std::vector<int>& GetMatchedRight()const	{		return matchedRight;	}
+	//  ڵƥҲڵ㣬0 ʾδƥ
+	const std::vector<int>& GetMatchedLeft()const	{		return matchedLeft;	}
+
+	//  ָ⣺cost[i][j] Ϊ i з j еĴۣ± 0 ʼСܴ
+	//  Բͬٵһȫ䣻ķʹ㹻޴
+	//  assignment[i] Ϊ i зУδΪ -1Сܴ
+	static double SolveAssignment( const Util::Matrix<double>& cost, std::vector<int>& assignment )
+	{
+		auto [rows, cols] = cost.size();
+		assignment.assign( rows, -1 );
+		if( rows == 0 || cols == 0 )
+			return 0;
+		if( rows > cols )
+		{
+			Util::Matrix<double> transposed = cost;
+			transposed.Transpose();
+			std::vector<int> colAssignment;
+			const double total = SolveAssignment( transposed, colAssignment );
+			for( int j = 0; j < (int)cols; ++j )
+				assignment[colAssignment[j]] = j;
+			return total;
+		}
+
+		//  ż uУvУÿμһк Dijkstra ķʽѰ·
+		const int n = (int)rows;
+		const int m = (int)cols;
+		constexpr double inf = std::numeric_limits<double>::infinity();
+		std::vector<double> u( n + 1, 0 ), v( m + 1, 0 ), minv( m + 1 );
+		std::vector<int> p( m + 1, 0 ), way( m + 1, 0 ); // p[j] Ϊ j ƥУ 1 ʼ 0 Ϊ
+		std::vector<char> used( m + 1 );
+		for( int i = 1; i <= n; ++i )
+		{
+			p[0] = i;
+			int j0 = 0;
+			std::fill( minv.begin(), minv.end(), inf );
+			std::fill( used.begin(), used.end(), false );
+			do
+			{
+				used[j0] = true;
+				const int i0 = p[j0];
+				const double* row = cost[i0 - 1].data();
+				double delta = inf;
+				int j1 = 0;
+				for( int j = 1; j <= m; ++j )
+				{
+					if( used[j] )
+						continue;
+					const double cur = row[j - 1] - u[i0] - v[j];
+					if( cur < minv[j] )
+					{
+						minv[j] = cur;
+						way[j] = j0;
+					}
+					if( minv[j] < delta )
+					{
+						delta = minv[j];
+						j1 = j;
+					}
+				}
+				for( int j = 0; j <= m; ++j )
+				{
+					if( used[j] )
+					{
+						u[p[j]] += delta;
+						v[j] -= delta;
+					}
+					else
+						minv[j] -= delta;
+				}
+				j0 = j1;
+			} while( p[j0] != 0 );
+			do
+			{
+				const int j1 = way[j0];
+				p[j0] = p[j1];
+				j0 = j1;
+			} while( j0 != 0 );
+		}
+
+		double total = 0;
+		for( int j = 1; j <= m; ++j )
+		{
+			if( p[j] != 0 )
+			{
+				assignment[p[j] - 1] = j - 1;
+				total += cost[p[j] - 1][j - 1];
+			}
+		}
+		return total;
+	}
+
 	void Clear()
 	{
 		numLeft = 0;
 		numRight = 0;
 		adjList.clear();
 		matchedRight.clear();
-		visited.clear();
+		matchedLeft.clear();
+		dist.clear();
+		iter.clear();
+		path.clear();
 		maxMatching = 0;
 	}
 };
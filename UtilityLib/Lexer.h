@@ -0,0 +1,458 @@
+#pragma once
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <type_traits>
+#include <assert.h>
+
+namespace CFG
+{
+//pattern of token, character is code point (int)
+class LexPattern
+{
+public:
+	enum struct tType
+	{
+		kEmpty,//match empty string
+		kSet,//one character in range
+		kConcat,
+		kAlt,
+		kStar,
+	};
+	static constexpr int MaxChar = 0x10FFFF;
+
+private:
+	tType type = tType::kEmpty;
+	std::vector<std::pair<int, int>> range;//closed interval, kSet only
+	std::vector<LexPattern> sub;
+
+public:
+	LexPattern()
+	{}
+
+	tType GetType()const noexcept								{		return type;	}
+	const std::vector<std::pair<int, int>>& GetRange()const	{		return range;	}
+	const std::vector<LexPattern>& GetSub()const				{		return sub;	}
+
+	static LexPattern Char( int c )
+	{
+		return Range( c, c );
+	}
+	static LexPattern Range( int lo, int hi )
+	{
+		assert( lo <= hi );
+		LexPattern p;
+		p.type = tType::kSet;
+		p.range = { { lo,hi } };
+		return p;
+	}
+	//any character in s
+	static LexPattern Set( std::string_view s )
+	{
+		LexPattern p;
+		p.type = tType::kSet;
+		for( unsigned char c : s )
+			p.range.emplace_back( c, c );
+		p.Normalize();
+		return p;
+	}
+	//any character not in p (p must be a set)
+	static LexPattern Except( const LexPattern& p )
+	{
+		assert( p.type == tType::kSet );
+		LexPattern ret;
+		ret.type = tType::kSet;
+		int lo = 1;
+		for( auto [x, y] : p.range )
+		{
+			if( lo < x )
+				ret.range.emplace_back( lo, x - 1 );
+			lo = y + 1;
+		}
+		if( lo <= MaxChar )
+			ret.range.emplace_back( lo, MaxChar );
+		return ret;
+	}
+	static LexPattern Literal( std::string_view s )
+	{
+		LexPattern p;
+		for( unsigned char c : s )
+			p = p + Char( c );
+		return p;
+	}
+	static LexPattern Literal( std::wstring_view s )
+	{
+		LexPattern p;
+		for( wchar_t c : s )
+			p = p + Char( (int)c );
+		return p;
+	}
+	LexPattern Star()const
+	{
+		LexPattern p;
+		p.type = tType::kStar;
+		p.sub = { *this };
+		return p;
+	}
+	LexPattern Plus()const		{		return *this + Star();	}
+	LexPattern Optional()const	{		return *this | LexPattern();	}
+
+	friend LexPattern operator+( const LexPattern& l, const LexPattern& r )
+	{
+		if( l.type == tType::kEmpty )
+			return r;
+		if( r.type == tType::kEmpty )
+			return l;
+		LexPattern p;
+		p.type = tType::kConcat;
+		p.sub = { l,r };
+		return p;
+	}
+	friend LexPattern operator|( const LexPattern& l, const LexPattern& r )
+	{
+		if( l.type == tType::kSet && r.type == tType::kSet )
+		{
+			LexPattern p = l;
+			p.range.insert( p.range.end(), r.range.begin(), r.range.end() );
+			p.Normalize();
+			return p;
+		}
+		LexPattern p;
+		p.type = tType::kAlt;
+		p.sub = { l,r };
+		return p;
+	}
+
+private:
+	//sort and merge overlapped range
+	void Normalize()
+	{
+		std::sort( range.begin(), range.end() );
+		std::vector<std::pair<int, int>> tmp;
+		for( auto& e : range )
+			if( !tmp.empty() && e.first <= tmp.back().second + 1 )
+				tmp.back().second = std::max( tmp.back().second, e.second );
+			else
+				tmp.push_back( e );
+		range.swap( tmp );
+	}
+};
+
+namespace LexTemplate
+{
+inline LexPattern Digit()
+{
+	return LexPattern::Range( '0', '9' );
+}
+inline LexPattern Integer()
+{
+	return Digit().Plus();
+}
+//123, 1.5
+inline LexPattern RealNumber()
+{
+	return Integer() + ( LexPattern::Char( '.' ) + Integer() ).Optional();
+}
+//start from [a-zA-Z_], then [a-zA-Z0-9_]
+inline LexPattern Identifier()
+{
+	auto head = LexPattern::Range( 'a', 'z' ) | LexPattern::Range( 'A', 'Z' ) | LexPattern::Char( '_' );
+	return head + ( head | Digit() ).Star();
+}
+//quote is included, no escape
+inline LexPattern String( int quote = '"' )
+{
+	return LexPattern::Char( quote ) + LexPattern::Except( LexPattern::Char( quote ) ).Star() + LexPattern::Char( quote );
+}
+inline LexPattern Whitespace()
+{
+	return LexPattern::Set( " \t\r\n" ).Plus();
+}
+}
+
+//DFA scanner, longest match first then the rule added first
+//token id is used as terminal of Grammar, so that one phase of CFGparser is one token instead of one character
+class Lexer
+{
+public:
+	struct Token
+	{
+		int id = -1;
+		int begin = 0;//source [begin,end)
+		int end = 0;
+	};
+	enum struct tError
+	{
+		kSuc = 0,
+		kNoRule,
+	};
+
+private:
+	struct Rule
+	{
+		int id = -1;
+		bool skip = false;
+		LexPattern pattern;
+	};
+	struct NFAState
+	{
+		std::vector<int> eps;
+		std::vector<std::pair<std::pair<int, int>, int>> edge;//<range,to>
+		int accept = -1;//rule idx
+	};
+	std::vector<Rule> rule;
+	std::vector<NFAState> nfa;
+
+	std::vector<int> bound;//char class k is [bound[k],bound[k+1])
+	std::vector<int> ascii2class;//fast path of char<128
+	int n_class = 0;
+	std::vector<int> trans;//[state][class], -1 := dead
+	std::vector<int> accept;//state->rule idx, -1 := not accept
+
+public:
+	Lexer()
+	{}
+
+	//the rule added first has higher priority when length is the same, skipped token is not emitted (ex. whitespace)
+	void AddToken( int id, const LexPattern& pattern, bool skip = false )
+	{
+		rule.push_back( Rule{ id,skip,pattern } );
+	}
+	//literal token, id is the first character by default (ex. '+')
+	void AddLiteral( std::string_view s, int id = -1 )
+	{
+		assert( !s.empty() );
+		AddToken( id == -1 ? (unsigned char)s.front() : id, LexPattern::Literal( s ) );
+	}
+	void AddSkip( const LexPattern& pattern )
+	{
+		AddToken( -1, pattern, true );
+	}
+	int GetStateCount()const noexcept	{		return (int)accept.size();	}
+	int GetClassCount()const noexcept	{		return n_class;	}
+
+	tError Compile()
+	{
+		if( rule.empty() )
+			return tError::kNoRule;
+		//Thompson NFA, state 0 is start
+		nfa.assign( 1, NFAState() );
+		for( int i = 0; i < (int)rule.size(); ++i )
+		{
+			auto [st, ed] = BuildNFA( rule[i].pattern );
+			nfa[0].eps.push_back( st );
+			nfa[ed].accept = i;
+		}
+		//char class
+		bound = { 0,LexPattern::MaxChar + 1 };
+		for( auto& s : nfa )
+			for( auto& [r, to] : s.edge )
+			{
+				bound.push_back( r.first );
+				bound.push_back( r.second + 1 );
+			}
+		std::sort( bound.begin(), bound.end() );
+		bound.erase( std::unique( bound.begin(), bound.end() ), bound.end() );
+		n_class = (int)bound.size() - 1;
+		ascii2class.resize( 128 );
+		for( int c = 0; c < 128; ++c )
+			ascii2class[c] = int( std::upper_bound( bound.begin(), bound.end(), c ) - bound.begin() ) - 1;
+		//subset construction
+		std::map<std::vector<int>, int> set2state;
+		std::vector<std::vector<int>> state;
+		auto add_state = [&] ( std::vector<int> s )->int
+		{
+			if( s.empty() )
+				return -1;
+			auto [it, inserted] = set2state.try_emplace( s, (int)state.size() );
+			if( inserted )
+			{
+				int acc = -1;
+				for( int x : s )
+					if( nfa[x].accept != -1 && ( acc == -1 || nfa[x].accept < acc ) )
+						acc = nfa[x].accept;
+				accept.push_back( acc );
+				state.push_back( std::move( s ) );
+			}
+			return it->second;
+		};
+		accept.clear();
+		trans.clear();
+		add_state( Closure( { 0 } ) );
+		for( size_t k = 0; k < state.size(); ++k )
+		{
+			trans.resize( ( k + 1 ) * n_class, -1 );
+			for( int cls = 0; cls < n_class; ++cls )
+			{
+				const int c = bound[cls];
+				std::vector<int> next;
+				for( int x : state[k] )
+					for( auto& [r, to] : nfa[x].edge )
+						if( r.first <= c && c <= r.second )
+							next.push_back( to );
+				const int to = add_state( Closure( std::move( next ) ) );
+				trans[k * n_class + cls] = to;
+			}
+		}
+		nfa.clear();
+		return tError::kSuc;
+	}
+
+	//return false if no token matches at error_pos
+	template <typename Elem>
+	bool Tokenize( std::basic_string_view<Elem> src, std::vector<Token>& token, int* error_pos = nullptr )const
+	{
+		assert( !accept.empty() );
+		token.clear();
+		const int n = (int)src.size();
+		for( int i = 0; i < n; )
+		{
+			int s = 0;
+			int last_rule = -1;
+			int last_end = i;
+			for( int j = i; j < n; ++j )
+			{
+				const int cls = GetClass( (int)static_cast<std::make_unsigned_t<Elem>>( src[j] ) );
+				if( cls == -1 )
+					break;
+				s = trans[s * n_class + cls];
+				if( s == -1 )
+					break;
+				if( accept[s] != -1 )
+				{
+					last_rule = accept[s];
+					last_end = j + 1;
+				}
+			}
+			if( last_rule == -1 )
+			{
+				if( error_pos )
+					*error_pos = i;
+				return false;
+			}
+			if( !rule[last_rule].skip )
+				token.push_back( Token{ rule[last_rule].id,i,last_end } );
+			i = last_end;
+		}
+		return true;
+	}
+	bool Tokenize( std::string_view src, std::vector<Token>& token, int* error_pos = nullptr )const		{		return Tokenize<char>( src, token, error_pos );	}
+	bool Tokenize( std::wstring_view src, std::vector<Token>& token, int* error_pos = nullptr )const	{		return Tokenize<wchar_t>( src, token, error_pos );	}
+
+	//text of CFGparser
+	static std::vector<int> toText( std::span<const Token> token )
+	{
+		std::vector<int> text;
+		text.reserve( token.size() );
+		for( auto& e : token )
+			text.push_back( e.id );
+		return text;
+	}
+	//source range [begin,end) of token [pos,pos_end) (ex. node of CFGparser)
+	static std::pair<int, int> GetSourceRange( std::span<const Token> token, int pos, int pos_end )
+	{
+		if( pos == pos_end )
+		{
+			const int x = pos < (int)token.size() ? token[pos].begin : ( token.empty() ? 0 : token.back().end );
+			return { x,x };
+		}
+		return { token[pos].begin,token[pos_end - 1].end };
+	}
+	//tokenize src and parse tokens, token is kept for GetSourceRange
+	template <typename Parser>
+	bool Parse( Parser& cfg, std::string_view src, std::vector<Token>& token, int* error_pos = nullptr )const
+	{
+		return Tokenize( src, token, error_pos ) && cfg.Parse( toText( token ) );
+	}
+	template <typename Parser>
+	bool Parse( Parser& cfg, std::wstring_view src, std::vector<Token>& token, int* error_pos = nullptr )const
+	{
+		return Tokenize( src, token, error_pos ) && cfg.Parse( toText( token ) );
+	}
+
+private:
+	int GetClass( const int c )const noexcept
+	{
+		if( c < 128 )
+			return ascii2class[c];
+		if( c > LexPattern::MaxChar )
+			return -1;
+		return int( std::upper_bound( bound.begin(), bound.end(), c ) - bound.begin() ) - 1;
+	}
+	//<start,end> of fragment
+	std::pair<int, int> BuildNFA( const LexPattern& p )
+	{
+		auto new_state = [this] ()
+		{
+			nfa.emplace_back();
+			return (int)nfa.size() - 1;
+		};
+		switch( p.GetType() )
+		{
+		case LexPattern::tType::kEmpty:
+		{
+			const int x = new_state();
+			return { x,x };
+		}
+		case LexPattern::tType::kSet:
+		{
+			const int x = new_state(), y = new_state();
+			for( auto& r : p.GetRange() )
+				nfa[x].edge.emplace_back( r, y );
+			return { x,y };
+		}
+		case LexPattern::tType::kConcat:
+		{
+			auto [a, b] = BuildNFA( p.GetSub()[0] );
+			auto [c, d] = BuildNFA( p.GetSub()[1] );
+			nfa[b].eps.push_back( c );
+			return { a,d };
+		}
+		case LexPattern::tType::kAlt:
+		{
+			const int x = new_state();
+			auto [a, b] = BuildNFA( p.GetSub()[0] );
+			auto [c, d] = BuildNFA( p.GetSub()[1] );
+			const int y = new_state();
+			nfa[x].eps = { a,c };
+			nfa[b].eps.push_back( y );
+			nfa[d].eps.push_back( y );
+			return { x,y };
+		}
+		case LexPattern::tType::kStar:
+		{
+			const int x = new_state();
+			auto [a, b] = BuildNFA( p.GetSub()[0] );
+			const int y = new_state();
+			nfa[x].eps = { a,y };
+			nfa[b].eps.push_back( a );
+			nfa[b].eps.push_back( y );
+			return { x,y };
+		}
+		}
+		assert( false );
+		return { -1,-1 };
+	}
+	//sorted epsilon closure
+	std::vector<int> Closure( std::vector<int> s )const
+	{
+		std::sort( s.begin(), s.end() );
+		s.erase( std::unique( s.begin(), s.end() ), s.end() );
+		std::vector<char> visit( nfa.size(), 0 );
+		for( int x : s )
+			visit[x] = 1;
+		for( size_t k = 0; k < s.size(); ++k )
+			for( int y : nfa[s[k]].eps )
+				if( !visit[y] )
+				{
+					visit[y] = 1;
+					s.push_back( y );
+				}
+		std::sort( s.begin(), s.end() );
+		return s;
+	}
+};
+}
\ No newline at end of file
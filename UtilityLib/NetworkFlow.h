@@ -0,0 +1,357 @@
+#pragma once
+#include "Graph.h"
+#include "dynamic_priority_queue.h"
+
+namespace Util::GraphTheory
+{
+//Edge class with capacity (weight) and cost per unit of flow
+template <typename CapType = int, typename CostType = CapType>
+class FlowEdge :public WeightedEdge<CapType>
+{
+public:
+	using cost_type = CostType;
+protected:
+	CostType cost = CostType();
+public:
+	FlowEdge() :WeightedEdge<CapType>()
+	{}
+	const CostType& GetCost()const noexcept	{		return cost;	}
+	CostType& GetCost() noexcept	{		return cost;	}
+};
+template <typename T>
+concept flow_edge_type = weighted_edge_type<T> && std::is_base_of_v<FlowEdge<typename T::weight_type, typename T::cost_type>, T>;
+
+//Residual graph built from out edges and inverse edge links, no reverse edge is added to the graph
+//arcs of node (list idx) u := [offset[u],offset[u+1]), out edges (forward) then in edges (backward), self loop is skipped
+//forward arc has residual capacity - flow, backward arc has residual flow
+template <graph_type Graph>
+requires weighted_edge_type<typename Graph::Edge> && _Has_inverse_edge<Graph>
+class _ResidualGraph
+{
+public:
+	using cap_type = typename Graph::Edge::weight_type;
+
+	std::vector<int> offset;
+	std::vector<int> head;//destination of arc (list idx)
+	std::vector<int> edge;//edge idx of arc
+	std::vector<char> forward;
+	std::vector<cap_type> capacity;//by edge idx
+
+	_ResidualGraph( const Graph& g, const GraphNodeIdx2List<Graph>& node_idx2idx )
+	{
+		const int n = (int)g.size_node();
+		int n_edge = 0;
+		for( auto e = g.begin_edge(); e != g.end_edge(); ++e )
+			n_edge = std::max( n_edge, e->GetIdx() + 1 );
+		capacity.resize( n_edge );
+		for( auto e = g.begin_edge(); e != g.end_edge(); ++e )
+		{
+			assert( e->GetWeight() >= cap_type() );
+			capacity[e->GetIdx()] = e->GetWeight();
+		}
+		offset.reserve( n + 1 );
+		head.reserve( 2 * g.size_edge() );
+		edge.reserve( 2 * g.size_edge() );
+		forward.reserve( 2 * g.size_edge() );
+		for( int u = 0; u < n; u++ )
+		{
+			offset.emplace_back( (int)head.size() );
+			auto p = g.GetNode( node_idx2idx.GetNodeIdx( u ) );
+			for( auto e = g.GetNextEdge( *p ); e; e = g.GetNextEdge( *e ) )
+				if( const int v = node_idx2idx[e->GetDestination()]; v != u )
+				{
+					head.emplace_back( v );
+					edge.emplace_back( e->GetIdx() );
+					forward.emplace_back( true );
+				}
+			for( auto e = g.GetNextInverseEdge( *p ); e; e = g.GetNextInverseEdge( *e ) )
+				if( const int v = node_idx2idx[e->GetSource()]; v != u )
+				{
+					head.emplace_back( v );
+					edge.emplace_back( e->GetIdx() );
+					forward.emplace_back( false );
+				}
+		}
+		offset.emplace_back( (int)head.size() );
+	}
+	int size_node()const	{		return (int)offset.size() - 1;	}
+	//residual capacity of arc a
+	cap_type Residual( int a, const std::vector<cap_type>& flow )const
+	{
+		return forward[a] ? capacity[edge[a]] - flow[edge[a]] : flow[edge[a]];
+	}
+	//residual capacity of opposite direction of arc a (head->tail)
+	cap_type InverseResidual( int a, const std::vector<cap_type>& flow )const
+	{
+		return forward[a] ? flow[edge[a]] : capacity[edge[a]] - flow[edge[a]];
+	}
+	void Push( int a, const cap_type delta, std::vector<cap_type>& flow )const
+	{
+		if( forward[a] )
+			flow[edge[a]] += delta;
+		else
+			flow[edge[a]] -= delta;
+	}
+};
+
+//Max flow by highest label push-relabel with global relabeling and gap heuristic, O(N^2*sqrt(E))
+//capacity := edge weight (non-negative), flow[edge idx] := flow on edge after return
+//return value of max flow from source to sink (node idx)
+template <graph_type Graph>
+requires weighted_edge_type<typename Graph::Edge> && _Has_inverse_edge<Graph>
+typename Graph::Edge::weight_type MaxFlow( const Graph& g, int source_idx, int sink_idx, std::vector<typename Graph::Edge::weight_type>& flow )
+{
+	using cap_type = typename Graph::Edge::weight_type;
+	GraphNodeIdx2List<Graph> node_idx2idx( g );
+	const _ResidualGraph<Graph> r( g, node_idx2idx );
+	const int n = r.size_node();
+	const int s = node_idx2idx[source_idx];
+	const int t = node_idx2idx[sink_idx];
+	flow.assign( r.capacity.size(), cap_type() );
+	if( s == t )
+		return cap_type();
+
+	//height of node is a lower bound of distance to sink, or n + distance to source if sink is unreachable
+	std::vector<int> height( n ), count( 2 * n + 1 ), current( n );
+	std::vector<cap_type> excess( n );
+	std::vector<std::vector<int>> active( 2 * n + 1 );//active node by height, stale entry is skipped
+	int max_active = 0;
+	auto activate = [&] ( int u )
+	{
+		if( u != s && u != t )
+		{
+			active[height[u]].emplace_back( u );
+			max_active = std::max( max_active, height[u] );
+		}
+	};
+	auto global_relabel = [&] ()
+	{
+		std::ranges::fill( height, 2 * n );
+		std::ranges::fill( count, 0 );
+		std::vector<int> q;
+		q.reserve( n );
+		auto bfs = [&] ( int root, int base )
+		{
+			q.assign( 1, root );
+			height[root] = base;
+			for( size_t h = 0; h < q.size(); h++ )
+			{
+				const int u = q[h];
+				for( int a = r.offset[u]; a < r.offset[u + 1]; a++ )
+					if( const int v = r.head[a]; height[v] == 2 * n && r.InverseResidual( a, flow ) > cap_type() )
+					{
+						height[v] = height[u] + 1;
+						q.emplace_back( v );
+					}
+			}
+		};
+		height[s] = n;
+		bfs( t, 0 );
+		bfs( s, n );
+		for( auto& e : active )
+			e.clear();
+		max_active = 0;
+		for( int u = 0; u < n; u++ )
+		{
+			++count[height[u]];
+			current[u] = r.offset[u];
+			if( excess[u] > cap_type() )
+				activate( u );
+		}
+	};
+	//no node at height k < n, nodes above it can not reach sink
+	auto gap = [&] ( int k )
+	{
+		for( int u = 0; u < n; u++ )
+			if( height[u] > k && height[u] < n )
+			{
+				--count[height[u]];
+				height[u] = n + 1;
+				++count[height[u]];
+				current[u] = r.offset[u];
+				if( excess[u] > cap_type() )
+					activate( u );
+			}
+	};
+
+	for( int a = r.offset[s]; a < r.offset[s + 1]; a++ )
+		if( const cap_type delta = r.Residual( a, flow ); delta > cap_type() )
+		{
+			r.Push( a, delta, flow );
+			excess[r.head[a]] += delta;
+			excess[s] -= delta;
+		}
+	global_relabel();
+
+	const size_t relabel_limit = 6 * (size_t)n + r.head.size();
+	size_t work = 0;
+	while( true )
+	{
+		while( max_active >= 0 && active[max_active].empty() )
+			--max_active;
+		if( max_active < 0 )
+			break;
+		const int u = active[max_active].back();
+		active[max_active].pop_back();
+		if( height[u] != max_active || excess[u] == cap_type() )
+			continue;
+		//discharge
+		while( excess[u] > cap_type() )
+		{
+			if( current[u] == r.offset[u + 1] )
+			{
+				//relabel
+				const int old = height[u];
+				int h = 2 * n;
+				for( int a = r.offset[u]; a < r.offset[u + 1]; a++ )
+					if( r.Residual( a, flow ) > cap_type() )
+						h = std::min( h, height[r.head[a]] + 1 );
+				work += r.offset[u + 1] - r.offset[u] + 12;
+				--count[old];
+				height[u] = h;
+				++count[h];
+				current[u] = r.offset[u];
+				if( count[old] == 0 && old < n )
+					gap( old );
+				if( height[u] != h )//moved by gap, active again
+					break;
+				continue;
+			}
+			const int a = current[u];
+			const int v = r.head[a];
+			const cap_type res = r.Residual( a, flow );
+			if( res > cap_type() && height[u] == height[v] + 1 )
+			{
+				const cap_type delta = std::min( excess[u], res );
+				r.Push( a, delta, flow );
+				excess[u] -= delta;
+				const bool idle = excess[v] == cap_type();
+				excess[v] += delta;
+				if( idle )
+					activate( v );
+			}
+			else
+				++current[u];
+		}
+		if( work > relabel_limit )
+		{
+			global_relabel();
+			work = 0;
+		}
+	}
+	return excess[t];
+}
+
+//Min cost flow by successive shortest path, Dijkstra on reduced cost with node potential, O(F*E*log(N))
+//capacity := edge weight (non-negative), cost := edge cost, negative cost is allowed but negative cycle is not
+//send at most max_flow from source to sink (node idx) with min cost, flow[edge idx] := flow on edge after return
+//return <flow, cost>
+template <graph_type Graph>
+requires flow_edge_type<typename Graph::Edge> && _Has_inverse_edge<Graph>
+std::pair<typename Graph::Edge::weight_type, typename Graph::Edge::cost_type> MinCostFlow( const Graph& g, int source_idx, int sink_idx,
+																							 std::vector<typename Graph::Edge::weight_type>& flow,
+																							 const typename Graph::Edge::weight_type max_flow = std::numeric_limits<typename Graph::Edge::weight_type>::max() )
+{
+	using cap_type = typename Graph::Edge::weight_type;
+	using cost_type = typename Graph::Edge::cost_type;
+	GraphNodeIdx2List<Graph> node_idx2idx( g );
+	const _ResidualGraph<Graph> r( g, node_idx2idx );
+	const int n = r.size_node();
+	const int s = node_idx2idx[source_idx];
+	const int t = node_idx2idx[sink_idx];
+	flow.assign( r.capacity.size(), cap_type() );
+	if( s == t )
+		return { cap_type(), cost_type() };
+
+	std::vector<cost_type> cost( r.capacity.size() );
+	bool has_negative = false;
+	for( auto e = g.begin_edge(); e != g.end_edge(); ++e )
+	{
+		cost[e->GetIdx()] = e->GetCost();
+		has_negative |= e->GetCost() < cost_type();
+	}
+	auto ArcCost = [&] ( int a )	{		return r.forward[a] ? cost[r.edge[a]] : -cost[r.edge[a]];	};
+
+	//potential makes reduced cost non-negative, Bellman-Ford (queue based) for negative cost
+	constexpr cost_type inf = std::numeric_limits<cost_type>::max();
+	std::vector<cost_type> potential( n, cost_type() );
+	if( has_negative )
+	{
+		std::ranges::fill( potential, inf );
+		std::vector<int> q = { s };
+		std::vector<char> in_queue( n, false );
+		potential[s] = cost_type();
+		in_queue[s] = true;
+		for( size_t h = 0; h < q.size(); h++ )
+		{
+			const int u = q[h];
+			in_queue[u] = false;
+			for( int a = r.offset[u]; a < r.offset[u + 1]; a++ )
+				if( const int v = r.head[a]; r.Residual( a, flow ) > cap_type() && potential[u] + ArcCost( a ) < potential[v] )
+				{
+					potential[v] = potential[u] + ArcCost( a );
+					if( !in_queue[v] )
+					{
+						in_queue[v] = true;
+						q.emplace_back( v );
+					}
+				}
+		}
+	}
+
+	std::vector<cost_type> dis( n );
+	std::vector<int> prev_arc( n ), prev_node( n );//shortest path tree
+	std::vector<char> settled( n );
+	dynamic_priority_queue<cost_type, std::greater<>> heap;//smallest top
+	heap.resize( n );
+	cap_type total_flow = cap_type();
+	cost_type total_cost = cost_type();
+	while( total_flow < max_flow )
+	{
+		std::ranges::fill( dis, inf );
+		std::ranges::fill( settled, false );
+		dis[s] = cost_type();
+		heap.push( s, dis[s] );
+		while( !heap.empty() )
+		{
+			const int u = heap.top().idx;
+			heap.pop();
+			settled[u] = true;
+			for( int a = r.offset[u]; a < r.offset[u + 1]; a++ )
+			{
+				const int v = r.head[a];
+				if( settled[v] || r.Residual( a, flow ) == cap_type() )
+					continue;
+				const cost_type d = dis[u] + ArcCost( a ) + potential[u] - potential[v];
+				if( d < dis[v] )
+				{
+					if( heap.exists( v ) )
+						heap.update_priority( v, d );
+					else
+						heap.push( v, d );
+					dis[v] = d;
+					prev_arc[v] = a;
+					prev_node[v] = u;
+				}
+			}
+		}
+		if( !settled[t] )
+			break;
+		//node not settled never becomes reachable again, its potential is unused
+		for( int u = 0; u < n; u++ )
+			if( settled[u] )
+				potential[u] += dis[u];
+
+		cap_type delta = max_flow - total_flow;
+		for( int v = t; v != s; v = prev_node[v] )
+			delta = std::min( delta, r.Residual( prev_arc[v], flow ) );
+		for( int v = t; v != s; v = prev_node[v] )
+		{
+			r.Push( prev_arc[v], delta, flow );
+			total_cost += ArcCost( prev_arc[v] ) * delta;
+		}
+		total_flow += delta;
+	}
+	return { total_flow, total_cost };
+}
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include "SimulatedAnnealing.h"
 #include "Util.h"
+#include <atomic>
 
 namespace Util::ORtool
 {
@@ -12,6 +13,20 @@ public:
 		kLinear,
 		kExp,
 	};
+	enum struct tLadder
+	{
+		kAcceptRatio,//balance acceptance ratio of each replica
+		kSwapFeedback,//feedback-optimized, drive swap ratio of each adjacent pair to target
+	};
+	//swap statistics of adjacent pair <rank k, rank k+1> in ladder
+	struct SwapStat
+	{
+		std::int64_t n_try = 0;
+		std::int64_t n_accept = 0;
+		double ratio = 0;//smoothed swap acceptance ratio
+
+		double GetAcceptRatio()const noexcept	{		return n_try == 0 ? 0 : n_accept / static_cast<double>( n_try );	}
+	};
 
 private:
 	mutable std::mt19937 rng;
@@ -21,6 +36,11 @@ private:
 	int min_split = 1000;//default split
 
 	tMethod m_method = tMethod::kLinear;
+	tLadder m_ladder = tLadder::kAcceptRatio;
+	int m_n_thread = 0;//0 := min(#replica, #logical core)
+	double m_target_swap_ratio = 0.01;//from some paper
+	double m_feedback_gain = 0.1;
+	std::vector<SwapStat> m_swap_stat;
 	static constexpr double RATIO_LIMIT = 10;//P=e^-det/(T*ratio)=(e^-det/T)^(1/ratio)=P0^(1/ratio) thus 0.01%^0.1 > 30% is enough
 	static constexpr int STEP_CNT = 50;
 	static constexpr double STEP_MAX = RATIO_LIMIT / STEP_CNT;
@@ -35,6 +55,19 @@ public:
 	{
 		m_method = val;
 	}
+	void SetLadder( tLadder val, double target_swap_ratio = 0.01, double feedback_gain = 0.1 )
+	{
+		m_ladder = val;
+		m_target_swap_ratio = target_swap_ratio;
+		m_feedback_gain = feedback_gain;
+	}
+	//replicas are multiplexed on n_thread workers, 0 := min(#replica, #logical core)
+	void SetThreadCount( int n_thread )
+	{
+		m_n_thread = std::max( 0, n_thread );
+	}
+	//index k := swap between ladder rank k and k+1 (ascending ratio)
+	const std::vector<SwapStat>& GetSwapStatList()const noexcept	{		return m_swap_stat;	}
 	template <typename T>
 	requires simulated_annealing_type<typename std::iterator_traits<T>::value_type>
 	bool Execute( T begin, T end, unsigned int seed = 0 )
@@ -73,17 +106,26 @@ public:
 		if( q.empty() )
 			return true;
 		const int n = (int)q.size();
+		int n_thread = m_n_thread;
+		if( n_thread == 0 )
+			n_thread = std::max( 1, GetLogicalCoreCount() );
+		n_thread = std::min( n_thread, n );
+		m_swap_stat.assign( std::max( n - 1, 0 ), SwapStat() );
 		const double timelimit = begin->GetTimeLimit();
 		const std::int64_t max_iteration = begin->GetMaxIteration();
 
-		for( auto &it : q )
+		//each replica has its own stream, result does not depend on thread count
+		typename sa_type::RNGType root( seed );
+		for( std::uint64_t idx = 0; auto &it : q )
 		{
+			it.sol->rng = SplitRNG( root, idx++ );
 			it.sol->SimulatedAnnealing::Initialize();
 			it.sol->DefaultHook( sa_type::tState::kInit );
 		}
 
-		//interval
-		const int gap = (int)std::min( (std::int64_t)max_interval, std::max( (std::int64_t)min_interval, max_iteration / min_split ) );
+		//interval, adapted by swap ratio
+		int gap = (int)std::min( (std::int64_t)max_interval, std::max( (std::int64_t)min_interval, max_iteration / min_split ) );
+		int last_gap = gap;
 		std::vector<double> dist;
 		dist.reserve( n );
 		if( n >= 2 )
@@ -119,10 +161,16 @@ public:
 
 		std::vector<int> rank2idx;
 		rank2idx.resize( n, -1 );
+		std::vector<std::int64_t> pair_try, pair_acc;
+		pair_try.resize( m_swap_stat.size() );
+		pair_acc.resize( m_swap_stat.size() );
 
 		bool stop = false;
-		std::barrier guard( n, [&] ()noexcept
+		std::atomic<int> next_replica = 0;
+		std::barrier guard( n_thread, [&] ()noexcept
 		{
+			next_replica = 0;
+			last_gap = gap;
 			for( auto& it : q )
 				it.score = it.sol->GetCurrScore();
 			stop = false;
@@ -154,14 +202,15 @@ public:
 			int tot = 0;
 			std::uniform_int_distribution<int> randx( 0, n - 2 );
 			std::fill( rank2idx.begin(), rank2idx.end(), -1 );
+			std::fill( pair_try.begin(), pair_try.end(), 0 );
+			std::fill( pair_acc.begin(), pair_acc.end(), 0 );
 			for( int k = 0; k < n; k++ )
 				rank2idx[q[k].ratioidx] = k;
 			for( int k = 0; k < n * std::min( n, 2 ); k++ )
 			{
-				int i = randx( rng );
-				int j = i + 1;
-				i = rank2idx[i];
-				j = rank2idx[j];
+				const int pair = randx( rng );
+				int i = rank2idx[pair];
+				int j = rank2idx[pair + 1];
 
 				const bool isSwap = SwapTest( avgT * q[i].ratio, avgT * q[j].ratio, q[i].score, q[j].score );
 				if( isSwap )
@@ -172,34 +221,57 @@ public:
 				}
 				cnt_swap += isSwap;
 				tot++;
+				++pair_try[pair];
+				pair_acc[pair] += isSwap;
 			}
 			swap_p = swap_p * 0.8 + 0.2 * ( cnt_swap * 1.0 / tot );
+			for( int k = 0; k < n - 1; k++ )
+			{
+				auto& e = m_swap_stat[k];
+				e.n_try += pair_try[k];
+				e.n_accept += pair_acc[k];
+				if( pair_try[k] > 0 )
+					e.ratio = e.ratio * 0.8 + 0.2 * ( pair_acc[k] * 1.0 / pair_try[k] );
+			}
+
+			//no swap means the barrier is wasted, exchange less often; frequent swap speeds up mixing, exchange more often
+			if( m_ladder == tLadder::kSwapFeedback )
+			{
+				if( cnt_swap == 0 )
+					gap = std::min( gap * 2, max_interval );
+				else if( swap_p > m_target_swap_ratio )
+					gap = std::max( gap / 2, min_interval );
+			}
 
 			//adjust dist by acc
 			for( auto& e : q )
 			{
-				e.p_acc = e.p_acc * 0.5 + 0.5 * ( e.sol->GetAcceptCnt() - e.last_acc_cnt ) / gap;
+				e.p_acc = e.p_acc * 0.5 + 0.5 * ( e.sol->GetAcceptCnt() - e.last_acc_cnt ) / last_gap;
 				e.last_acc_cnt = e.sol->GetAcceptCnt();
 			}
-			for( int k = 1; k < n - 1; k++ )
+			if( m_ladder == tLadder::kSwapFeedback )
+				FeedbackLadder( dist );
+			else
 			{
-				const auto& cur = q[rank2idx[k]];
-				const auto& prev = q[rank2idx[k - 1]];
-				const auto& next = q[rank2idx[k + 1]];
-				const double p = cur.p_acc;
-				const double expected_p = ( prev.p_acc + next.p_acc ) * 0.5;//from some paper
-				if( expected_p < 0.2 )
-					continue;
-				const double expected_std = 0.1;
-				double norm_p = fabs( p - expected_p ) / ( expected_std * 2 );
-				if( std::erf( norm_p ) > rand01( rng ) )
+				for( int k = 1; k < n - 1; k++ )
 				{
-					if( p > expected_p )
-						dist[k] = dist[k - 1] + ( dist[k] - dist[k - 1] ) * 0.999;
-					else
-						dist[k] = dist[k + 1] - ( dist[k + 1] - dist[k] ) * 0.999;
+					const auto& cur = q[rank2idx[k]];
+					const auto& prev = q[rank2idx[k - 1]];
+					const auto& next = q[rank2idx[k + 1]];
+					const double p = cur.p_acc;
+					const double expected_p = ( prev.p_acc + next.p_acc ) * 0.5;//from some paper
+					if( expected_p < 0.2 )
+						continue;
+					const double expected_std = 0.1;
+					double norm_p = fabs( p - expected_p ) / ( expected_std * 2 );
+					if( std::erf( norm_p ) > rand01( rng ) )
+					{
+						if( p > expected_p )
+							dist[k] = dist[k - 1] + ( dist[k] - dist[k - 1] ) * 0.999;
+						else
+							dist[k] = dist[k + 1] - ( dist[k + 1] - dist[k] ) * 0.999;
+					}
 				}
-				//std::cout << int( cur.p_acc * 100 ) << ' ' << int(dist[k]*100) << ' ';
 			}
 			//std::cout << '\n';
 
@@ -208,7 +280,7 @@ public:
 			{
 				update_gap = 0;
 				const double p = swap_p;
-				const double expected_p = 0.01;//from some paper
+				const double expected_p = m_target_swap_ratio;
 				const double expected_std = expected_p;
 				double norm_p = fabs( p - expected_p ) / ( expected_std * 2 );
 				if( std::erf( norm_p ) > rand01( rng ) )
@@ -233,27 +305,31 @@ public:
 			for( auto& it : q )
 				it.sol->SetTmaxTmin( avgT * it.ratio, it.Tmin );
 		} );
-		auto task = [&] ( const int idx )->void
+		//each worker takes replicas one by one until all of them finish this round
+		auto task = [&] ()->void
 		{
-			auto& cur = q[idx];
 			while( !stop )
 			{
-				for( int i = 0; i < gap; i++ )
+				for( int idx = next_replica++; idx < n; idx = next_replica++ )
 				{
-					if( cur.sol->Terminate() )[[unlikely]]
-						break;
-					cur.sol->EvaluateStep();
-					cur.sol->ResampleUpdate();
-					cur.sol->UpdateStep();
+					auto& cur = q[idx];
+					for( int i = 0; i < gap; i++ )
+					{
+						if( cur.sol->Terminate() )[[unlikely]]
+							break;
+						cur.sol->EvaluateStep();
+						cur.sol->ResampleUpdate();
+						cur.sol->UpdateStep();
+					}
 				}
 				guard.arrive_and_wait();
 			}
 		};
 
 		std::vector<std::future<void>> thread_pool;
-		thread_pool.reserve( n );
-		for( int i = 0; i < n; i++ )
-			thread_pool.emplace_back( std::async( task, i ) );
+		thread_pool.reserve( n_thread );
+		for( int i = 0; i < n_thread; i++ )
+			thread_pool.emplace_back( std::async( std::launch::async, task ) );
 
 		for( auto& e : thread_pool )
 			e.wait();
@@ -327,6 +403,32 @@ private:
 		std::sort( ratioList.begin(), ratioList.end() );
 		return ratioList;
 	}
+	//widen the gap of pair swapping too often, narrow the gap of pair seldom swapping
+	void FeedbackLadder( std::vector<double>& dist )const
+	{
+		const int n = (int)dist.size();
+		if( n <= 2 )
+			return;
+		const double min_width = 1e-3 / n;
+		std::vector<double> width;
+		width.reserve( n - 1 );
+		double tot = 0;
+		for( int k = 0; k < n - 1; k++ )
+		{
+			const double err = std::clamp( ( m_swap_stat[k].ratio - m_target_swap_ratio ) / std::max( m_target_swap_ratio, eps ), -1.0, 1.0 );
+			const double w = std::max( ( dist[k + 1] - dist[k] ) * std::exp( m_feedback_gain * err ), min_width );
+			width.emplace_back( w );
+			tot += w;
+		}
+		double acc = 0;
+		dist[0] = 0;
+		for( int k = 1; k < n; k++ )
+		{
+			acc += width[k - 1];
+			dist[k] = acc / tot;
+		}
+		dist[n - 1] = 1;
+	}
 	bool SwapTest( double T1, double T2, double score1, double score2 )const
 	{
 		std::uniform_real_distribution<double> rand01( 0.0, 1.0 );
@@ -6,79 +6,294 @@
 
 namespace Util
 {
+//node storage of RBtree
+enum struct RBtreeStorage
+{
+	kList,//node in std::list (kept in key order), iterator is list iterator
+	kSlab,//node in contiguous slab linked by 32-bit index with free list, colour in top bit of subtree size, iterator walks the tree
+};
+
 //red-black tree with rank search: https://en.wikipedia.org/wiki/Red%E2%80%93black_tree#loopInvariantI
-template <typename T, typename _comp = std::less<T>, typename _allo = std::allocator<T>>
+//kSlab costs 16 bytes per node besides key (kList: 2 list pointers + 3 list iterators + size + colour), at most 2^31-1 nodes
+template <typename T, typename _comp = std::less<T>, typename _allo = std::allocator<T>, RBtreeStorage Storage = RBtreeStorage::kList>
 class RBtree
 {
 public:
 	using key_type = T;
 	using key_comp = _comp;
 	using allocator_type = _allo;
-private:
-	class Node;
-	using list_allocator_type = std::allocator_traits<allocator_type>::template rebind_alloc<Node>;
-	using list_type = std::list<Node, list_allocator_type>;
-public:
-	using iterator = typename list_type::iterator;
-	using const_iterator = typename list_type::const_iterator;
-
 private:
 	enum struct tColor
 	{
 		kBlack = 0,
 		kRed = 1,
 	};
-	class Node
+	class ListStorage
 	{
+	public:
+		class Node;
+		using list_allocator_type = std::allocator_traits<allocator_type>::template rebind_alloc<Node>;
+		using list_type = std::list<Node, list_allocator_type>;
+		using iterator = typename list_type::iterator;
+		using const_iterator = typename list_type::const_iterator;
+		using link = iterator;
+		class Node
+		{
+		private:
+			link parent;
+			link child[2];
+			unsigned int tot = 1;
+			tColor color = tColor::kRed;
+			key_type key;
+
+		public:
+			friend class ListStorage;
+			Node()
+			{}
+			Node( link end, const key_type& val ) :parent( end ), child{ end,end }, key( val )
+			{}
+			const key_type& get()const noexcept
+			{
+				return key;
+			}
+		};
 	private:
-		iterator parent;
-		iterator child[2];
-		unsigned int tot = 1;
-		tColor color = tColor::kRed;
-		key_type key;
+		list_type data;
+	public:
+		link root;
+
+		ListStorage()
+		{
+			root = nil();
+		}
+		iterator begin()			{		return data.begin();	}
+		iterator end()				{		return data.end();	}
+		const_iterator begin()const	{		return data.cbegin();	}
+		const_iterator end()const	{		return data.cend();	}
+		std::size_t size()const noexcept	{		return data.size();	}
+		void clear()
+		{
+			data.clear();
+			root = nil();
+		}
+		link nil()const	{		return const_cast<list_type&>( data ).end();	}
+		iterator to_iterator( link p )const	{		return p;	}
+		link to_link( const_iterator p )const	{		return const_cast<list_type&>( data ).erase( p, p );	}//const_iterator->iterator
+		//new node as child[dir] of parent, list stays in key order
+		link emplace( link parent, bool dir, const key_type& val )
+		{
+			if( parent == nil() )
+				return data.emplace( data.end(), nil(), val );
+			auto me = data.emplace( dir ? std::next( parent ) : parent, nil(), val );
+			me->parent = parent;
+			return me;
+		}
+		void erase( link p )	{		data.erase( p );	}
 
+		link& parent( link p )const				{		return p->parent;	}
+		link& child( link p, bool dir )const	{		return p->child[dir];	}
+		key_type& key( link p )const			{		return p->key;	}
+		unsigned int tot( link p )const			{		return p->tot;	}
+		void set_tot( link p, unsigned int val )const	{		p->tot = val;	}
+		tColor color( link p )const				{		return p->color;	}
+		void set_color( link p, tColor c )const	{		p->color = c;	}
+	};
+	class SlabStorage
+	{
 	public:
-		friend class RBtree;
-		Node()
-		{}
-		Node( iterator end, const key_type& val ) :parent( end ), child{ end,end }, key( val )
-		{}
-		const key_type& get()const noexcept
+		using link = std::uint32_t;
+		static constexpr link kNil = std::numeric_limits<link>::max();
+		static constexpr std::uint32_t kRedBit = 1u << 31;
+		class Node
+		{
+		private:
+			link parent = kNil;
+			link child[2] = { kNil,kNil };
+			std::uint32_t tot_color = 1 | kRedBit;//subtree size, top bit is set if red
+			key_type key;
+
+		public:
+			friend class SlabStorage;
+			Node( const key_type& val ) :key( val )
+			{}
+			const key_type& get()const noexcept
+			{
+				return key;
+			}
+		};
+		//in-order, amortized O(1) per step, not invalidated by insert
+		template <bool IsConst>
+		class Iterator
+		{
+		public:
+			using iterator_category = std::bidirectional_iterator_tag;
+			using value_type = Node;
+			using difference_type = std::ptrdiff_t;
+			using pointer = std::conditional_t<IsConst, const Node*, Node*>;
+			using reference = std::conditional_t<IsConst, const Node&, Node&>;
+		private:
+			using storage_pointer = std::conditional_t<IsConst, const SlabStorage*, SlabStorage*>;
+			storage_pointer s = nullptr;
+			link p = kNil;
+
+		public:
+			friend class SlabStorage;
+			Iterator()
+			{}
+			Iterator( storage_pointer s, link p ) :s( s ), p( p )
+			{}
+			operator Iterator<true>()const requires( !IsConst )	{		return Iterator<true>( s, p );	}
+			reference operator*()const	{		return s->slab[p];	}
+			pointer operator->()const	{		return &s->slab[p];	}
+			Iterator& operator++()
+			{
+				p = s->next( p );
+				return *this;
+			}
+			Iterator operator++( int )
+			{
+				auto tmp = *this;
+				++*this;
+				return tmp;
+			}
+			Iterator& operator--()
+			{
+				p = s->prev( p );
+				return *this;
+			}
+			Iterator operator--( int )
+			{
+				auto tmp = *this;
+				--*this;
+				return tmp;
+			}
+			bool operator==( const Iterator& other )const	{		return p == other.p;	}
+		};
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+	private:
+		using slab_allocator_type = std::allocator_traits<allocator_type>::template rebind_alloc<Node>;
+		std::vector<Node, slab_allocator_type> slab;
+		link free_head = kNil;//free node is chained by child[0]
+		std::size_t n = 0;
+	public:
+		link root = kNil;
+
+		iterator begin()			{		return iterator( this, root == kNil ? kNil : extreme( root, 0 ) );	}
+		iterator end()				{		return iterator( this, kNil );	}
+		const_iterator begin()const	{		return const_iterator( this, root == kNil ? kNil : extreme( root, 0 ) );	}
+		const_iterator end()const	{		return const_iterator( this, kNil );	}
+		std::size_t size()const noexcept	{		return n;	}
+		void clear()
+		{
+			slab.clear();
+			free_head = kNil;
+			n = 0;
+			root = kNil;
+		}
+		link nil()const	{		return kNil;	}
+		iterator to_iterator( link p )				{		return iterator( this, p );	}
+		const_iterator to_iterator( link p )const	{		return const_iterator( this, p );	}
+		link to_link( const_iterator p )const	{		return p.p;	}
+		//new node as child[dir] of parent, reuse free node first
+		link emplace( link parent, bool dir, const key_type& val )
+		{
+			link me = free_head;
+			if( me != kNil )
+			{
+				free_head = slab[me].child[0];
+				slab[me] = Node( val );
+			}
+			else
+			{
+				assert( slab.size() < kRedBit );
+				me = (link)slab.size();
+				slab.emplace_back( val );
+			}
+			slab[me].parent = parent;
+			++n;
+			return me;
+		}
+		void erase( link p )
+		{
+			slab[p].child[0] = free_head;
+			free_head = p;
+			--n;
+		}
+
+		link& parent( link p )					{		return slab[p].parent;	}
+		link parent( link p )const				{		return slab[p].parent;	}
+		link& child( link p, bool dir )			{		return slab[p].child[dir];	}
+		link child( link p, bool dir )const		{		return slab[p].child[dir];	}
+		key_type& key( link p )					{		return slab[p].key;	}
+		const key_type& key( link p )const		{		return slab[p].key;	}
+		unsigned int tot( link p )const			{		return slab[p].tot_color & ~kRedBit;	}
+		void set_tot( link p, unsigned int val )	{		slab[p].tot_color = ( slab[p].tot_color & kRedBit ) | val;	}
+		tColor color( link p )const				{		return ( slab[p].tot_color & kRedBit ) ? tColor::kRed : tColor::kBlack;	}
+		void set_color( link p, tColor c )
+		{
+			slab[p].tot_color = c == tColor::kRed ? slab[p].tot_color | kRedBit : slab[p].tot_color & ~kRedBit;
+		}
+
+	private:
+		//leftmost (dir=0) or rightmost (dir=1) node of subtree
+		link extreme( link p, bool dir )const
 		{
-			return key;
+			while( slab[p].child[dir] != kNil )
+				p = slab[p].child[dir];
+			return p;
 		}
+		//in-order neighbor, dir=1 for next
+		link step( link p, bool dir )const
+		{
+			if( slab[p].child[dir] != kNil )
+				return extreme( slab[p].child[dir], !dir );
+			link parent = slab[p].parent;
+			while( parent != kNil && slab[parent].child[dir] == p )
+			{
+				p = parent;
+				parent = slab[p].parent;
+			}
+			return parent;
+		}
+		link next( link p )const	{		return step( p, 1 );	}
+		link prev( link p )const	{		return p == kNil ? extreme( root, 1 ) : step( p, 0 );	}
 	};
-	list_type data;
-	iterator root;
+	using storage_type = std::conditional_t<Storage == RBtreeStorage::kSlab, SlabStorage, ListStorage>;
+	using link = typename storage_type::link;
+public:
+	using iterator = typename storage_type::iterator;
+	using const_iterator = typename storage_type::const_iterator;
+
+private:
+	storage_type data;
 
 public:
 	RBtree()
-	{
-		root = data.end();
-	}
+	{}
 	~RBtree()
 	{}
 	iterator begin()			{		return data.begin();	}
 	iterator end()				{		return data.end();	}
-	const_iterator begin()const	{		return data.cbegin();	}
-	const_iterator end()const	{		return data.cend();	}
+	const_iterator begin()const	{		return data.begin();	}
+	const_iterator end()const	{		return data.end();	}
 	std::size_t size()const noexcept	{		return data.size();	}
-	bool empty()const noexcept	{		return data.empty();	}
+	bool empty()const noexcept	{		return data.size() == 0;	}
 	void clear()
 	{
 		data.clear();
-		root = data.end();
 	}
-	int get_rank( const_iterator me )const
+	int get_rank( const_iterator it )const
 	{
-		assert( me != data.end() );
-		int rank = me->child[0] == data.end() ? 1 : me->child[0]->tot + 1;
-		while( me != root )
+		assert( it != end() );
+		link me = data.to_link( it );
+		int rank = data.child( me, 0 ) == nil() ? 1 : data.tot( data.child( me, 0 ) ) + 1;
+		while( me != data.root )
 		{
-			auto parent = me->parent;
-			assert( parent != data.end() );
-			if( parent->child[1] == me )
-				rank += parent->child[0] == data.end() ? 1 : 1 + parent->child[0]->tot;
+			auto parent = data.parent( me );
+			assert( parent != nil() );
+			if( data.child( parent, 1 ) == me )
+				rank += data.child( parent, 0 ) == nil() ? 1 : 1 + data.tot( data.child( parent, 0 ) );
 			me = parent;
 		}
 		return rank;
@@ -86,119 +301,85 @@ public:
 	//1-n
 	iterator find_rank( int rank )
 	{
-		if( rank<1 || rank>(int)data.size() || root == end() )
+		if( rank<1 || rank>(int)size() || data.root == nil() )
 			return end();
-		return find_rank( root, rank );
+		return data.to_iterator( find_rank( data.root, rank ) );
 	}
 	//1-n
 	const_iterator find_rank( int rank )const
 	{
-		if( rank<1 || rank>( int )data.size() || root == end() )
+		if( rank<1 || rank>( int )size() || data.root == nil() )
 			return end();
-		return find_rank( root, rank );
+		return data.to_iterator( find_rank( data.root, rank ) );
 	}
 	const_iterator lower_bound( const key_type& val )const
 	{
-		auto [it, flag] = lower_bound( root, val );
-		return flag ? it : end();
+		auto [it, flag] = lower_bound( data.root, val );
+		return flag ? data.to_iterator( it ) : end();
 	}
 	iterator lower_bound( const key_type& val )
 	{
-		auto [it, flag] = lower_bound( root, val );
-		return flag ? it : end();
+		auto [it, flag] = lower_bound( data.root, val );
+		return flag ? data.to_iterator( it ) : end();
 	}
 	const_iterator find( const key_type& val )const
 	{
-		if( root == data.end() )
-			return data.end();
-		auto [it, flag] = find( root, val );
-		return flag == -1 ? it : data.end();
+		if( data.root == nil() )
+			return end();
+		auto [it, flag] = find( data.root, val );
+		return flag == -1 ? data.to_iterator( it ) : end();
 	}
 	iterator find( const key_type& val )
 	{
-		if( root == data.end() )
-			return data.end();
-		auto [it, flag] = find( root, val );
-		return flag == -1 ? it : data.end();
+		if( data.root == nil() )
+			return end();
+		auto [it, flag] = find( data.root, val );
+		return flag == -1 ? data.to_iterator( it ) : end();
 	}
 	iterator insert( const key_type& val )
 	{
-		if( root == data.end() )
+		if( data.root == nil() )
 		{
-			data.emplace_back( data.end(), val );
-			root = data.begin();
-			return root;//default tot = 1
+			data.root = data.emplace( nil(), false, val );
+			return data.to_iterator( data.root );//default tot = 1
 		}
 		else
 		{
-			auto [me, flag] = find( root, val );
+			auto [me, flag] = find( data.root, val );
 			if( flag == -1 )//exist
-				return me;
+				return data.to_iterator( me );
 			auto parent = me;
-			me = data.emplace( flag ? ++me : me, data.end(), val );
+			me = data.emplace( parent, flag, val );
 
-			me->parent = parent;
-			parent->child[flag] = me;
+			data.child( parent, flag ) = me;
 			update( parent, 1 );
 			insert_loop( me );
-			return me;
+			return data.to_iterator( me );
 		}
 	}
 	void erase( const key_type& val )
 	{
-		if( root != data.end() )
+		if( data.root != nil() )
 		{
-			auto [me, flag] = find( root, val );
+			auto [me, flag] = find( data.root, val );
 			if( flag == -1 )
-				erase( me );
+				erase_node( me );
 		}
 	}
-	void erase( iterator pos )
+	void erase( iterator it )
 	{
-		assert( pos != data.end() );
-		if( pos == root && size() == 1 )
-		{
-			clear();
-			return;
-		}
-		//move next to current pos
-		if( pos->child[0] != data.end() && pos->child[1] != data.end() )
-		{
-			auto prev = pos++;
-			assert( pos != data.end() );
-			prev->key = pos->key;
-		}
-		//delete pos with one child (no black)
-		if( pos->child[0] == data.end() && pos->child[1] == data.end() )
-		{
-			auto parent = pos->parent;
-			assert( parent != data.end() );
-			const bool dir = parent->child[1] == pos;//being deleted
-			parent->child[dir] = data.end();
-			auto c = pos->color;
-			data.erase( pos );
-			update( parent, -1 );
-			if( c == tColor::kBlack )//delete red is ok
-				erase_loop( parent, dir );
-		}
-		else
-		{
-			const bool subdir = pos->child[1] != data.end();//only red, delete ok
-			pos->key = pos->child[subdir]->key;
-			data.erase( pos->child[subdir] );
-			pos->child[subdir] = data.end();
-			update( pos, -1 );
-		}
+		assert( it != end() );
+		erase_node( data.to_link( it ) );
 	}
 
 	bool check()const
 	{
-		return check( root ).first;
+		return check( data.root ).first;
 	}
 	std::string print()const
 	{
 		std::stringstream ss;
-		print( root, ss, [&ss] ( const key_type& v )
+		print( data.root, ss, [&ss] ( const key_type& v )
 		{
 			ss << v;
 			return "";
@@ -209,255 +390,296 @@ public:
 	std::string print( const PrintKey f )const
 	{
 		std::stringstream ss;
-		print( root, ss, f );
+		print( data.root, ss, f );
 		return ss.str();
 	}
 
 private:
-	std::pair<iterator, bool> lower_bound( iterator p, const key_type& val )const
+	link nil()const	{		return data.nil();	}
+	void erase_node( link pos )
+	{
+		assert( pos != nil() );
+		if( pos == data.root && size() == 1 )
+		{
+			clear();
+			return;
+		}
+		//move next to current pos
+		if( data.child( pos, 0 ) != nil() && data.child( pos, 1 ) != nil() )
+		{
+			auto prev = pos;
+			pos = data.child( pos, 1 );
+			while( data.child( pos, 0 ) != nil() )
+				pos = data.child( pos, 0 );
+			data.key( prev ) = data.key( pos );
+		}
+		//delete pos with one child (no black)
+		if( data.child( pos, 0 ) == nil() && data.child( pos, 1 ) == nil() )
+		{
+			auto parent = data.parent( pos );
+			assert( parent != nil() );
+			const bool dir = data.child( parent, 1 ) == pos;//being deleted
+			data.child( parent, dir ) = nil();
+			auto c = data.color( pos );
+			data.erase( pos );
+			update( parent, -1 );
+			if( c == tColor::kBlack )//delete red is ok
+				erase_loop( parent, dir );
+		}
+		else
+		{
+			const bool subdir = data.child( pos, 1 ) != nil();//only red, delete ok
+			auto ch = data.child( pos, subdir );
+			data.key( pos ) = data.key( ch );
+			data.erase( ch );
+			data.child( pos, subdir ) = nil();
+			update( pos, -1 );
+		}
+	}
+	std::pair<link, bool> lower_bound( link p, const key_type& val )const
 	{
-		iterator ret;
+		link ret = nil();
 		bool flag = false;
-		while( p != data.end() )
+		while( p != nil() )
 		{
-			if( key_comp()( p->key, val ) )//right
+			if( key_comp()( data.key( p ), val ) )//right
 			{
-				p = p->child[1];
+				p = data.child( p, 1 );
 			}
-			else if( key_comp()( val, p->key ) )//left
+			else if( key_comp()( val, data.key( p ) ) )//left
 			{
 				flag = true;
 				ret = p;
-				p = p->child[0];
+				p = data.child( p, 0 );
 			}
 			else//eq
 				return { p,true };
 		}
 		return { ret,flag };
 	}
-	iterator find_rank( iterator me, int rank )const
+	link find_rank( link me, int rank )const
 	{
 		while( true )
 		{
-			assert( me != data.end() );
-			const int cur = me->child[0] != data.end() ? me->child[0]->tot : 0;
+			assert( me != nil() );
+			const int cur = data.child( me, 0 ) != nil() ? data.tot( data.child( me, 0 ) ) : 0;
 			if( cur >= rank )
-				me = me->child[0];
+				me = data.child( me, 0 );
 			else if( cur + 1 == rank )
 				return me;
 			else
 			{
-				me = me->child[1];
+				me = data.child( me, 1 );
 				rank -= cur + 1;
 			}
 		}
 		assert( 0 );
 	}
 	template <typename Func>
-	void print( iterator me, std::stringstream& ss, const Func func )const
+	void print( link me, std::stringstream& ss, const Func func )const
 	{
-		if( me == data.end() )
+		if( me == nil() )
 			return;
-		ss << func( me->key ) << ' ' << ( me->color == tColor::kBlack ? 'B' : 'R' ) << ' ' << me->tot << ':';
-		for( auto c : me->child )
-			if( c == data.end() )
+		ss << func( data.key( me ) ) << ' ' << ( data.color( me ) == tColor::kBlack ? 'B' : 'R' ) << ' ' << data.tot( me ) << ':';
+		for( int dir = 0; dir < 2; dir++ )
+			if( data.child( me, dir ) == nil() )
 				ss << "NULL ";
 			else
-				ss << func( c->key ) << ' ';
+				ss << func( data.key( data.child( me, dir ) ) ) << ' ';
 		ss << '\n';
-		for( auto c : me->child )
-			print( c, ss, func );
+		for( int dir = 0; dir < 2; dir++ )
+			print( data.child( me, dir ), ss, func );
 	}
 	//<ok,black cnt>
-	std::pair<bool, int> check( const_iterator p )const
+	std::pair<bool, int> check( link p )const
 	{
-		if( p != data.end() )
+		if( p != nil() )
 		{
-			if( p->tot != cnt( p ) )
+			if( data.tot( p ) != cnt( p ) )
 				return { false,0 };
 			//compare
-			if( p->child[0] != data.end() && !key_comp()( p->child[0]->key, p->key ) )
+			if( data.child( p, 0 ) != nil() && !key_comp()( data.key( data.child( p, 0 ) ), data.key( p ) ) )
 				return { false,0 };
-			if( p->child[1] != data.end() && !key_comp()( p->key, p->child[1]->key ) )
+			if( data.child( p, 1 ) != nil() && !key_comp()( data.key( p ), data.key( data.child( p, 1 ) ) ) )
 				return { false,0 };
 			//red-red NG
-			if( p->color == tColor::kRed )
+			if( data.color( p ) == tColor::kRed )
 			{
-				for( auto c : p->child )
-					if( c != data.end() && c->color == p->color )
+				for( int dir = 0; dir < 2; dir++ )
+					if( data.child( p, dir ) != nil() && data.color( data.child( p, dir ) ) == data.color( p ) )
 						return { false,0 };
 			}
 			//same black
-			auto [x1, x2] = check( p->child[0] );
-			auto [y1, y2] = check( p->child[1] );
+			auto [x1, x2] = check( data.child( p, 0 ) );
+			auto [y1, y2] = check( data.child( p, 1 ) );
 			if( !x1 || !y1 || x2 != y2 )
 				return { false,0 };
-			return { true,x2 + ( p->color == tColor::kBlack ) };
+			return { true,x2 + ( data.color( p ) == tColor::kBlack ) };
 		}
 		return { true,0 };
 	}
-	void erase_loop( iterator me, bool dir )
+	void erase_loop( link me, bool dir )
 	{
 		//me->child[dir] is black
-		while( me != data.end() )//case 2
+		while( me != nil() )//case 2
 		{
-			auto ch = me->child[!dir];
-			assert( ch != data.end() );
-			auto inner = ch->child[dir];
-			auto outter = ch->child[!dir];
-			auto c_in = inner == data.end() ? tColor::kBlack : inner->color;
-			auto c_out = outter == data.end() ? tColor::kBlack : outter->color;
+			auto ch = data.child( me, !dir );
+			assert( ch != nil() );
+			auto inner = data.child( ch, dir );
+			auto outter = data.child( ch, !dir );
+			auto c_in = inner == nil() ? tColor::kBlack : data.color( inner );
+			auto c_out = outter == nil() ? tColor::kBlack : data.color( outter );
 			if( c_in == tColor::kBlack && c_out == tColor::kBlack )
 			{
-				if( me->color == tColor::kBlack )
+				if( data.color( me ) == tColor::kBlack )
 				{
-					if( ch->color == tColor::kBlack )//case 1
+					if( data.color( ch ) == tColor::kBlack )//case 1
 					{
-						ch->color = tColor::kRed;
-						auto parent = me->parent;
-						dir = parent != data.end() ? parent->child[1] == me : false;
+						data.set_color( ch, tColor::kRed );
+						auto parent = data.parent( me );
+						dir = parent != nil() ? data.child( parent, 1 ) == me : false;
 						me = parent;
 						continue;
 					}
 					else//case 3
 					{
 						rotate( ch );
-						me->color = tColor::kRed;
-						ch->color = tColor::kBlack;
+						data.set_color( me, tColor::kRed );
+						data.set_color( ch, tColor::kBlack );
 						continue;
 					}
 				}
 				else//case 4
 				{
-					assert( ch->color == tColor::kBlack );
-					me->color = tColor::kBlack;
-					ch->color = tColor::kRed;
+					assert( data.color( ch ) == tColor::kBlack );
+					data.set_color( me, tColor::kBlack );
+					data.set_color( ch, tColor::kRed );
 					break;
 				}
 			}
 			else if( c_in == tColor::kRed )//case 5
 			{
-				assert( ch->color == tColor::kBlack );
-				assert( inner != data.end() );
+				assert( data.color( ch ) == tColor::kBlack );
+				assert( inner != nil() );
 				rotate( inner );
-				inner->color = tColor::kBlack;
-				ch->color = tColor::kRed;
+				data.set_color( inner, tColor::kBlack );
+				data.set_color( ch, tColor::kRed );
 				continue;
 			}
 			else//case 6
 			{
 				rotate( ch );
-				ch->color = me->color;
-				me->color = tColor::kBlack;
-				assert( outter != data.end() );
-				outter->color = tColor::kBlack;
+				data.set_color( ch, data.color( me ) );
+				data.set_color( me, tColor::kBlack );
+				assert( outter != nil() );
+				data.set_color( outter, tColor::kBlack );
 				break;
 			}
 		}
 	}
-	void insert_loop( iterator me )
+	void insert_loop( link me )
 	{
-		assert( me != data.end() );
-		auto parent = me->parent;
+		assert( me != nil() );
+		auto parent = data.parent( me );
 		while( true )
 		{
-			if( parent == data.end() )//case 3
+			if( parent == nil() )//case 3
 				break;
-			if( parent->color == tColor::kBlack )//case 1
+			if( data.color( parent ) == tColor::kBlack )//case 1
 				break;
-			auto grandparent = parent->parent;
+			auto grandparent = data.parent( parent );
 
-			if( grandparent != data.end() )
+			if( grandparent != nil() )
 			{
-				auto uncle = grandparent->child[grandparent->child[0] == parent];
-				if( uncle != data.end() && parent->color == tColor::kRed && uncle->color == tColor::kRed )//case 2
+				auto uncle = data.child( grandparent, data.child( grandparent, 0 ) == parent );
+				if( uncle != nil() && data.color( parent ) == tColor::kRed && data.color( uncle ) == tColor::kRed )//case 2
 				{
-					assert( grandparent->color == tColor::kBlack );
-					parent->color = tColor::kBlack;
-					uncle->color = tColor::kBlack;
-					grandparent->color = tColor::kRed;
+					assert( data.color( grandparent ) == tColor::kBlack );
+					data.set_color( parent, tColor::kBlack );
+					data.set_color( uncle, tColor::kBlack );
+					data.set_color( grandparent, tColor::kRed );
 					me = grandparent;
-					parent = me->parent;
+					parent = data.parent( me );
 					continue;
 				}
 				//uncle is black or empty
-				else if( ( me == parent->child[1] ) != ( grandparent->child[1] == parent ) )//case 5: LR or RL
+				else if( ( me == data.child( parent, 1 ) ) != ( data.child( grandparent, 1 ) == parent ) )//case 5: LR or RL
 				{
 					rotate( me );
 					std::swap( me, parent );
 				}
 				//case 6
 				rotate( parent );
-				parent->color = tColor::kBlack;
-				grandparent->color = tColor::kRed;
+				data.set_color( parent, tColor::kBlack );
+				data.set_color( grandparent, tColor::kRed );
 				break;
 			}
 			else//case 4
 			{
-				assert( parent->color == tColor::kRed );
-				parent->color = tColor::kBlack;
+				assert( data.color( parent ) == tColor::kRed );
+				data.set_color( parent, tColor::kBlack );
 				break;
 			}
 		}
 	}
 	//lift me to parent
-	void rotate( iterator me )
+	void rotate( link me )
 	{
-		assert( me != data.end() );
-		auto parent = me->parent;
-		assert( parent != data.end() );
-		if( root == parent )
-			root = me;
-		const bool dir = me == parent->child[1];
-		parent->child[dir] = me->child[!dir];
-		if( me->child[!dir] != data.end() )
-			me->child[!dir]->parent = parent;
+		assert( me != nil() );
+		auto parent = data.parent( me );
+		assert( parent != nil() );
+		if( data.root == parent )
+			data.root = me;
+		const bool dir = me == data.child( parent, 1 );
+		data.child( parent, dir ) = data.child( me, !dir );
+		if( data.child( me, !dir ) != nil() )
+			data.parent( data.child( me, !dir ) ) = parent;
 
-		me->child[!dir] = parent;
-		auto gp = parent->parent;
-		me->parent = gp;
+		data.child( me, !dir ) = parent;
+		auto gp = data.parent( parent );
+		data.parent( me ) = gp;
 
-		parent->parent = me;
-		if( gp != data.end() )
-			gp->child[gp->child[1] == parent] = me;
+		data.parent( parent ) = me;
+		if( gp != nil() )
+			data.child( gp, data.child( gp, 1 ) == parent ) = me;
 
-		parent->tot = cnt( parent );
-		me->tot = cnt( me );
+		data.set_tot( parent, cnt( parent ) );
+		data.set_tot( me, cnt( me ) );
 	}
 	//<cur,-1> or <parent, 0/1>
-	std::pair<iterator, int> find( iterator p, const key_type& val )const
+	std::pair<link, int> find( link p, const key_type& val )const
 	{
-		assert( p != data.end() );
-		auto parent = p->parent;
+		assert( p != nil() );
+		auto parent = data.parent( p );
 		bool lr = false;
-		while( p != data.end() )
+		while( p != nil() )
 		{
-			if( key_comp()( p->key, val ) )//right
+			if( key_comp()( data.key( p ), val ) )//right
 			{
 				parent = p;
-				p = p->child[lr = 1];
+				p = data.child( p, lr = 1 );
 			}
-			else if( key_comp()( val, p->key ) )//left
+			else if( key_comp()( val, data.key( p ) ) )//left
 			{
 				parent = p;
-				p = p->child[lr = 0];
+				p = data.child( p, lr = 0 );
 			}
 			else//eq
 				return { p,-1 };
 		}
 		return { parent,lr };
 	}
-	unsigned int cnt( const_iterator me )const
+	unsigned int cnt( link me )const
 	{
-		return 1 + ( me->child[0] != data.end() ? me->child[0]->tot : 0 ) + ( me->child[1] != data.end() ? me->child[1]->tot : 0 );
+		return 1 + ( data.child( me, 0 ) != nil() ? data.tot( data.child( me, 0 ) ) : 0 ) + ( data.child( me, 1 ) != nil() ? data.tot( data.child( me, 1 ) ) : 0 );
 	}
 	//from me to root
-	void update( iterator me, const int det )
+	void update( link me, const int det )
 	{
-		while( me != data.end() )
+		while( me != nil() )
 		{
-			me->tot += det;
-			me = me->parent;
+			data.set_tot( me, data.tot( me ) + det );
+			me = data.parent( me );
 		}
 	}
 };
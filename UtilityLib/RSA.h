@@ -38,11 +38,12 @@ public:
 	{
 		return data.PowerMod( d, N );
 	}
-	template<typename RD = std::random_device>
-	void Generate( size_t min_binarybit = 512, RD rd = std::random_device() )
+	//RD generates candidates, Engine (seeded by rd) is used for prime test
+	template<typename RD = std::random_device, typename Engine = RNG>
+	void Generate( size_t min_binarybit = 512, RD rd = RD() )
 	{
 		const size_t n = 1 + min_binarybit / 30;
-		RNG rng( rd() );//Prime test RNG
+		Engine rng( rd() );//Prime test RNG
 		
 		_LongInt p, q;
 		p = GeneratePrime( n, rd, rng );
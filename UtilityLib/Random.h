@@ -0,0 +1,131 @@
+#pragma once
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+
+namespace Util
+{
+//Counter-based pseudorandom number generator Philox4x32-10
+//Reference:Salmon et al., Parallel Random Numbers: As Easy as 1, 2, 3 (SC11)
+//state is <key,counter>, copy is cheap and discard(n) is O(1)
+//counter = <block idx (64bit), stream idx (64bit)>, different streams never overlap
+class Philox4x32
+{
+public:
+	using result_type = std::uint32_t;
+	using counter_type = std::array<std::uint32_t, 4>;
+	using key_type = std::array<std::uint32_t, 2>;
+	static constexpr std::uint64_t default_seed = 20111115u;
+
+private:
+	static constexpr std::uint32_t MUL0 = 0xD2511F53;
+	static constexpr std::uint32_t MUL1 = 0xCD9E8D57;
+	static constexpr std::uint32_t WEYL0 = 0x9E3779B9;
+	static constexpr std::uint32_t WEYL1 = 0xBB67AE85;
+	static constexpr int ROUND = 10;
+
+	key_type m_key = { 0,0 };
+	std::uint64_t m_block = 0;
+	std::uint64_t m_stream = 0;
+	counter_type m_buffer = { 0,0,0,0 };
+	int m_pos = 4;//next output in m_buffer
+
+public:
+	Philox4x32()
+	{
+		seed( default_seed );
+	}
+	explicit Philox4x32( std::uint64_t s, std::uint64_t stream = 0 )
+	{
+		seed( s, stream );
+	}
+	void seed( std::uint64_t s = default_seed, std::uint64_t stream = 0 )noexcept
+	{
+		m_key = { (std::uint32_t)s,(std::uint32_t)( s >> 32 ) };
+		m_stream = stream;
+		m_block = 0;
+		m_pos = 4;
+	}
+
+	static constexpr result_type min()noexcept	{		return std::numeric_limits<result_type>::min();	}
+	static constexpr result_type max()noexcept	{		return std::numeric_limits<result_type>::max();	}
+	result_type operator()()noexcept
+	{
+		if( m_pos == 4 )
+		{
+			m_buffer = Block( MakeCounter( m_block++ ), m_key );
+			m_pos = 0;
+		}
+		return m_buffer[m_pos++];
+	}
+	void discard( unsigned long long n )noexcept
+	{
+		const unsigned long long remain = 4 - m_pos;
+		if( n < remain )
+		{
+			m_pos += (int)n;
+			return;
+		}
+		n -= remain;
+		m_block += n / 4;
+		m_pos = 4;
+		if( n % 4 != 0 )
+		{
+			m_buffer = Block( MakeCounter( m_block++ ), m_key );
+			m_pos = (int)( n % 4 );
+		}
+	}
+	//independent engine for sub task idx, key of children := hash of parent <key,stream>, stream of child := idx
+	//children of the same engine never overlap, children of different engines differ in key (64bit hash, collide w.p. 2^-64)
+	Philox4x32 Split( std::uint64_t idx )const noexcept
+	{
+		const counter_type h = Block( { (std::uint32_t)m_stream,(std::uint32_t)( m_stream >> 32 ),WEYL0,WEYL1 }, m_key );
+		Philox4x32 ret;
+		ret.m_key = { h[0],h[1] };
+		ret.m_stream = idx;
+		return ret;
+	}
+	std::uint64_t GetStream()const noexcept	{		return m_stream;	}
+
+	//one block of 4 outputs
+	static constexpr counter_type Block( counter_type ctr, key_type key )noexcept
+	{
+		for( int i = 0; i < ROUND; i++ )
+		{
+			const std::uint64_t p0 = (std::uint64_t)MUL0 * ctr[0];
+			const std::uint64_t p1 = (std::uint64_t)MUL1 * ctr[2];
+			ctr = { (std::uint32_t)( p1 >> 32 ) ^ ctr[1] ^ key[0], (std::uint32_t)p1,
+				(std::uint32_t)( p0 >> 32 ) ^ ctr[3] ^ key[1], (std::uint32_t)p0 };
+			key[0] += WEYL0;
+			key[1] += WEYL1;
+		}
+		return ctr;
+	}
+
+	friend bool operator==( const Philox4x32& a, const Philox4x32& b )noexcept
+	{
+		return a.m_key == b.m_key && a.m_stream == b.m_stream && a.m_block == b.m_block && a.m_pos == b.m_pos;
+	}
+	friend bool operator!=( const Philox4x32& a, const Philox4x32& b )noexcept
+	{
+		return !( a == b );
+	}
+
+private:
+	counter_type MakeCounter( std::uint64_t block )const noexcept
+	{
+		return { (std::uint32_t)block,(std::uint32_t)( block >> 32 ),(std::uint32_t)m_stream,(std::uint32_t)( m_stream >> 32 ) };
+	}
+};
+
+//independent engine for sub task idx, counter-based engine splits its stream, others are seeded by rng()
+template <typename Engine>
+Engine SplitRNG( Engine& rng, std::uint64_t idx )
+{
+	if constexpr( requires { { rng.Split( idx ) }->std::same_as<Engine>; } )
+		return rng.Split( idx );
+	else
+		return Engine( rng() );
+}
+}
\ No newline at end of file
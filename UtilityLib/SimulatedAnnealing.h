@@ -3,25 +3,28 @@
 #include "CommonDef.h"
 #include "Timer.h"
 #include "Util.h"
+#include "Telemetry.h"
 #include <barrier>
 #include <future>
 
 namespace Util::ORtool
 {
-template <typename Solution, typename Engine>
+template <typename Solution, typename Engine, typename Policy>
 class HillClimb;
-template <typename Solution, typename Engine>
+template <typename Solution, typename Engine, typename Policy>
 class SimulatedAnnealing;
 template <typename T>
-concept simulated_annealing_type = std::is_base_of_v<SimulatedAnnealing<typename T::SolutionType, typename T::RNGType>, T>;
+concept simulated_annealing_type = std::is_base_of_v<SimulatedAnnealing<typename T::SolutionType, typename T::RNGType, typename T::PolicyType>, T>;
 
 //maxmize score
-template <typename Solution, typename Engine = Util::RNG>
+//Policy decides whether UpdateLog/Hook are called, see HookPolicy
+template <typename Solution, typename Engine = Util::RNG, typename Policy = DefaultHookPolicy>
 class SimulatedAnnealing
 {
 public:
 	using SolutionType = Solution;
 	using RNGType = Engine;
+	using PolicyType = Policy;
 
 	enum struct tCoolDownType
 	{
@@ -47,7 +50,14 @@ public:
 		double time_s = 0;
 		double progress = 0;
 		double temperature = 0;
+
+		static const char* CSVHeader()noexcept	{		return "score,best_score,iteration,time_s,progress,temperature";	}
+		void WriteCSV( std::ostream& os )const
+		{
+			os << score << ',' << best_score << ',' << iteration << ',' << time_s << ',' << progress << ',' << temperature;
+		}
 	};
+	using TelemetryType = TelemetryRing<LogInfo>;
 	bool isMaximize = true;
 
 private:
@@ -78,6 +88,9 @@ private:
 	std::int64_t m_max_log_size = 0;
 	std::int64_t m_iteration_per_log = 0;
 	int m_collect_flag = (int)tState::kAcceptSolution | (int)tState::kFinish;
+	std::int64_t m_last_log_iteration = -1;
+	TelemetryType* m_telemetry = nullptr;//log to ring instead of m_logList
+	SampledTimer m_telemetry_time;
 	
 	typedef std::deque<std::pair<double, double>> SampleListType;
 	bool m_is_initialized_T = false;
@@ -86,11 +99,21 @@ private:
 	std::int64_t m_iteration_for_resample = 0;
 	std::int64_t m_last_sample_iteration = 0;
 	SampleListType m_resampleList;
+
+	//fast path, temperature and log(rand) are precomputed in chunk
+	size_t m_chunk_size = 0;//0 := disable
+	std::int64_t m_chunk_begin = 0;
+	std::vector<double> m_T_chunk;
+	mutable std::vector<double> m_log_rand;
+	mutable size_t m_log_rand_pos = 0;
+	mutable std::int64_t m_next_time_check = 0;//fast path reads the clock once per chunk
+	mutable bool m_is_timeout = false;
 protected:
 	mutable Engine rng;
 
 public:
-	friend class HillClimb<Solution, Engine>;
+	template <typename, typename, typename>
+	friend class HillClimb;
 	friend class ParallelTempering;
 
 	decltype( m_max_iteration ) GetMaxIteration()const noexcept	{		return m_max_iteration;	}
@@ -102,7 +125,13 @@ public:
 	void ConfigResample( int n, double p0 = 0.9 )noexcept	{		m_cnt_recalcT = n; m_p0 = p0;	}
 	void Config( double timelimit_s, std::int64_t max_iteration, bool progress_calc_from_iteration = true, size_t sample_size = 300 )noexcept;
 	void SetTmaxTmin( double t_max, double t_min, bool auto_estimate = false )noexcept;
-	void SetTemperatureCalcType( const tCoolDownType val )noexcept	{		m_temperature_calc_type = val;	}
+	void SetTemperatureCalcType( const tCoolDownType val )noexcept	{		m_temperature_calc_type = val; m_T_chunk.clear();	}
+	//precompute temperature of chunk_size iterations and accept by T*log(rand)<=diff instead of rand<=exp(diff/T), 0 := disable
+	//progress (and T) is updated once per chunk if progress is calculated from time, time limit is checked once per chunk
+	void ConfigFastPath( size_t chunk_size = 64 )noexcept	{		m_chunk_size = chunk_size; m_T_chunk.clear(); m_log_rand.clear();	}
+	//push log into preallocated ring (drained by TelemetryExporter) instead of m_logList, nullptr := disable
+	//time_s is sampled once every time_sample_gap logs
+	void ConfigTelemetry( TelemetryType* ring, std::uint32_t time_sample_gap = 64 )noexcept	{		m_telemetry = ring; m_telemetry_time.SetGap( time_sample_gap );	}
 	
 	double GetMinTemperature()const noexcept    {        return T_min;    }
 	double GetMaxTemperature()const noexcept    {        return T_max;    }
@@ -121,7 +150,7 @@ public:
 	void EvaluateStep()
 	{
 		//calc T
-		std::tie( m_progress, m_cur_T ) = CalcTemperature( m_temperature_calc_type );
+		std::tie( m_progress, m_cur_T ) = NextTemperature();
 		Neighbor( m_current );
 		m_nxt_score = CalcScore( m_current );
 		DefaultHook( tState::kNeighbor );
@@ -171,8 +200,10 @@ protected:
 
 	void DefaultHook( const tState state )
 	{
-		UpdateLog( state );
-		Hook( state );
+		if constexpr( Policy::enable_log )
+			UpdateLog( state );
+		if constexpr( Policy::enable_hook )
+			Hook( state );
 	}
 	void UpdateLog( const tState state );
 	double GetNextScore()const noexcept	{		return m_nxt_score;	}
@@ -180,7 +211,18 @@ protected:
 
 	void Initialize();
 	bool Accept( const double old_score, const double new_score, const double temperature )const;
-	bool Terminate()const	{		return global_time.GetTime() > m_timelimit_s || m_iteration >= m_max_iteration;	}
+	bool Terminate()const
+	{
+		if( m_iteration >= m_max_iteration || m_is_timeout )
+			return true;
+		if( m_chunk_size > 0 )
+		{
+			if( m_iteration < m_next_time_check )
+				return false;
+			m_next_time_check = m_iteration + (std::int64_t)m_chunk_size;
+		}
+		return m_is_timeout = global_time.GetTime() > m_timelimit_s;
+	}
 	
 	//Reference:https://se.mathworks.com/matlabcentral/answers/uploaded_files/14677/B:COAP.0000044187.23143.bd.pdf
 	//<Score_min,Score_max>, p0 is accept prob, it says that p=1 is ok for most case
@@ -193,11 +235,15 @@ private:
 
 	//<progress ratio,T>
 	std::tuple<double, double> CalcTemperature( const tCoolDownType type )const;
+	//<progress ratio,T> of current iteration, from chunk if fast path is enabled
+	std::tuple<double, double> NextTemperature();
+	void FillTemperatureChunk();
+	double NextLogRand()const;
 };
 
 //Record information after each state (or finish) iff iteration changes >= m_max_iteration/max_log_size
-template<typename Solution, typename Engine>
-inline void SimulatedAnnealing<Solution, Engine>::ConfigLog( std::int64_t max_log_size, int flag ) noexcept
+template<typename Solution, typename Engine, typename Policy>
+inline void SimulatedAnnealing<Solution, Engine, Policy>::ConfigLog( std::int64_t max_log_size, int flag ) noexcept
 {
 	m_max_log_size = max_log_size;
 	m_collect_flag = flag;
@@ -209,25 +255,27 @@ inline void SimulatedAnnealing<Solution, Engine>::ConfigLog( std::int64_t max_lo
 	}
 }
 
-template<typename Solution, typename Engine>
-inline void SimulatedAnnealing<Solution, Engine>::Config( double timelimit_s, std::int64_t max_iteration, bool progress_calc_from_iteration, size_t sample_size ) noexcept
+template<typename Solution, typename Engine, typename Policy>
+inline void SimulatedAnnealing<Solution, Engine, Policy>::Config( double timelimit_s, std::int64_t max_iteration, bool progress_calc_from_iteration, size_t sample_size ) noexcept
 {
 	m_timelimit_s = timelimit_s;
 	m_max_iteration = max_iteration;
 	m_progress_calc_from_iteration = progress_calc_from_iteration;
 	m_sample_size = sample_size;
+	m_T_chunk.clear();
 }
 
-template<typename Solution, typename Engine>
-inline void SimulatedAnnealing<Solution, Engine>::SetTmaxTmin( double t_max, double t_min, bool auto_estimate ) noexcept
+template<typename Solution, typename Engine, typename Policy>
+inline void SimulatedAnnealing<Solution, Engine, Policy>::SetTmaxTmin( double t_max, double t_min, bool auto_estimate ) noexcept
 {
 	T_max = t_max;
 	T_min = t_min;
 	m_auto_estimate_T = auto_estimate;
+	m_T_chunk.clear();
 }
 
-template<typename Solution, typename Engine>
-inline bool SimulatedAnnealing<Solution, Engine>::Execute( unsigned int seed )
+template<typename Solution, typename Engine, typename Policy>
+inline bool SimulatedAnnealing<Solution, Engine, Policy>::Execute( unsigned int seed )
 {
 	using namespace Util;
 	RELEASE_VER_TRY;
@@ -257,8 +305,8 @@ inline bool SimulatedAnnealing<Solution, Engine>::Execute( unsigned int seed )
 //ParallelNeighbor(...) and ParallelCalcScore(...) must be parallel executable
 //tState::kNeighbor won't update cursolution (todo)
 //no rollback
-template<typename Solution, typename Engine>
-inline bool SimulatedAnnealing<Solution, Engine>::ParallelExecute( const int n_thread, unsigned int seed )
+template<typename Solution, typename Engine, typename Policy>
+inline bool SimulatedAnnealing<Solution, Engine, Policy>::ParallelExecute( const int n_thread, unsigned int seed )
 {
 	if( n_thread < 1 )
 		return false;
@@ -276,7 +324,7 @@ inline bool SimulatedAnnealing<Solution, Engine>::ParallelExecute( const int n_t
 	for( int idx = 0; auto & e : solQ )
 	{
 		e.idx = idx++;
-		e.rng = RNGType( rng() );
+		e.rng = SplitRNG( rng, e.idx );
 	}
 	Initialize();
 	DefaultHook( tState::kInit );
@@ -289,7 +337,7 @@ inline bool SimulatedAnnealing<Solution, Engine>::ParallelExecute( const int n_t
 			return this->isBetter( a.score, b.score );
 		} );
 
-		std::tie( m_progress, m_cur_T ) = CalcTemperature( m_temperature_calc_type );
+		std::tie( m_progress, m_cur_T ) = NextTemperature();
 		//m_current = sol;
 		m_nxt_score = best->score;
 		DefaultHook( tState::kNeighbor );
@@ -327,8 +375,8 @@ inline bool SimulatedAnnealing<Solution, Engine>::ParallelExecute( const int n_t
 	return true;
 }
 
-template<typename Solution, typename Engine>
-inline void SimulatedAnnealing<Solution, Engine>::ResampleUpdate()
+template<typename Solution, typename Engine, typename Policy>
+inline void SimulatedAnnealing<Solution, Engine, Policy>::ResampleUpdate()
 {
 	if( ( m_cnt_recalcT > 0 || !m_is_initialized_T ) && isBetter( m_score, m_nxt_score ) )
 	{
@@ -351,8 +399,8 @@ inline void SimulatedAnnealing<Solution, Engine>::ResampleUpdate()
 	}
 }
 
-template<typename Solution, typename Engine>
-inline void SimulatedAnnealing<Solution, Engine>::UpdateStep()
+template<typename Solution, typename Engine, typename Policy>
+inline void SimulatedAnnealing<Solution, Engine, Policy>::UpdateStep()
 {
 	if( Accept( m_score, m_nxt_score, m_cur_T ) )
 	{
@@ -378,25 +426,33 @@ inline void SimulatedAnnealing<Solution, Engine>::UpdateStep()
 	++m_iteration;
 }
 
-template<typename Solution, typename Engine>
-inline void SimulatedAnnealing<Solution, Engine>::UpdateLog( const tState state )
+template<typename Solution, typename Engine, typename Policy>
+inline void SimulatedAnnealing<Solution, Engine, Policy>::UpdateLog( const tState state )
 {
-	if( m_max_log_size > 0 && ( (int)state & m_collect_flag ) != 0
-		&& ( state == tState::kFinish || m_logList.empty() || m_logList.back().iteration + m_iteration_per_log <= m_iteration ) )
+	if( ( m_max_log_size > 0 || m_telemetry ) && ( (int)state & m_collect_flag ) != 0
+		&& ( state == tState::kFinish || m_last_log_iteration < 0 || m_last_log_iteration + m_iteration_per_log <= m_iteration ) )
 	{
-		m_logList.emplace_back( GetCurrScore(), GetScore(), GetIteration(), global_time.GetTime(), GetProgress(), GetCurrTemperature() );
+		m_last_log_iteration = m_iteration;
+		if( m_telemetry )
+			m_telemetry->Push( LogInfo{ GetCurrScore(), GetScore(), GetIteration(), m_telemetry_time.GetTime(), GetProgress(), GetCurrTemperature() } );
+		else
+			m_logList.emplace_back( GetCurrScore(), GetScore(), GetIteration(), global_time.GetTime(), GetProgress(), GetCurrTemperature() );
 	}
 }
 
-template<typename Solution, typename Engine>
-void SimulatedAnnealing<Solution, Engine>::Initialize()
+template<typename Solution, typename Engine, typename Policy>
+void SimulatedAnnealing<Solution, Engine, Policy>::Initialize()
 {
 	using namespace Util;
 	global_time.SetTime();
+	m_telemetry_time.SetTime();
 	m_logList.clear();
+	m_last_log_iteration = -1;
 	m_last_sample_iteration = 0;
 	m_resampleList.clear();
 	m_iteration = 0;
+	m_next_time_check = 0;
+	m_is_timeout = false;
 	m_is_initialized_T = !m_auto_estimate_T;
 	if( m_cnt_recalcT > 0 )
 		m_iteration_for_resample = std::max( 1LL, m_max_iteration / m_cnt_recalcT );
@@ -406,14 +462,16 @@ void SimulatedAnnealing<Solution, Engine>::Initialize()
 		InitializeSolution( m_current );
 		T_max = 1e60;
 	}
+	m_T_chunk.clear();
+	m_log_rand.clear();
 
 	InitializeSolution( m_current );
 	m_opt_score = m_score = CalcScore( m_current );
 	opt_solution = m_current;
 }
 
-template<typename Solution, typename Engine>
-bool SimulatedAnnealing<Solution, Engine>::Accept( const double old_score, const double new_score, const double temperature ) const
+template<typename Solution, typename Engine, typename Policy>
+bool SimulatedAnnealing<Solution, Engine, Policy>::Accept( const double old_score, const double new_score, const double temperature ) const
 {
 	if( !m_is_initialized_T )
 		return true;
@@ -427,6 +485,9 @@ bool SimulatedAnnealing<Solution, Engine>::Accept( const double old_score, const
 		return true;
 
 	assert( GE( temperature, 0 ) );
+	//rand<=exp(diff/T) <=> T*log(rand)<=diff
+	if( m_chunk_size > 0 )
+		return LE( ( temperature + 1e-8 ) * NextLogRand(), diff );
 	diff *= 1.0 / ( temperature + 1e-8 );
 	assert( !isnan( std::exp( diff ) ) );
 
@@ -439,8 +500,8 @@ bool SimulatedAnnealing<Solution, Engine>::Accept( const double old_score, const
 //Reference:https://se.mathworks.com/matlabcentral/answers/uploaded_files/14677/B:COAP.0000044187.23143.bd.pdf
 //<Score_min,Score_max>, p0 is accept prob, it says that p=1 is ok for most case
 //calc the max/min with only worser solution
-template<typename Solution, typename Engine>
-std::optional<double> SimulatedAnnealing<Solution, Engine>::EstimateTemperature( const SampleListType& sample, const double p0, const int p, const int MAX_ITERATION )
+template<typename Solution, typename Engine, typename Policy>
+std::optional<double> SimulatedAnnealing<Solution, Engine, Policy>::EstimateTemperature( const SampleListType& sample, const double p0, const int p, const int MAX_ITERATION )
 {
 	using namespace Util;
 	if( sample.empty() )
@@ -483,8 +544,8 @@ std::optional<double> SimulatedAnnealing<Solution, Engine>::EstimateTemperature(
 }
 
 //n_try until find worse solution
-template<typename Solution, typename Engine>
-inline SimulatedAnnealing<Solution, Engine>::SampleListType SimulatedAnnealing<Solution, Engine>::GenerateSample( Solution start, const size_t sample_size, const int n_try )
+template<typename Solution, typename Engine, typename Policy>
+inline SimulatedAnnealing<Solution, Engine, Policy>::SampleListType SimulatedAnnealing<Solution, Engine, Policy>::GenerateSample( Solution start, const size_t sample_size, const int n_try )
 {
 	using namespace Util;
 
@@ -511,8 +572,8 @@ inline SimulatedAnnealing<Solution, Engine>::SampleListType SimulatedAnnealing<S
 }
 
 //<progress ratio,T>
-template<typename Solution, typename Engine>
-inline std::tuple<double, double> SimulatedAnnealing<Solution, Engine>::CalcTemperature( const tCoolDownType type ) const
+template<typename Solution, typename Engine, typename Policy>
+inline std::tuple<double, double> SimulatedAnnealing<Solution, Engine, Policy>::CalcTemperature( const tCoolDownType type ) const
 {
 	double complete_rate;
 	if( m_progress_calc_from_iteration )
@@ -538,4 +599,73 @@ inline std::tuple<double, double> SimulatedAnnealing<Solution, Engine>::CalcTemp
 	}
 	return { complete_rate,val };
 }
+
+//<progress ratio,T> of current iteration, from chunk if fast path is enabled
+template<typename Solution, typename Engine, typename Policy>
+inline std::tuple<double, double> SimulatedAnnealing<Solution, Engine, Policy>::NextTemperature()
+{
+	if( m_chunk_size == 0 )
+		return CalcTemperature( m_temperature_calc_type );
+	if( m_iteration < m_chunk_begin || m_iteration >= m_chunk_begin + (std::int64_t)m_T_chunk.size() )
+		FillTemperatureChunk();
+	double complete_rate = m_progress;
+	if( m_progress_calc_from_iteration )
+		complete_rate = m_iteration / static_cast<double>( m_max_iteration );
+	return { complete_rate,m_T_chunk[m_iteration - m_chunk_begin] };
+}
+
+//T(i+1)=T(i)*step for exponential, one pow per chunk
+template<typename Solution, typename Engine, typename Policy>
+inline void SimulatedAnnealing<Solution, Engine, Policy>::FillTemperatureChunk()
+{
+	const size_t n = m_chunk_size;
+	m_chunk_begin = m_iteration;
+	m_T_chunk.resize( n );
+	if( !m_progress_calc_from_iteration )
+	{
+		//time is sampled once per chunk
+		std::tie( m_progress, m_T_chunk[0] ) = CalcTemperature( m_temperature_calc_type );
+		std::fill( m_T_chunk.begin() + 1, m_T_chunk.end(), m_T_chunk[0] );
+		return;
+	}
+	const double inv = 1.0 / static_cast<double>( m_max_iteration );
+	switch( m_temperature_calc_type )
+	{
+	case tCoolDownType::kLinear:
+		for( size_t i = 0; i < n; i++ )
+			m_T_chunk[i] = T_max * ( 1 - ( m_chunk_begin + (std::int64_t)i ) * inv );
+		break;
+	case tCoolDownType::kExponential:
+	{
+		const double decayRate = T_min / T_max;
+		const double step = std::pow( decayRate, inv );
+		double val = T_max * std::pow( decayRate, m_chunk_begin * inv );
+		for( size_t i = 0; i < n; i++, val *= step )
+			m_T_chunk[i] = val;
+		break;
+	}
+	default:
+		std::fill( m_T_chunk.begin(), m_T_chunk.end(), 1e20 );
+		break;
+	}
+}
+
+//log(rand) is generated in batch of chunk_size, rand is drawn one by one (engine is sequential), then log runs in a separate loop
+template<typename Solution, typename Engine, typename Policy>
+inline double SimulatedAnnealing<Solution, Engine, Policy>::NextLogRand() const
+{
+	if( m_log_rand_pos >= m_log_rand.size() )
+	{
+		const size_t n = m_chunk_size;
+		m_log_rand.resize( n );
+		std::uniform_real_distribution<double> rand_real_01( 0.0, 1.0 );
+		for( auto& e : m_log_rand )
+			e = rand_real_01( rng );
+		double* p = m_log_rand.data();
+		for( size_t i = 0; i < n; i++ )
+			p[i] = std::log( p[i] );
+		m_log_rand_pos = 0;
+	}
+	return m_log_rand[m_log_rand_pos++];
+}
 }
\ No newline at end of file
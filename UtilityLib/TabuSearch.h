@@ -0,0 +1,346 @@
+#pragma once
+#include "pch.h"
+#include "CommonDef.h"
+#include "Timer.h"
+#include "Util.h"
+#include "Telemetry.h"
+#include <atomic>
+#include <barrier>
+#include <future>
+
+namespace Util::ORtool
+{
+//maxmize score (default)
+//neighborhood of sol is indexed by move in [0,NeighborhoodSize(sol)), each move has an attribute which becomes tabu after applied
+//EvaluateMove(...) must be parallel executable, the default one calls ApplyMove(...) on a copy
+template <typename Solution, typename Engine = Util::RNG, typename Policy = DefaultHookPolicy>
+class TabuSearch
+{
+public:
+	using SolutionType = Solution;
+	using RNGType = Engine;
+	using PolicyType = Policy;
+
+	enum struct tState
+	{
+		kInit = 1,
+		kMove = 2,
+		kUpdateSolution = 4,
+		kAspiration = 8,
+		kFinish = 16,
+		kUndefinded = 32,
+	};
+	struct LogInfo
+	{
+		double score = 0;
+		double best_score = 0;
+		std::int64_t iteration = 0;
+		double time_s = 0;
+		double progress = 0;
+		int n_tabu = 0;//number of tabu candidates in this iteration
+
+		static const char* CSVHeader()noexcept	{		return "score,best_score,iteration,time_s,progress,n_tabu";	}
+		void WriteCSV( std::ostream& os )const
+		{
+			os << score << ',' << best_score << ',' << iteration << ',' << time_s << ',' << progress << ',' << n_tabu;
+		}
+	};
+	using TelemetryType = TelemetryRing<LogInfo>;
+	bool isMaximize = true;
+
+private:
+	struct Candidate
+	{
+		size_t move = 0;
+		std::uint64_t attribute = 0;
+		double score = 0;
+	};
+
+	Timer global_time;
+	std::int64_t m_iteration = 0;
+	double m_timelimit_s = 1;//second
+	std::int64_t m_max_iteration = 100;
+
+	Solution opt_solution;
+	double m_opt_score = 0;
+	Solution m_current;
+	double m_score = 0;
+	int m_n_tabu = 0;
+
+	int m_tenure = 7;
+	int m_tenure_random = 0;//real tenure is in [tenure,tenure+tenure_random]
+	size_t m_sample_size = 0;//0 := full neighborhood
+	double m_frequency_penalty = 0;//0 := no diversification
+
+	//hashed attribute memory, collision only makes a move tabu by mistake
+	std::vector<std::int64_t> m_tabu_until;
+	std::vector<std::int64_t> m_frequency;
+	std::uint64_t m_table_mask = 0;
+
+	std::deque<LogInfo> m_logList;
+	std::int64_t m_max_log_size = 0;
+	std::int64_t m_iteration_per_log = 0;
+	int m_collect_flag = (int)tState::kUpdateSolution | (int)tState::kFinish;
+	std::int64_t m_last_log_iteration = -1;
+	TelemetryType* m_telemetry = nullptr;//log to ring instead of m_logList
+	SampledTimer m_telemetry_time;
+
+protected:
+	mutable Engine rng;
+
+public:
+	decltype( m_max_iteration ) GetMaxIteration()const noexcept	{		return m_max_iteration;	}
+	double GetTimeLimit()const noexcept	{		return m_timelimit_s;	}
+
+	void Config( double timelimit_s, std::int64_t max_iteration )noexcept	{		m_timelimit_s = timelimit_s; m_max_iteration = max_iteration;	}
+	//size of tabu table is 2^table_bit
+	void ConfigTabu( int tenure, int tenure_random = 0, int table_bit = 16 );
+	//evaluate sample_size random moves per iteration, 0 := full neighborhood
+	void ConfigNeighborhood( size_t sample_size )noexcept	{		m_sample_size = sample_size;	}
+	//long-term memory, score of move is penalized by penalty*(frequency of attribute)/iteration
+	void ConfigDiversification( double penalty )noexcept	{		m_frequency_penalty = penalty;	}
+	//Record information after each state (or finish) iff iteration changes >= m_max_iteration/max_log_size
+	void ConfigLog( std::int64_t max_log_size = 0, int flag = (int)tState::kUpdateSolution | (int)tState::kFinish ) noexcept;
+	//push log into preallocated ring (drained by TelemetryExporter) instead of m_logList, nullptr := disable
+	//time_s is sampled once every time_sample_gap logs
+	void ConfigTelemetry( TelemetryType* ring, std::uint32_t time_sample_gap = 64 )noexcept	{		m_telemetry = ring; m_telemetry_time.SetGap( time_sample_gap );	}
+
+	const Solution& GetSolution()const noexcept	{		return opt_solution;	}
+	double GetScore()const noexcept	{		return m_opt_score;	}
+	decltype( rng )& GetRNG()const noexcept	{		return rng;	}
+	const decltype( m_logList )& GetLogList()const noexcept	{		return m_logList;	}
+	double GetElapsedTime()const	{		return global_time.GetTime();	}
+	decltype( m_iteration )GetIteration()const noexcept	{		return m_iteration;	}
+	std::int64_t GetFrequency( std::uint64_t attribute )const	{		return m_frequency.empty() ? 0 : m_frequency[Slot( attribute )];	}
+	bool IsTabu( std::uint64_t attribute )const	{		return !m_tabu_until.empty() && m_tabu_until[Slot( attribute )] > m_iteration;	}
+
+	bool Execute( unsigned int seed = 0 )	{		return ParallelExecute( 1, seed );	}
+	bool ParallelExecute( const int n_thread, unsigned int seed = 0 );
+
+protected:
+	virtual void InitializeSolution( SolutionType& sol ) = 0;
+	virtual double CalcScore( const SolutionType& sol )const = 0;
+	virtual size_t NeighborhoodSize( const SolutionType& sol )const = 0;
+	virtual std::uint64_t MoveAttribute( const SolutionType& sol, size_t move )const = 0;
+	virtual void ApplyMove( SolutionType& sol, size_t move ) = 0;
+	//score of sol after move, override it with delta evaluation if possible
+	virtual double EvaluateMove( int thread_idx, const SolutionType& sol, size_t move )
+	{
+		SolutionType tmp = sol;
+		ApplyMove( tmp, move );
+		return CalcScore( tmp );
+	}
+	virtual void Hook( const tState state )	{}
+
+	double GetProgress()const	{		return std::max( global_time.GetTime() / m_timelimit_s, m_iteration / static_cast<double>( m_max_iteration ) );	}
+	const Solution& GetCurrSolution()const noexcept	{		return m_current;	}
+	double GetCurrScore()const noexcept	{		return m_score;	}
+
+	void DefaultHook( const tState state )
+	{
+		if constexpr( Policy::enable_log )
+			UpdateLog( state );
+		if constexpr( Policy::enable_hook )
+			Hook( state );
+	}
+	void UpdateLog( const tState state );
+	bool isBetter( const double nxt_score, const double old_score )const noexcept	{		return isMaximize ? GT( nxt_score, old_score ) : LT( nxt_score, old_score );	}
+	bool Terminate()const	{		return global_time.GetTime() > m_timelimit_s || m_iteration >= m_max_iteration;	}
+
+private:
+	size_t Slot( std::uint64_t attribute )const noexcept
+	{
+		//splitmix64 finalizer
+		attribute ^= attribute >> 30;
+		attribute *= 0xbf58476d1ce4e5b9ULL;
+		attribute ^= attribute >> 27;
+		attribute *= 0x94d049bb133111ebULL;
+		attribute ^= attribute >> 31;
+		return (size_t)( attribute & m_table_mask );
+	}
+	void Sample( std::vector<Candidate>& candidate );
+	//return false if neighborhood is empty
+	bool Move( const std::vector<Candidate>& candidate );
+};
+
+template<typename Solution, typename Engine, typename Policy>
+inline void TabuSearch<Solution, Engine, Policy>::ConfigTabu( int tenure, int tenure_random, int table_bit )
+{
+	m_tenure = std::max( tenure, 0 );
+	m_tenure_random = std::max( tenure_random, 0 );
+	table_bit = std::clamp( table_bit, 1, 30 );
+	m_table_mask = ( 1ULL << table_bit ) - 1;
+	m_tabu_until.clear();
+	m_frequency.clear();
+}
+
+template<typename Solution, typename Engine, typename Policy>
+inline void TabuSearch<Solution, Engine, Policy>::ConfigLog( std::int64_t max_log_size, int flag ) noexcept
+{
+	m_max_log_size = max_log_size;
+	m_collect_flag = flag;
+	m_iteration_per_log = 0;
+	if( m_max_log_size != 0 )
+	{
+		m_iteration_per_log = m_max_iteration / m_max_log_size;
+		m_iteration_per_log += m_iteration_per_log == 0;
+	}
+}
+
+template<typename Solution, typename Engine, typename Policy>
+inline bool TabuSearch<Solution, Engine, Policy>::ParallelExecute( const int n_thread, unsigned int seed )
+{
+	if( n_thread < 1 )
+		return false;
+	RELEASE_VER_TRY;
+
+	global_time.SetTime();
+	rng = Engine( seed );
+	m_iteration = 0;
+	m_logList.clear();
+	m_last_log_iteration = -1;
+	m_telemetry_time.SetTime();
+	if( m_table_mask == 0 )
+		ConfigTabu( m_tenure, m_tenure_random );
+	m_tabu_until.assign( m_table_mask + 1, 0 );
+	m_frequency.assign( m_table_mask + 1, 0 );
+
+	InitializeSolution( m_current );
+	m_opt_score = m_score = CalcScore( m_current );
+	opt_solution = m_current;
+	DefaultHook( tState::kInit );
+
+	std::vector<Candidate> candidate;
+	bool stop = Terminate();
+	if( !stop )
+		Sample( candidate );
+	std::atomic<size_t> next_item = 0;
+	std::barrier guard( n_thread, [&] ()noexcept
+	{
+		next_item = 0;
+		stop = !Move( candidate );
+		++m_iteration;
+		stop |= Terminate();
+		if( !stop )
+			Sample( candidate );
+	} );
+	auto task = [&] ( const int thread_idx )->void
+	{
+		while( !stop )
+		{
+			for( size_t idx = next_item++; idx < candidate.size(); idx = next_item++ )
+				candidate[idx].score = EvaluateMove( thread_idx, m_current, candidate[idx].move );
+			guard.arrive_and_wait();
+		}
+	};
+
+	std::vector<std::future<void>> thread_pool;
+	thread_pool.reserve( n_thread );
+	for( int i = 0; i < n_thread; i++ )
+		thread_pool.emplace_back( std::async( std::launch::async, task, i ) );
+
+	for( auto& e : thread_pool )
+		e.wait();
+
+	DefaultHook( tState::kFinish );
+
+	RELEASE_VER_CATCH_START( const std::exception& );
+	RELEASE_VER_CATCH_CONTENT( return false );
+	RELEASE_VER_CATCH_START( ... );
+	RELEASE_VER_CATCH_CONTENT( return false );
+	RELEASE_VER_CATCH_END;
+
+	return true;
+}
+
+template<typename Solution, typename Engine, typename Policy>
+inline void TabuSearch<Solution, Engine, Policy>::Sample( std::vector<Candidate>& candidate )
+{
+	const size_t n = NeighborhoodSize( m_current );
+	candidate.clear();
+	if( m_sample_size == 0 || n <= m_sample_size )
+	{
+		candidate.resize( n );
+		for( size_t i = 0; i < n; i++ )
+			candidate[i].move = i;
+	}
+	else
+	{
+		std::uniform_int_distribution<size_t> randx( 0, n - 1 );
+		candidate.resize( m_sample_size );
+		for( auto& e : candidate )
+			e.move = randx( rng );
+	}
+	for( auto& e : candidate )
+		e.attribute = MoveAttribute( m_current, e.move );
+}
+
+template<typename Solution, typename Engine, typename Policy>
+inline bool TabuSearch<Solution, Engine, Policy>::Move( const std::vector<Candidate>& candidate )
+{
+	if( candidate.empty() )
+		return false;
+	const double sign = isMaximize ? 1 : -1;
+	const double penalty_scale = m_iteration > 0 ? m_frequency_penalty / m_iteration : 0;
+
+	const Candidate* best = nullptr;//best admissible
+	double best_val = 0;
+	const Candidate* oldest = nullptr;//fallback, the move leaving tabu list soonest
+	bool aspiration = false;
+	m_n_tabu = 0;
+	for( auto& e : candidate )
+	{
+		const size_t slot = Slot( e.attribute );
+		const bool tabu = m_tabu_until[slot] > m_iteration;
+		const bool asp = tabu && isBetter( e.score, m_opt_score );
+		m_n_tabu += tabu;
+		if( tabu && !asp )
+		{
+			if( oldest == nullptr || m_tabu_until[slot] < m_tabu_until[Slot( oldest->attribute )] )
+				oldest = &e;
+			continue;
+		}
+		//penalty only guides selection, aspiration ignores it
+		const double val = sign * e.score - ( asp ? 0 : penalty_scale * m_frequency[slot] );
+		if( best == nullptr || val > best_val )
+		{
+			best = &e;
+			best_val = val;
+			aspiration = asp;
+		}
+	}
+	if( best == nullptr )
+		best = oldest;
+
+	ApplyMove( m_current, best->move );
+	m_score = best->score;
+	const size_t slot = Slot( best->attribute );
+	std::uniform_int_distribution<int> rand_tenure( 0, m_tenure_random );
+	m_tabu_until[slot] = m_iteration + 1 + m_tenure + ( m_tenure_random > 0 ? rand_tenure( rng ) : 0 );
+	++m_frequency[slot];
+	if( isBetter( m_score, m_opt_score ) )
+	{
+		opt_solution = m_current;
+		m_opt_score = m_score;
+		DefaultHook( tState::kUpdateSolution );
+	}
+	if( aspiration )
+		DefaultHook( tState::kAspiration );
+	DefaultHook( tState::kMove );
+	return true;
+}
+
+template<typename Solution, typename Engine, typename Policy>
+inline void TabuSearch<Solution, Engine, Policy>::UpdateLog( const tState state )
+{
+	if( ( m_max_log_size > 0 || m_telemetry ) && ( (int)state & m_collect_flag ) != 0
+		&& ( state == tState::kFinish || m_last_log_iteration < 0 || m_last_log_iteration + m_iteration_per_log <= m_iteration ) )
+	{
+		m_last_log_iteration = m_iteration;
+		if( m_telemetry )
+			m_telemetry->Push( LogInfo{ GetCurrScore(), GetScore(), GetIteration(), m_telemetry_time.GetTime(), GetProgress(), m_n_tabu } );
+		else
+			m_logList.emplace_back( GetCurrScore(), GetScore(), GetIteration(), global_time.GetTime(), GetProgress(), m_n_tabu );
+	}
+}
+}
\ No newline at end of file
@@ -1,14 +1,77 @@
 #pragma once
 #include "pch.h"
-#include <stack>
+#include "CSRGraph.h"
+#include "Util.h"
+#include <span>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <condition_variable>
 
 namespace Util
 {
+//Iterative Tarjan on node [0,n), explicit stack so there is no depth limit
+//first(u) -> cursor of first out edge of u, next(cursor) -> cursor of next edge, target(cursor) -> destination or -1 if cursor is end
+//emit(span of nodes) is called for each strongly connected component in reverse topological order, span[0] is the root
+//only visits nodes with dfn[u]==-1, dfn/low/on_stack are sized to n by caller (dfn=-1, on_stack=false) and stk is empty
+template <typename First, typename Next, typename Target, typename Emit>
+void TarjanSCC( const int n, First&& first, Next&& next, Target&& target, Emit&& emit,
+				std::vector<int>& dfn, std::vector<int>& low, std::vector<int>& stk, std::vector<char>& on_stack )
+{
+	using Cursor = std::invoke_result_t<First, int>;
+	struct Frame
+	{
+		int u = -1;
+		Cursor cursor;
+	};
+	std::vector<Frame> frame;
+	int index = 0;
+	auto visit = [&] ( int u )
+	{
+		dfn[u] = low[u] = index++;
+		stk.emplace_back( u );
+		on_stack[u] = true;
+		frame.emplace_back( u, first( u ) );
+	};
+	for( int root = 0; root < n; root++ )
+	{
+		if( dfn[root] != -1 )
+			continue;
+		visit( root );
+		while( !frame.empty() )
+		{
+			auto& f = frame.back();
+			if( const int v = target( f.cursor ); v >= 0 )
+			{
+				f.cursor = next( f.cursor );
+				if( dfn[v] == -1 )
+					visit( v );//f is invalid after this
+				else if( on_stack[v] )
+					low[f.u] = std::min( low[f.u], dfn[v] );
+				continue;
+			}
+			const int u = f.u;
+			frame.pop_back();
+			if( !frame.empty() )
+				low[frame.back().u] = std::min( low[frame.back().u], low[u] );
+			if( low[u] == dfn[u] )
+			{
+				size_t pos = stk.size();
+				while( stk[--pos] != u );
+				for( size_t i = pos; i < stk.size(); i++ )
+					on_stack[stk[i]] = false;
+				emit( std::span<const int>( stk.data() + pos, stk.size() - pos ) );
+				stk.resize( pos );
+			}
+		}
+	}
+}
+
 //find strongly connected component
 class Tarjan
 {
 public:
-	static constexpr int MAX_DFS_SIZE = 10000;//max possible size of graph using DFS
+	//kept for compatibility, all methods use the same iterative implementation
 	enum struct tMethod
 	{
 		kAuto,
@@ -26,17 +89,10 @@ private:
 	std::vector<Node> edgeList;
 
 	//temp
-	enum struct tState
-	{
-		kNew,
-		kUsing,
-		kFinish,
-	};
 	std::vector<int> dfn;
 	std::vector<int> low;
-	std::vector<tState> mark;
-	std::stack<int> stk;
-	int index = -1;
+	std::vector<int> stk;
+	std::vector<char> on_stack;
 
 	std::vector<int> group;
 	std::vector<int> sum;
@@ -62,12 +118,282 @@ public:
 		edgeList.clear();
 	}
 
+	//group[i] := root node of component of i, sum[root] := size of component (0 for non-root)
 	const std::vector<int>& solve( const tMethod method = tMethod::kAuto );
-
-private:
-	void dfs( const int p );
-	//simulate dfs
-	void nondfs( const int p );
 };
+}
+
+namespace Util::GraphTheory
+{
+//Strongly connected component by iterative Tarjan
+//label[i] := component of node (list idx i), components are numbered in topological order of condensation
+//dfs frame keeps const Edge* as cursor, graph_type guarantees edge pointer is valid while the graph is not modified
+template<graph_type Graph>
+std::vector<int> strongly_connected_component( const Graph& g )
+{
+	using Edge = typename Graph::Edge;
+	GraphNodeIdx2List<Graph> node_idx2idx( g );
+	const int n = (int)g.size_node();
+	std::vector<int> dfn( n, -1 ), low( n ), stk, label( n );
+	std::vector<char> on_stack( n, false );
+	stk.reserve( n );
+	int n_component = 0;
+	TarjanSCC( n,
+			   [&] ( int u )->const Edge*	{		return g.GetNextEdge( *g.GetNode( node_idx2idx.GetNodeIdx( u ) ) );	},
+			   [&] ( const Edge* e )->const Edge*	{		return g.GetNextEdge( *e );	},
+			   [&] ( const Edge* e )->int	{		return e ? node_idx2idx[e->GetDestination()] : -1;	},
+			   [&] ( std::span<const int> component )
+			   {
+				   for( int u : component )
+					   label[u] = n_component;
+				   ++n_component;
+			   },
+			   dfn, low, stk, on_stack );
+	//reverse topological order -> topological order
+	for( auto& e : label )
+		e = n_component - 1 - e;
+	return label;
+}
+
+//Strongly connected component by forward-backward in parallel, for very large graph
+//each task trims nodes with no in (or out) edge inside the task repeatedly, then picks a pivot
+//intersection of its forward and backward reachable set is a component, the rest is split into 3 independent tasks
+//small task is solved by Tarjan
+//label[i] := component of node (list idx i), components are numbered by their smallest node (not topological)
+//n_thread = 0 means all logical cores
+template<graph_type Graph>
+requires _Has_inverse_edge<Graph>
+std::vector<int> parallel_strongly_connected_component( const Graph& g, int n_thread = 0, int small_task = 4096 )
+{
+	using Edge = typename Graph::Edge;
+	GraphNodeIdx2List<Graph> node_idx2idx( g );
+	const int n = (int)g.size_node();
+	if( n_thread <= 0 )
+		n_thread = std::max( 1, GetLogicalCoreCount() );
+	n_thread = std::max( 1, std::min( n_thread, n ) );
+	auto GetNode = [&] ( int u )	{		return g.GetNode( node_idx2idx.GetNodeIdx( u ) );	};
+
+	//color of node, node belongs to the task with same color, -1 if component is found
+	std::vector<std::atomic<int>> color( n );
+	std::vector<int> label( n, -1 );
+	std::atomic<int> n_color = 1;
 
+	std::vector<int> in_degree( n ), out_degree( n );//within task, only used by owner of node
+	std::vector<int> local_idx( n );//position in task.node for Tarjan of small task, only used by owner of node
+	std::vector<int> remain( n );
+	std::iota( remain.begin(), remain.end(), 0 );
+
+	struct Task
+	{
+		int color = 0;
+		std::vector<int> node;
+	};
+	std::vector<Task> queue;
+	std::mutex mtx;
+	std::condition_variable cv;
+	int n_running = 0;
+	if( !remain.empty() )
+		queue.emplace_back( 0, std::move( remain ) );
+
+	auto solve_small = [&] ( Task& task, std::vector<int>& dfn, std::vector<int>& low, std::vector<int>& stk, std::vector<char>& on_stack )
+	{
+		//Tarjan on induced subgraph, local idx by position in task.node
+		const int m = (int)task.node.size();
+		for( int i = 0; i < m; i++ )
+			local_idx[task.node[i]] = i;
+		auto skip = [&] ( const Edge* e )
+		{
+			while( e && color[node_idx2idx[e->GetDestination()]].load( std::memory_order_relaxed ) != task.color )
+				e = g.GetNextEdge( *e );
+			return e;
+		};
+		dfn.assign( m, -1 );
+		low.resize( m );
+		on_stack.assign( m, false );
+		stk.clear();
+		TarjanSCC( m,
+				   [&] ( int i )->const Edge*	{		return skip( g.GetNextEdge( *GetNode( task.node[i] ) ) );	},
+				   [&] ( const Edge* e )->const Edge*	{		return skip( g.GetNextEdge( *e ) );	},
+				   [&] ( const Edge* e )->int	{		return e ? local_idx[node_idx2idx[e->GetDestination()]] : -1;	},
+				   [&] ( std::span<const int> component )
+				   {
+					   int root = n;
+					   for( int i : component )
+						   root = std::min( root, task.node[i] );
+					   for( int i : component )
+						   label[task.node[i]] = root;
+				   },
+				   dfn, low, stk, on_stack );
+		for( int u : task.node )
+			color[u].store( -1, std::memory_order_relaxed );
+	};
+	//split task into forward only, backward only and the rest, return new tasks
+	auto split = [&] ( Task& task, std::vector<int>& q )->std::array<Task, 3>
+	{
+		const int c = task.color;
+		//trim, removed node is a component by itself
+		q.clear();
+		auto remove = [&] ( int u )
+		{
+			color[u].store( -1, std::memory_order_relaxed );
+			label[u] = u;
+			q.emplace_back( u );
+		};
+		for( int u : task.node )
+		{
+			in_degree[u] = out_degree[u] = 0;
+			auto p = GetNode( u );
+			for( auto e = g.GetNextEdge( *p ); e; e = g.GetNextEdge( *e ) )
+				out_degree[u] += color[node_idx2idx[e->GetDestination()]].load( std::memory_order_relaxed ) == c;
+			for( auto e = g.GetNextInverseEdge( *p ); e; e = g.GetNextInverseEdge( *e ) )
+				in_degree[u] += color[node_idx2idx[e->GetSource()]].load( std::memory_order_relaxed ) == c;
+		}
+		for( int u : task.node )
+			if( in_degree[u] == 0 || out_degree[u] == 0 )
+				remove( u );
+		for( size_t h = 0; h < q.size(); h++ )
+		{
+			auto p = GetNode( q[h] );
+			for( auto e = g.GetNextEdge( *p ); e; e = g.GetNextEdge( *e ) )
+				if( const int v = node_idx2idx[e->GetDestination()]; color[v].load( std::memory_order_relaxed ) == c && --in_degree[v] == 0 )
+					remove( v );
+			for( auto e = g.GetNextInverseEdge( *p ); e; e = g.GetNextInverseEdge( *e ) )
+				if( const int v = node_idx2idx[e->GetSource()]; color[v].load( std::memory_order_relaxed ) == c && --out_degree[v] == 0 )
+					remove( v );
+		}
+		std::erase_if( task.node, [&] ( int u ) { return color[u].load( std::memory_order_relaxed ) != c; } );
+		if( task.node.empty() )
+			return {};
+
+		const int c_fw = n_color++;
+		const int c_bw = n_color++;
+		const int c_scc = n_color++;
+		const int pivot = task.node.front();
+		//forward c->c_fw
+		q.assign( 1, pivot );
+		color[pivot].store( c_fw, std::memory_order_relaxed );
+		for( size_t h = 0; h < q.size(); h++ )
+			for( auto e = g.GetNextEdge( *GetNode( q[h] ) ); e; e = g.GetNextEdge( *e ) )
+				if( const int v = node_idx2idx[e->GetDestination()]; color[v].load( std::memory_order_relaxed ) == c )
+				{
+					color[v].store( c_fw, std::memory_order_relaxed );
+					q.emplace_back( v );
+				}
+		//backward c_fw->c_scc, c->c_bw
+		q.assign( 1, pivot );
+		color[pivot].store( c_scc, std::memory_order_relaxed );
+		for( size_t h = 0; h < q.size(); h++ )
+			for( auto e = g.GetNextInverseEdge( *GetNode( q[h] ) ); e; e = g.GetNextInverseEdge( *e ) )
+			{
+				const int v = node_idx2idx[e->GetSource()];
+				const int cv = color[v].load( std::memory_order_relaxed );
+				if( cv == c_fw || cv == c )
+				{
+					color[v].store( cv == c_fw ? c_scc : c_bw, std::memory_order_relaxed );
+					q.emplace_back( v );
+				}
+			}
+		std::array<Task, 3> sub = { Task{ c_fw, {} }, Task{ c_bw, {} }, Task{ c, {} } };
+		int root = n;
+		for( int u : task.node )
+			if( color[u].load( std::memory_order_relaxed ) == c_scc )
+				root = std::min( root, u );
+		for( int u : task.node )
+		{
+			const int cu = color[u].load( std::memory_order_relaxed );
+			if( cu == c_scc )
+			{
+				label[u] = root;
+				color[u].store( -1, std::memory_order_relaxed );
+			}
+			else
+				sub[cu == c_fw ? 0 : cu == c_bw ? 1 : 2].node.emplace_back( u );
+		}
+		return sub;
+	};
+	auto task = [&] ()->void
+	{
+		std::vector<int> dfn, low, stk, q;
+		std::vector<char> on_stack;
+		while( true )
+		{
+			Task cur;
+			{
+				std::unique_lock lock( mtx );
+				cv.wait( lock, [&] { return !queue.empty() || n_running == 0; } );
+				if( queue.empty() )
+					return;
+				cur = std::move( queue.back() );
+				queue.pop_back();
+				++n_running;
+			}
+			std::array<Task, 3> sub;
+			if( (int)cur.node.size() <= small_task )
+				solve_small( cur, dfn, low, stk, on_stack );
+			else
+				sub = split( cur, q );
+			{
+				std::lock_guard lock( mtx );
+				for( auto& e : sub )
+					if( !e.node.empty() )
+						queue.emplace_back( std::move( e ) );
+				--n_running;
+			}
+			cv.notify_all();
+		}
+	};
+	std::vector<std::future<void>> thread_pool;
+	thread_pool.reserve( n_thread );
+	for( int i = 0; i < n_thread; i++ )
+		thread_pool.emplace_back( std::async( std::launch::async, task ) );
+	for( auto& e : thread_pool )
+		e.get();
+	return label;
+}
+
+//DAG of components, node i is component i, edges between different components are deduplicated
+//label is from strongly_connected_component or parallel_strongly_connected_component (any label in [0,N))
+//n_thread = 0 means all logical cores
+template<graph_type Graph>
+CSRGraph<> condensation( const Graph& g, const std::vector<int>& label, int n_thread = 0 )
+{
+	GraphNodeIdx2List<Graph> node_idx2idx( g );
+	const int n = (int)g.size_node();
+	const int n_component = label.empty() ? 0 : std::ranges::max( label ) + 1;
+	if( n_thread <= 0 )
+		n_thread = std::max( 1, GetLogicalCoreCount() );
+	n_thread = std::max( 1, std::min( n_thread, n ) );
+	std::vector<std::vector<std::pair<int, int>>> local( n_thread );
+	auto task = [&] ( const int thread_idx )->void
+	{
+		auto& edge = local[thread_idx];
+		for( int u = thread_idx; u < n; u += n_thread )
+		{
+			auto p = g.GetNode( node_idx2idx.GetNodeIdx( u ) );
+			for( auto e = g.GetNextEdge( *p ); e; e = g.GetNextEdge( *e ) )
+				if( const int v = node_idx2idx[e->GetDestination()]; label[u] != label[v] )
+					edge.emplace_back( label[u], label[v] );
+		}
+		std::ranges::sort( edge );
+		edge.erase( std::unique( edge.begin(), edge.end() ), edge.end() );
+	};
+	std::vector<std::future<void>> thread_pool;
+	thread_pool.reserve( n_thread );
+	for( int i = 0; i < n_thread; i++ )
+		thread_pool.emplace_back( std::async( std::launch::async, task, i ) );
+	for( auto& e : thread_pool )
+		e.get();
+
+	std::vector<std::pair<int, int>> edge = std::move( local.front() );
+	for( int i = 1; i < n_thread; i++ )
+	{
+		const size_t mid = edge.size();
+		edge.insert( edge.end(), local[i].begin(), local[i].end() );
+		std::inplace_merge( edge.begin(), edge.begin() + mid, edge.end() );
+	}
+	edge.erase( std::unique( edge.begin(), edge.end() ), edge.end() );
+	CSRGraph<> dag;
+	dag.Build( n_component, std::span<const std::pair<int, int>>( edge ) );
+	return dag;
+}
 }
\ No newline at end of file
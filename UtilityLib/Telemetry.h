@@ -0,0 +1,195 @@
+#pragma once
+#include "pch.h"
+#include "Timer.h"
+#include <atomic>
+#include <thread>
+#include <ostream>
+
+namespace Util
+{
+//Hook policy of optimization engine, disabled part is removed at compile time
+template <bool EnableLog, bool EnableHook>
+struct HookPolicy
+{
+	static constexpr bool enable_log = EnableLog;
+	static constexpr bool enable_hook = EnableHook;
+};
+using DefaultHookPolicy = HookPolicy<true, true>;
+using NoHookPolicy = HookPolicy<false, false>;
+
+//read clock once every n calls, otherwise return the last value
+class SampledTimer
+{
+protected:
+	Timer t;
+	std::uint32_t gap = 64;
+	std::uint32_t cnt = 0;
+	double last = 0;
+
+public:
+	SampledTimer()	{}
+	explicit SampledTimer( std::uint32_t n ) :gap( std::max( n, 1u ) )	{}
+	void SetGap( std::uint32_t n )noexcept	{		gap = std::max( n, 1u );	}
+	void SetTime()
+	{
+		t.SetTime();
+		cnt = 0;
+		last = 0;
+	}
+	double GetTime()
+	{
+		if( cnt++ % gap == 0 )
+			last = t.GetTime();
+		return last;
+	}
+};
+
+//fixed-capacity ring, single producer and single consumer, new entry is dropped when full
+template <typename T>
+class TelemetryRing
+{
+protected:
+	std::vector<T> buffer;
+	size_t mask = 0;
+	alignas( 64 ) std::atomic<size_t> head = 0;//next write
+	alignas( 64 ) std::atomic<size_t> tail = 0;//next read
+	std::atomic<std::int64_t> n_drop = 0;
+
+public:
+	using value_type = T;
+
+	//capacity is rounded up to power of 2
+	explicit TelemetryRing( size_t capacity = 1024 )
+	{
+		size_t n = 1;
+		while( n < capacity )
+			n <<= 1;
+		buffer.resize( n );
+		mask = n - 1;
+	}
+	TelemetryRing( const TelemetryRing& ) = delete;
+	TelemetryRing& operator=( const TelemetryRing& ) = delete;
+
+	size_t capacity()const noexcept	{		return buffer.size();	}
+	size_t size()const noexcept	{		return head.load( std::memory_order_acquire ) - tail.load( std::memory_order_acquire );	}
+	bool empty()const noexcept	{		return size() == 0;	}
+	std::int64_t GetDropCount()const noexcept	{		return n_drop.load( std::memory_order_relaxed );	}
+	//not thread safe
+	void clear()noexcept
+	{
+		head = 0;
+		tail = 0;
+		n_drop = 0;
+	}
+
+	//producer
+	bool Push( const T& val )noexcept
+	{
+		const size_t h = head.load( std::memory_order_relaxed );
+		if( h - tail.load( std::memory_order_acquire ) == buffer.size() )
+		{
+			n_drop.fetch_add( 1, std::memory_order_relaxed );
+			return false;
+		}
+		buffer[h & mask] = val;
+		head.store( h + 1, std::memory_order_release );
+		return true;
+	}
+	//consumer
+	bool Pop( T& val )noexcept
+	{
+		const size_t t = tail.load( std::memory_order_relaxed );
+		if( t == head.load( std::memory_order_acquire ) )
+			return false;
+		val = buffer[t & mask];
+		tail.store( t + 1, std::memory_order_release );
+		return true;
+	}
+};
+
+template <typename T>
+concept csv_writable_type = requires( const T & val, std::ostream & os )
+{
+	{		T::CSVHeader()		}->std::convertible_to<const char*>;
+	val.WriteCSV( os );
+};
+
+//drain TelemetryRing to stream in background thread, format is a template argument of Start
+//kCSV requires T::CSVHeader() and T::WriteCSV(os), kBinary writes raw bytes of trivially copyable T, checked at compile time
+template <typename T>
+class TelemetryExporter
+{
+public:
+	enum struct tFormat
+	{
+		kCSV,
+		kBinary,
+	};
+
+private:
+	std::thread worker;
+	std::atomic<bool> running = false;
+	std::atomic<std::int64_t> n_write = 0;//written by worker only
+
+public:
+	TelemetryExporter()	{}
+	TelemetryExporter( const TelemetryExporter& ) = delete;
+	TelemetryExporter& operator=( const TelemetryExporter& ) = delete;
+	~TelemetryExporter()
+	{
+		Stop();
+	}
+
+	//ring and os must outlive exporter (or Stop())
+	template <tFormat format = tFormat::kCSV>
+		requires ( format == tFormat::kCSV ? csv_writable_type<T> : std::is_trivially_copyable_v<T> )
+	void Start( TelemetryRing<T>& ring, std::ostream& os, std::chrono::milliseconds interval = std::chrono::milliseconds( 10 ) )
+	{
+		Stop();
+		n_write.store( 0, std::memory_order_relaxed );
+		if constexpr( format == tFormat::kCSV )
+			os << T::CSVHeader() << '\n';
+		running = true;
+		worker = std::thread( [this, &ring, &os, interval] ()
+		{
+			bool last = false;
+			while( !last )
+			{
+				last = !running.load( std::memory_order_acquire );
+				Drain<format>( ring, os );
+				if( !last )
+					std::this_thread::sleep_for( interval );
+			}
+			os.flush();
+		} );
+	}
+	//drain the rest and join
+	void Stop()
+	{
+		running = false;
+		if( worker.joinable() )
+			worker.join();
+	}
+	bool IsRunning()const noexcept	{		return running;	}
+	//any thread, exact after Stop()
+	std::int64_t GetWriteCount()const noexcept	{		return n_write.load( std::memory_order_acquire );	}
+
+private:
+	template <tFormat format>
+	void Drain( TelemetryRing<T>& ring, std::ostream& os )
+	{
+		T val;
+		while( ring.Pop( val ) )
+		{
+			if constexpr( format == tFormat::kCSV )
+			{
+				val.WriteCSV( os );
+				os << '\n';
+			}
+			else
+				os.write( reinterpret_cast<const char*>( &val ), sizeof( T ) );
+			n_write.fetch_add( 1, std::memory_order_relaxed );
+		}
+	}
+};
+}
\ No newline at end of file
@@ -60,6 +60,13 @@ public:
 		heap.reserve( n );
 		idx2pos.assign( n, -1 );
 	}
+	//O(size)
+	void clear()
+	{
+		for( auto& p : heap )
+			idx2pos[p.idx] = -1;
+		heap.clear();
+	}
 	bool exists( int idx )const	{		return idx2pos[idx] != -1;	}
 protected:
 	//heap[X]->heap[X-1] since it works from index 1
@@ -0,0 +1,204 @@
+#pragma once
+#include "CommonDef.h"
+#include "Util.h"
+#include <bit>
+
+namespace Util
+{
+//Monotone priority queue, MinElement
+//popped key never decreases, pushed (or updated) key must not be less than current top key (e.g. Dijkstra)
+//same interface as dynamic_priority_queue, update_priority only decreases key
+//decrease key is lazy, old entry is skipped when it reaches the top
+
+//Radix heap O(log(C)) amortized, C = max key - min key
+template <std::unsigned_integral Key>
+class radix_heap
+{
+public:
+	struct Node
+	{
+		int idx = -1;
+		Key key = Key();
+	};
+protected:
+	static constexpr int kBucket = std::numeric_limits<Key>::digits + 1;
+	std::vector<Node> bucket[kBucket];//bucket i keeps key with bit_width(key^last)==i
+	std::vector<Key> idx2key;
+	std::vector<char> in_queue;
+	size_t n = 0;
+	Key last = Key();
+
+public:
+	radix_heap()
+	{}
+	//not const, move min element to bucket[0]
+	const Node& top()
+	{
+		Normalize();
+		return bucket[0].back();
+	}
+	bool empty()const	{		return n == 0;	}
+	void pop()
+	{
+		Normalize();
+		in_queue[bucket[0].back().idx] = false;
+		bucket[0].pop_back();
+		--n;
+	}
+	void push( int idx, const Key& key )
+	{
+		assert( !in_queue[idx] );
+		assert( key >= last );
+		in_queue[idx] = true;
+		idx2key[idx] = key;
+		bucket[GetBucket( key )].emplace_back( idx, key );
+		++n;
+	}
+	void update_priority( int idx, const Key& key )
+	{
+		assert( in_queue[idx] );
+		assert( key >= last && key <= idx2key[idx] );
+		if( key == idx2key[idx] )
+			return;
+		idx2key[idx] = key;
+		bucket[GetBucket( key )].emplace_back( idx, key );
+	}
+	size_t size()const	{		return n;	}
+	void resize( size_t n )
+	{
+		clear();
+		idx2key.assign( n, Key() );
+		in_queue.assign( n, false );
+	}
+	void clear()
+	{
+		for( auto& b : bucket )
+		{
+			for( auto& p : b )
+				in_queue[p.idx] = false;
+			b.clear();
+		}
+		n = 0;
+		last = Key();
+	}
+	bool exists( int idx )const	{		return in_queue[idx];	}
+protected:
+	int GetBucket( const Key& key )const	{		return (int)std::bit_width( Key( key ^ last ) );	}
+	bool isAlive( const Node& p )const	{		return in_queue[p.idx] && idx2key[p.idx] == p.key;	}
+	void Normalize()
+	{
+		assert( n > 0 );
+		while( !bucket[0].empty() && !isAlive( bucket[0].back() ) )
+			bucket[0].pop_back();
+		if( !bucket[0].empty() )
+			return;
+		//find first non-empty bucket, redistribute by its min key
+		for( int i = 1; i < kBucket; ++i )
+		{
+			auto& b = bucket[i];
+			std::erase_if( b, [this] ( const Node& p ) { return !isAlive( p ); } );
+			if( b.empty() )
+				continue;
+			last = std::ranges::min_element( b, {}, &Node::key )->key;
+			for( auto& p : b )
+				bucket[GetBucket( p.key )].emplace_back( p );
+			b.clear();
+			return;
+		}
+		assert( false );
+	}
+};
+
+//Dial's buckets O(C) per pop at worst, C = max key - min key in queue (max edge weight for Dijkstra)
+template <std::integral Key>
+class bucket_queue
+{
+public:
+	struct Node
+	{
+		int idx = -1;
+		Key key = Key();
+	};
+protected:
+	std::vector<std::vector<Node>> bucket;//circular, key -> bucket[key%size]
+	std::vector<Key> idx2key;
+	std::vector<char> in_queue;
+	size_t n = 0;
+	Key last = Key();
+
+public:
+	//key in queue must be within [top key, top key + max_range], queue starts at key 0
+	explicit bucket_queue( Key max_range = 0 )
+	{
+		assert( max_range >= 0 );
+		bucket.resize( (size_t)max_range + 1 );
+	}
+	const Node& top()
+	{
+		Normalize();
+		return GetBucket( last ).back();
+	}
+	bool empty()const	{		return n == 0;	}
+	void pop()
+	{
+		Normalize();
+		auto& b = GetBucket( last );
+		in_queue[b.back().idx] = false;
+		b.pop_back();
+		--n;
+	}
+	void push( int idx, const Key& key )
+	{
+		assert( !in_queue[idx] );
+		assert( key >= last && key - last < (Key)bucket.size() );
+		in_queue[idx] = true;
+		idx2key[idx] = key;
+		GetBucket( key ).emplace_back( idx, key );
+		++n;
+	}
+	void update_priority( int idx, const Key& key )
+	{
+		assert( in_queue[idx] );
+		assert( key >= last && key <= idx2key[idx] );
+		if( key == idx2key[idx] )
+			return;
+		idx2key[idx] = key;
+		GetBucket( key ).emplace_back( idx, key );
+	}
+	size_t size()const	{		return n;	}
+	void resize( size_t n )
+	{
+		clear();
+		idx2key.assign( n, Key() );
+		in_queue.assign( n, false );
+	}
+	void clear()
+	{
+		for( auto& b : bucket )
+		{
+			for( auto& p : b )
+				in_queue[p.idx] = false;
+			b.clear();
+		}
+		n = 0;
+		last = Key();
+	}
+	bool exists( int idx )const	{		return in_queue[idx];	}
+protected:
+	std::vector<Node>& GetBucket( const Key& key )	{		return bucket[size_t( key % (Key)bucket.size() )];	}
+	bool isAlive( const Node& p )const	{		return in_queue[p.idx] && idx2key[p.idx] == p.key;	}
+	void Normalize()
+	{
+		assert( n > 0 );
+		while( true )
+		{
+			auto& b = GetBucket( last );
+			while( !b.empty() && !isAlive( b.back() ) )
+				b.pop_back();
+			if( !b.empty() )
+				return;
+			++last;
+		}
+	}
+};
+}
\ No newline at end of file